@@ -1,5 +1,7 @@
 release = ["-DCMAKE_BUILD_TYPE=Release"]
 debug = ["-DCMAKE_BUILD_TYPE=Debug"]
+profile = ["-DCMAKE_BUILD_TYPE=Release", "-DPROST_PROFILING=ON"]
+benchmark = ["-DCMAKE_BUILD_TYPE=Release", "-DPROST_BENCHMARKS=ON"]
 
 DEFAULT = "release"
 RELEASE = "release"
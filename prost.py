@@ -10,11 +10,14 @@ import sys
 def main():
     search_params = []
     run_debug = False
+    run_profile = False
     for arg in sys.argv[1:]:
         if arg == "--debug":
             run_debug = True
         elif arg == "--release":
             run_debug = False
+        elif arg == "--profile":
+            run_profile = True
         else:
             search_params.append(arg)
 
@@ -25,6 +28,13 @@ def main():
         search_name = "search-debug"
         parser_file = os.path.join(path, "builds/debug/rddl_parser/rddl-parser")
         search_file = os.path.join(path, "builds/debug/search/search")
+    elif run_profile:
+        # The profile build is a release build, so the search executable
+        # calls the parser under the name of the release parser
+        parser_name = "rddl-parser-release"
+        search_name = "search-release"
+        parser_file = os.path.join(path, "builds/profile/rddl_parser/rddl-parser")
+        search_file = os.path.join(path, "builds/profile/search/search")
     else:
         parser_name = "rddl-parser-release"
         search_name = "search-release"
@@ -1,5 +1,6 @@
 #include "action_selection.h"
 
+#include <array>
 #include <cassert>
 
 #include "thts.h"
@@ -11,6 +12,31 @@
 
 using namespace std;
 
+namespace {
+// The inverse square roots of the numbers of visits up to this number are
+// precomputed for UCB1, so the visit part of the UCB1 formula does not require
+// a division and a square root for each child (which dominate the time of
+// action selection in nodes with many children)
+int const numberOfInverseSqrts = 4096;
+
+array<double, numberOfInverseSqrts> computeInverseSqrts() {
+    array<double, numberOfInverseSqrts> result;
+    for (int i = 0; i < numberOfInverseSqrts; ++i) {
+        result[i] = 1.0 / sqrt(static_cast<double>(i));
+    }
+    return result;
+}
+
+array<double, numberOfInverseSqrts> const inverseSqrts = computeInverseSqrts();
+
+inline double inverseSqrt(int value) {
+    if (value < numberOfInverseSqrts) {
+        return inverseSqrts[value];
+    }
+    return 1.0 / sqrt(static_cast<double>(value));
+}
+} // namespace
+
 /******************************************************************
                      Action Selection Creation
 ******************************************************************/
@@ -104,7 +130,8 @@ int ActionSelection::selectAction(SearchNode* node) {
 
     // Pick one of the candidates uniformly at random
     assert(!bestActionIndices.empty());
-    int selectedIndex = MathUtils::rnd->randomElement(bestActionIndices);
+    int selectedIndex =
+        thts->getTask().rnd.randomElement(bestActionIndices);
 
     // Update statistics
     if (node == currentRootNode) {
@@ -237,12 +264,16 @@ void UCB1ActionSelection::_selectAction(SearchNode* node) {
         parentVisitPart *= log(numVisits);
     }
 
+    // The visit part of a child is magicConstant * sqrt(parentVisitPart /
+    // childNumVisits), which is split into a factor that only depends on the
+    // parent and the inverse square root of the number of visits of the child
+    double explorationFactor = magicConstant * sqrt(parentVisitPart);
+
     for (int index = 0; index < numChildren; ++index) {
         SearchNode* child = node->children[index];
         if (child && child->initialized && !child->solved) {
-            double childNumVisits = static_cast<double>(child->numberOfVisits);
             double visitPart =
-                magicConstant * sqrt(parentVisitPart / childNumVisits);
+                explorationFactor * inverseSqrt(child->numberOfVisits);
             double UCTValue = child->getExpectedRewardEstimate() + visitPart;
 
             assert(!MathUtils::doubleIsMinusInfinity(UCTValue));
@@ -0,0 +1,83 @@
+#include "micro_benchmark.h"
+
+#include "../utils/logger.h"
+#include "../utils/profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+using namespace std;
+
+MicroBenchmarkResult MicroBenchmark::run(double minTime) const {
+    MicroBenchmarkResult res{name, 0, 0.0, 0.0};
+
+    // Warm-up run that fills caches and allocates reusable buffers
+    if (runBatch() == 0) {
+        return res;
+    }
+
+    long allocationsAtStart = Profiler::numberOfAllocations;
+    chrono::steady_clock::duration time =
+        chrono::steady_clock::duration::zero();
+    chrono::steady_clock::duration minDuration =
+        chrono::duration_cast<chrono::steady_clock::duration>(
+            chrono::duration<double>(minTime));
+    do {
+        chrono::steady_clock::time_point startTime =
+            chrono::steady_clock::now();
+        res.operations += runBatch();
+        time += chrono::steady_clock::now() - startTime;
+    } while (time < minDuration);
+    long allocations = Profiler::numberOfAllocations - allocationsAtStart;
+
+    double operations = static_cast<double>(res.operations);
+    res.nsPerOperation =
+        chrono::duration<double, nano>(time).count() / operations;
+    res.allocationsPerOperation = static_cast<double>(allocations) / operations;
+    return res;
+}
+
+void printMicroBenchmarkResults(string const& taskName,
+                                vector<MicroBenchmarkResult> const& res) {
+    Logger::logLine("Microbenchmark results for " + taskName + ":",
+                    Verbosity::SILENT);
+    char line[128];
+    snprintf(line, sizeof(line), "  %-24s %12s %14s %12s", "benchmark",
+             "operations", "ns/op", "allocs/op");
+    Logger::logLine(line, Verbosity::SILENT);
+    for (MicroBenchmarkResult const& result : res) {
+        if (result.operations == 0) {
+            snprintf(line, sizeof(line), "  %-24s %12s", result.name.c_str(),
+                     "n/a");
+        } else {
+            snprintf(line, sizeof(line), "  %-24s %12ld %14.1f %12.2f",
+                     result.name.c_str(), result.operations,
+                     result.nsPerOperation, result.allocationsPerOperation);
+        }
+        Logger::logLine(line, Verbosity::SILENT);
+    }
+
+    // Benchmarks without operations (e.g., evaluate_to_pd on a deterministic
+    // task) are omitted from the JSON output
+    stringstream json;
+    json << "MICROBENCHMARK {\"task\": \"" << taskName << "\", "
+         << "\"results\": {";
+    bool first = true;
+    for (MicroBenchmarkResult const& result : res) {
+        if (result.operations == 0) {
+            continue;
+        }
+        if (!first) {
+            json << ", ";
+        }
+        first = false;
+        json << "\"" << result.name << "\": {"
+             << "\"operations\": " << result.operations << ", "
+             << "\"ns_per_op\": " << result.nsPerOperation << ", "
+             << "\"allocs_per_op\": " << result.allocationsPerOperation
+             << "}";
+    }
+    json << "}}";
+    Logger::logLine(json.str(), Verbosity::SILENT);
+}
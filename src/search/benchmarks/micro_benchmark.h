@@ -0,0 +1,55 @@
+#ifndef MICRO_BENCHMARK_H
+#define MICRO_BENCHMARK_H
+
+/*
+  A minimal framework for microbenchmarks of the primitives of the search. A
+  benchmark is a function that performs a batch of operations (e.g., it
+  computes the successor states of all states of a fixture) and returns the
+  number of operations it has performed. The batch is repeated until a minimal
+  time has passed, and the average time (in ns) and the average number of heap
+  allocations per operation are reported.
+
+  Allocations are counted by the global allocation functions that are defined
+  in utils/profiler.cc if PROST_COUNT_ALLOCATIONS (or PROST_PROFILING) is
+  defined, which is the case for the search-benchmarks executable.
+*/
+
+#include <functional>
+#include <string>
+#include <vector>
+
+struct MicroBenchmarkResult {
+    std::string name;
+    long operations;
+    double nsPerOperation;
+    double allocationsPerOperation;
+};
+
+class MicroBenchmark {
+public:
+    MicroBenchmark(std::string _name, std::function<long()> _runBatch)
+        : name(_name), runBatch(_runBatch) {}
+
+    // Runs batches until at least minTime seconds have passed. The first batch
+    // is a warm-up run that is not measured, so it may also set up the part of
+    // the fixture that is specific to the benchmark.
+    MicroBenchmarkResult run(double minTime) const;
+
+    std::string name;
+
+private:
+    std::function<long()> runBatch;
+};
+
+// Prevents that the computation of value is optimized away by the compiler
+template <typename T>
+inline void doNotOptimizeAway(T const& value) {
+    __asm__ volatile("" : : "g"(&value) : "memory");
+}
+
+// Print the results in a human readable format and as a single line in JSON
+// format that starts with "MICROBENCHMARK"
+void printMicroBenchmarkResults(std::string const& taskName,
+                                std::vector<MicroBenchmarkResult> const& res);
+
+#endif
@@ -0,0 +1,462 @@
+/*
+  The search-benchmarks executable measures the primitives of the search on the
+  task of an RDDL instance (e.g., an instance of the testbed). The task is
+  parsed with the external parser like in the local simulation, and the
+  fixture consists of states that are sampled by random walks through the
+  simulated task, each paired with an applicable action that is picked at
+  random. The following benchmarks are run (an operation is given in
+  parentheses):
+
+  - successor_state: calcSuccessorState (a state-action pair)
+  - applicable_actions: getApplicableActions (a state)
+  - evaluate_to_pd: evaluateToPD of the formula of a probabilistic CPF, which
+    bypasses the caches of the CPF (a CPF in a state-action pair)
+  - outcome_sampling: sampling of an outcome of a non-deterministic
+    distribution of a successor state (a distribution)
+  - blacklisted_sampling: like outcome_sampling, but the first outcome
+    of each distribution is blacklisted (a distribution)
+  - random_numbers: generation of a random real number and a random action
+    index with the random number generator of the planner (a pair of numbers)
+  - state_hashing: computation of the state fluent hash keys, the state hash
+    key and the hash value that is used by the caches (a state)
+  - state_equality: comparison of a state with a copy of it (a state)
+  - state_lookup: lookup of a state in a hash map with the fixture states,
+    like in the caches of the search (a state)
+  - thts_trial: a trial of THTS in the fixture states (a trial). By default,
+    nodes are initialized with the uniform heuristic, so this measures the
+    operations of THTS itself (with random walks as heuristic, a trial takes
+    up to a second on the larger default instances of the testbed)
+  - ucb1_selection: UCB1 action selection in a root node that has been
+    created by THTS (a selection)
+  - dfs_expansion: DFS on the determinized task up to a fixed depth (a state)
+
+  All benchmarks work on the caches of the planner as they are, i.e., they
+  measure the primitives after the caches have been filled with the results of
+  the fixture states (as during search).
+*/
+
+#include "micro_benchmark.h"
+
+#include "../action_selection.h"
+#include "../depth_first_search.h"
+#include "../parser.h"
+#include "../planning_task.h"
+#include "../simulator.h"
+#include "../thts.h"
+
+#include "../utils/logger.h"
+#include "../utils/math_utils.h"
+#include "../utils/system_utils.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace {
+// Makes the computation of successor states (which is protected in
+// ProbabilisticSearchEngine) accessible to the benchmarks
+class TransitionEngine : public ProbabilisticSearchEngine {
+public:
+    TransitionEngine(PlanningTask& _task)
+        : ProbabilisticSearchEngine("Transitions", _task) {}
+
+    using ProbabilisticSearchEngine::calcSuccessorState;
+
+    void estimateQValue(State const& /*state*/, int /*actionIndex*/,
+                        double& /*qValue*/) override {
+        assert(false);
+    }
+
+    void estimateQValues(State const& /*state*/,
+                         vector<int> const& /*actionsToExpand*/,
+                         vector<double>& /*qValues*/) override {
+        assert(false);
+    }
+
+    void printRoundStatistics(string /*indent*/) const override {}
+    void printStepStatistics(string /*indent*/) const override {}
+};
+
+struct Fixture {
+    // The sampled states (with hash keys) and an applicable action for each
+    vector<State> states;
+    vector<int> actions;
+
+    // The same states without hash keys
+    vector<State> statesWithoutHashKeys;
+};
+
+void createFixture(Fixture& fixture, PlanningTask& task,
+                   TransitionEngine const& engine, int numberOfStates,
+                   int seed) {
+    Simulator simulator(task, seed);
+    while (fixture.states.size() < numberOfStates) {
+        simulator.initRound();
+        for (int step = 0; step < task.horizon; ++step) {
+            if (fixture.states.size() == numberOfStates) {
+                break;
+            }
+            State state(simulator.getCurrentState(),
+                        task.horizon - step);
+            fixture.statesWithoutHashKeys.push_back(state);
+            State::calcStateFluentHashKeys(state);
+            State::calcStateHashKey(state);
+
+            vector<int> applicableActions =
+                engine.getIndicesOfApplicableActions(state);
+            int action = task.rnd.randomElement(applicableActions);
+            fixture.states.push_back(state);
+            fixture.actions.push_back(action);
+            simulator.applyAction(action);
+        }
+    }
+}
+
+void printUsage() {
+    cout << "Usage: ./search-benchmarks <rddl-file> [<options>]" << endl
+         << endl;
+    cout << "Measures the time and the number of heap allocations per "
+            "operation of the primitives of the search on the task of the "
+            "given RDDL instance (the external parser must be available as in "
+            "the local simulation)."
+         << endl
+         << endl;
+
+    cout << "  --domain <path>" << endl;
+    cout << "    The RDDL file with the domain if the instance file doesn't "
+            "contain it."
+         << endl << endl;
+
+    cout << "  --parser-options <string>" << endl;
+    cout << "    Options that are passed to the RDDL parser." << endl;
+    cout << "    Default: \"\"" << endl << endl;
+
+    cout << "  --states <int>" << endl;
+    cout << "    The number of sampled states in the fixture." << endl;
+    cout << "    Default: 100" << endl << endl;
+
+    cout << "  --seed <int>" << endl;
+    cout << "    The seed that is used to sample the fixture and by the "
+            "search."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
+    cout << "  --min-time <double>" << endl;
+    cout << "    The minimal time in seconds that is spent in each benchmark."
+         << endl;
+    cout << "    Default: 1.0" << endl << endl;
+
+    cout << "  --filter <string>" << endl;
+    cout << "    Only run benchmarks whose name contains the given string."
+         << endl << endl;
+
+    cout << "  --thts <SearchEngine>" << endl;
+    cout << "    The THTS configuration that is used in thts_trial and "
+            "ucb1_selection (it is always run with a fixed number of trials)."
+         << endl;
+    cout << "    Default: [THTS -act [UCB1] -out [UMC] -backup [PB] -init "
+            "[Expand -h [Uniform]]]"
+         << endl << endl;
+
+    cout << "  --trials <int>" << endl;
+    cout << "    The number of THTS trials per step." << endl;
+    cout << "    Default: 100" << endl << endl;
+
+    cout << "  --dfs-depth <int>" << endl;
+    cout << "    The search depth of dfs_expansion." << endl;
+    cout << "    Default: 2" << endl;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    /******************************************************************
+                          Parse command line
+    ******************************************************************/
+
+    string instanceFileName = string(argv[1]);
+    string domainFileName = "";
+    string parserOptions = "";
+    int numberOfStates = 100;
+    int seed = 0;
+    double minTime = 1.0;
+    string filter = "";
+    string thtsDesc = "[THTS -act [UCB1] -out [UMC] -backup [PB] -init "
+                      "[Expand -h [Uniform]]]";
+    int numberOfTrials = 100;
+    int dfsDepth = 2;
+
+    for (int i = 2; i < argc; ++i) {
+        string nextOption = string(argv[i]);
+        if (i + 1 == argc) {
+            cerr << "Missing value of option: " << nextOption << endl;
+            printUsage();
+            return 1;
+        } else if (nextOption == "--domain") {
+            domainFileName = string(argv[++i]);
+        } else if (nextOption == "--parser-options") {
+            parserOptions = string(argv[++i]);
+        } else if (nextOption == "--states") {
+            numberOfStates = atoi(argv[++i]);
+        } else if (nextOption == "--seed") {
+            seed = atoi(argv[++i]);
+        } else if (nextOption == "--min-time") {
+            minTime = atof(argv[++i]);
+        } else if (nextOption == "--filter") {
+            filter = string(argv[++i]);
+        } else if (nextOption == "--thts") {
+            thtsDesc = string(argv[++i]);
+        } else if (nextOption == "--trials") {
+            numberOfTrials = atoi(argv[++i]);
+        } else if (nextOption == "--dfs-depth") {
+            dfsDepth = atoi(argv[++i]);
+        } else {
+            cerr << "Unknown option: " << nextOption << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    /******************************************************************
+                        Parse task and create fixture
+    ******************************************************************/
+
+    Logger::runVerbosity = Verbosity::SILENT;
+    MathUtils::resetRNG();
+
+    vector<string> rddlFiles;
+    if (!domainFileName.empty()) {
+        rddlFiles.push_back(domainFileName);
+    }
+    rddlFiles.push_back(instanceFileName);
+    map<string, int> stateVariableIndices;
+    vector<vector<string>> stateVariableValues;
+    PlanningTask task;
+    Parser::parseRDDLTask(task, Simulator::readRDDLFiles(rddlFiles),
+                          parserOptions, stateVariableIndices,
+                          stateVariableValues);
+    task.rnd.seed(seed);
+
+    TransitionEngine engine(task);
+    Fixture fixture;
+    createFixture(fixture, task, engine, numberOfStates, seed);
+
+    SearchEngine* searchEngine = SearchEngine::fromString(thtsDesc, task);
+    THTS* thts = dynamic_cast<THTS*>(searchEngine);
+    if (!thts) {
+        SystemUtils::abort("Error: the benchmarked search engine must be THTS");
+    }
+    thts->setTerminationMethod(THTS::NUMBER_OF_TRIALS);
+    thts->setMaxNumberOfTrials(numberOfTrials);
+    thts->initSession();
+    if (thts->usesBDDs()) {
+        task.initBDDs();
+    }
+    thts->initRound();
+
+    // DFS is used via the SearchEngine interface where the computation of
+    // applicable actions is public
+    std::unique_ptr<SearchEngine> dfs(new DepthFirstSearch(task));
+    dfsDepth = min(dfsDepth, task.horizon);
+    dfs->setMaxSearchDepth(dfsDepth);
+    // Otherwise, all but the first expansion of a state are cache lookups
+    dfs->disableCaching();
+
+    /******************************************************************
+                            Define benchmarks
+    ******************************************************************/
+
+    vector<State>& states = fixture.states;
+    vector<int>& actions = fixture.actions;
+    vector<MicroBenchmark> benchmarks;
+
+    PDState successor(task.horizon);
+    benchmarks.emplace_back("successor_state", [&]() {
+        for (size_t i = 0; i < states.size(); ++i) {
+            successor.reset(states[i].stepsToGo() - 1);
+            engine.calcSuccessorState(states[i], actions[i], successor);
+        }
+        return static_cast<long>(states.size());
+    });
+
+    benchmarks.emplace_back("applicable_actions", [&]() {
+        for (State const& state : states) {
+            doNotOptimizeAway(engine.getApplicableActions(state));
+        }
+        return static_cast<long>(states.size());
+    });
+
+    DiscretePD pd;
+    benchmarks.emplace_back("evaluate_to_pd", [&]() {
+        long operations = 0;
+        for (size_t i = 0; i < states.size(); ++i) {
+            ActionState const& action = task.actionStates[actions[i]];
+            for (ProbabilisticCPF* cpf : task.probabilisticCPFs) {
+                pd.reset();
+                cpf->formula->evaluateToPD(pd, states[i], action);
+                ++operations;
+            }
+        }
+        return operations;
+    });
+
+    // The non-deterministic distributions of the successors of the fixture
+    vector<DiscretePD> pds;
+    for (size_t i = 0; i < states.size(); ++i) {
+        successor.reset(states[i].stepsToGo() - 1);
+        engine.calcSuccessorState(states[i], actions[i], successor);
+        for (int var = 0; var < State::numberOfProbabilisticStateFluents();
+             ++var) {
+            DiscretePD const& succPD =
+                successor.probabilisticStateFluentAsPD(var);
+            if (!succPD.isDeterministic()) {
+                pds.push_back(succPD);
+            }
+        }
+    }
+
+    OutcomeMask noOutcomes;
+    benchmarks.emplace_back("outcome_sampling", [&]() {
+        for (DiscretePD const& outcomePD : pds) {
+            doNotOptimizeAway(outcomePD.sample(task.rnd, noOutcomes));
+        }
+        return static_cast<long>(pds.size());
+    });
+
+    OutcomeMask firstOutcome;
+    firstOutcome.insert(0);
+    benchmarks.emplace_back("blacklisted_sampling", [&]() {
+        for (DiscretePD const& outcomePD : pds) {
+            doNotOptimizeAway(outcomePD.sample(task.rnd, firstOutcome));
+        }
+        return static_cast<long>(pds.size());
+    });
+
+    benchmarks.emplace_back("random_numbers", [&]() {
+        int const numberOfPairs = 1000;
+        for (int i = 0; i < numberOfPairs; ++i) {
+            doNotOptimizeAway(task.rnd.genReal());
+            doNotOptimizeAway(task.rnd.genInt(0, task.numberOfActions - 1));
+        }
+        return static_cast<long>(numberOfPairs);
+    });
+
+    State scratch(task.horizon);
+    benchmarks.emplace_back("state_hashing", [&]() {
+        State::HashWithRemSteps hash;
+        for (State const& state : fixture.statesWithoutHashKeys) {
+            scratch.setTo(state);
+            State::calcStateFluentHashKeys(scratch);
+            State::calcStateHashKey(scratch);
+            doNotOptimizeAway(hash(scratch));
+        }
+        return static_cast<long>(fixture.statesWithoutHashKeys.size());
+    });
+
+    vector<State> copies(states);
+    benchmarks.emplace_back("state_equality", [&]() {
+        State::EqualWithRemSteps equal;
+        for (size_t i = 0; i < states.size(); ++i) {
+            doNotOptimizeAway(equal(states[i], copies[i]));
+        }
+        return static_cast<long>(states.size());
+    });
+
+    unordered_map<State, int, State::HashWithRemSteps,
+                  State::EqualWithRemSteps>
+        stateMap;
+    for (size_t i = 0; i < states.size(); ++i) {
+        stateMap[states[i]] = i;
+    }
+    benchmarks.emplace_back("state_lookup", [&]() {
+        for (State const& state : copies) {
+            doNotOptimizeAway(stateMap.find(state)->second);
+        }
+        return static_cast<long>(copies.size());
+    });
+
+    benchmarks.emplace_back("thts_trial", [&]() {
+        long trials = 0;
+        for (State const& state : states) {
+            thts->initStep(state);
+            vector<int> bestActions;
+            thts->estimateBestActions(state, bestActions);
+            trials += thts->getNumberOfTrials();
+            thts->finishStep();
+        }
+        return trials;
+    });
+
+    // The search tree of the first fixture state where THTS does not solve the
+    // root node is created in the warm-up run (it must not be created before, as it is
+    // destroyed when THTS is started in another state)
+    std::unique_ptr<ActionSelection> ucb1;
+    SearchNode* root = nullptr;
+    benchmarks.emplace_back("ucb1_selection", [&]() {
+        if (!root) {
+            string ucb1Desc = "[UCB1]";
+            ucb1.reset(ActionSelection::fromString(ucb1Desc, thts));
+            // Always select actions with the UCB1 formula
+            ucb1->setMaxVisitDiff(numeric_limits<int>::max());
+            for (State const& state : states) {
+                thts->initStep(state);
+                vector<int> bestActions;
+                thts->estimateBestActions(state, bestActions);
+                SearchNode const* node = thts->getCurrentRootNode();
+                if (node && !node->solved && (node->numberOfVisits > 1)) {
+                    ucb1->initStep(state);
+                    root = const_cast<SearchNode*>(node);
+                    break;
+                }
+            }
+            if (!root) {
+                return 0L;
+            }
+        }
+        int const selections = 1000;
+        for (int i = 0; i < selections; ++i) {
+            doNotOptimizeAway(ucb1->selectAction(root));
+        }
+        return static_cast<long>(selections);
+    });
+
+    vector<State> dfsStates(states);
+    for (State& state : dfsStates) {
+        state.stepsToGo() = dfsDepth;
+    }
+    vector<double> qValues(task.numberOfActions);
+    benchmarks.emplace_back("dfs_expansion", [&]() {
+        for (State const& state : dfsStates) {
+            vector<int> actionsToExpand = dfs->getApplicableActions(state);
+            fill(qValues.begin(), qValues.end(),
+                 -numeric_limits<double>::max());
+            dfs->estimateQValues(state, actionsToExpand, qValues);
+        }
+        return static_cast<long>(dfsStates.size());
+    });
+
+    /******************************************************************
+                              Run benchmarks
+    ******************************************************************/
+
+    vector<MicroBenchmarkResult> results;
+    for (MicroBenchmark const& benchmark : benchmarks) {
+        if (benchmark.name.find(filter) != string::npos) {
+            results.push_back(benchmark.run(minTime));
+        }
+    }
+    printMicroBenchmarkResults(task.taskName, results);
+    delete searchEngine;
+    return 0;
+}
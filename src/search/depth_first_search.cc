@@ -14,8 +14,8 @@ using namespace std;
                      Search Engine Creation
 ******************************************************************/
 
-DepthFirstSearch::DepthFirstSearch()
-    : DeterministicSearchEngine("DFS"), rewardHelperVar(0.0) {}
+DepthFirstSearch::DepthFirstSearch(PlanningTask& _task)
+    : DeterministicSearchEngine("DFS", _task), rewardHelperVar(0.0) {}
 
 /******************************************************************
                        Main Search Functions
@@ -34,7 +34,7 @@ void DepthFirstSearch::estimateQValues(State const& state,
                                        vector<double>& qValues) {
     assert(state.stepsToGo() > 0);
     assert(state.stepsToGo() <= maxSearchDepth);
-    assert(qValues.size() == SearchEngine::numberOfActions);
+    assert(qValues.size() == task.numberOfActions);
 
     for (unsigned int index = 0; index < qValues.size(); ++index) {
         if (actionsToExpand[index] == index) {
@@ -52,9 +52,9 @@ void DepthFirstSearch::applyAction(State const& state, int const& actionIndex,
     // Logger::logLine("reward: " + to_string(reward), Verbosity::DEBUG);
 
     // Check if the next state is already cached
-    if (DeterministicSearchEngine::stateValueCache.find(nxt) !=
-        DeterministicSearchEngine::stateValueCache.end()) {
-        reward += DeterministicSearchEngine::stateValueCache[nxt];
+    if (caches.stateValueCache.find(nxt) !=
+        caches.stateValueCache.end()) {
+        reward += caches.stateValueCache[nxt];
         return;
     }
 
@@ -73,8 +73,8 @@ void DepthFirstSearch::applyAction(State const& state, int const& actionIndex,
 
 void DepthFirstSearch::expandState(State const& state, double& result) {
     assert(!cachingEnabled ||
-           (DeterministicSearchEngine::stateValueCache.find(state) ==
-            DeterministicSearchEngine::stateValueCache.end()));
+           (caches.stateValueCache.find(state) ==
+            caches.stateValueCache.end()));
     assert(MathUtils::doubleIsMinusInfinity(result));
 
     // Get applicable actions
@@ -91,6 +91,6 @@ void DepthFirstSearch::expandState(State const& state, double& result) {
 
     // Cache state value if caching is enabled
     if (cachingEnabled) {
-        DeterministicSearchEngine::stateValueCache[state] = result;
+        caches.stateValueCache[state] = result;
     }
 }
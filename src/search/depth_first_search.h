@@ -14,7 +14,7 @@ class UCTSearchEngine;
 
 class DepthFirstSearch : public DeterministicSearchEngine {
 public:
-    DepthFirstSearch();
+    DepthFirstSearch(PlanningTask& _task);
 
     // Start the search engine to estimate the Q-value of a single action
     void estimateQValue(State const& state, int actionIndex,
@@ -15,6 +15,11 @@ public:
                // caching
     };
 
+    // The formula is owned by this, the fluents in it by the PlanningTask
+    virtual ~Evaluatable() {
+        LogicalExpression::deleteSubexpression(formula);
+    }
+
     // This function is called for state transitions with KleeneStates. The
     // result of the evaluation is a set of values, i.e., a subset of the domain
     // of this Evaluatable
@@ -73,6 +78,66 @@ public:
         }
     }
 
+    // This function is called for state transitions with KleeneStates if the
+    // result is stored as bitset (i.e., if this is a CPF with a small domain).
+    // The results are cached as bitsets as well, so no std::set is created
+    // unless the formula has to be evaluated.
+    void evaluateToKleene(uint64_t& res, KleeneState const& current,
+                          ActionState const& actions) {
+        assert(res == 0);
+        switch (kleeneCachingType) {
+        case NONE:
+            res = evaluateFormulaToKleeneBits(current, actions);
+            break;
+        case MAP:
+            stateHashKey = current.stateFluentHashKey(hashIndex) +
+                           actionHashKeyMap[actions.index];
+            assert((current.stateFluentHashKey(hashIndex) >= 0) &&
+                   (actionHashKeyMap[actions.index] >= 0) &&
+                   (stateHashKey >= 0));
+
+            if (kleeneBitsCacheMap.find(stateHashKey) !=
+                kleeneBitsCacheMap.end()) {
+                res = kleeneBitsCacheMap[stateHashKey];
+            } else {
+                res = evaluateFormulaToKleeneBits(current, actions);
+                kleeneBitsCacheMap[stateHashKey] = res;
+            }
+            break;
+        case DISABLED_MAP:
+            stateHashKey = current.stateFluentHashKey(hashIndex) +
+                           actionHashKeyMap[actions.index];
+            assert((current.stateFluentHashKey(hashIndex) >= 0) &&
+                   (actionHashKeyMap[actions.index] >= 0) &&
+                   (stateHashKey >= 0));
+
+            if (kleeneBitsCacheMap.find(stateHashKey) !=
+                kleeneBitsCacheMap.end()) {
+                res = kleeneBitsCacheMap[stateHashKey];
+            } else {
+                res = evaluateFormulaToKleeneBits(current, actions);
+            }
+            break;
+        case VECTOR:
+            stateHashKey = current.stateFluentHashKey(hashIndex) +
+                           actionHashKeyMap[actions.index];
+            assert((current.stateFluentHashKey(hashIndex) >= 0) &&
+                   (actionHashKeyMap[actions.index] >= 0) &&
+                   (stateHashKey >= 0));
+            assert(stateHashKey < kleeneBitsCacheVector.size());
+
+            // The result of a Kleene evaluation is never empty, so 0 marks
+            // entries that have not been computed yet
+            if (kleeneBitsCacheVector[stateHashKey] == 0) {
+                res = evaluateFormulaToKleeneBits(current, actions);
+                kleeneBitsCacheVector[stateHashKey] = res;
+            } else {
+                res = kleeneBitsCacheVector[stateHashKey];
+            }
+            break;
+        }
+    }
+
     // Properties
     virtual bool isProbabilistic() const = 0;
 
@@ -105,6 +170,11 @@ public:
     std::unordered_map<long, std::set<double>> kleeneEvaluationCacheMap;
     std::vector<std::set<double>> kleeneEvaluationCacheVector;
 
+    // If Kleene evaluation results are stored as bitsets, these are used for
+    // caching instead of the two datastructures above
+    std::unordered_map<long, uint64_t> kleeneBitsCacheMap;
+    std::vector<uint64_t> kleeneBitsCacheVector;
+
     // ActionHashKeyMap contains the hash keys of the actions that influence
     // this Evaluatable (these are added to the state fluent hash keys of a
     // state)
@@ -116,6 +186,18 @@ public:
     long stateHashKey;
 
 protected:
+    uint64_t evaluateFormulaToKleeneBits(KleeneState const& current,
+                                         ActionState const& actions) const {
+        std::set<double> values;
+        formula->evaluateToKleene(values, current, actions);
+        uint64_t res = 0;
+        for (double val : values) {
+            assert((val >= 0.0) && (val < KleeneState::maxBitsetDomainSize));
+            res |= (uint64_t(1) << static_cast<int>(val));
+        }
+        return res;
+    }
+
     Evaluatable(std::string _name, int _hashIndex)
         : name(_name),
           formula(nullptr),
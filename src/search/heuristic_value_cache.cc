@@ -0,0 +1,71 @@
+#include "heuristic_value_cache.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+int HeuristicValueCache::registerHeuristic(string const& description,
+                                           int maxSearchDepth,
+                                           int maxMemoryInMB,
+                                           int numberOfActions) {
+    // Estimate the memory of an entry from the size of its state and its
+    // Q-values (plus some overhead for the hash map node and the bucket)
+    size_t entrySize =
+        sizeof(State) + sizeof(vector<double>) + 4 * sizeof(void*) +
+        sizeof(double) * (State::numberOfDeterministicStateFluents() +
+                          State::numberOfProbabilisticStateFluents() +
+                          numberOfActions) +
+        sizeof(long) * State::numberOfStateFluentHashKeys();
+    size_t maxMemory = static_cast<size_t>(maxMemoryInMB) * 1024 * 1024;
+    size_t capacity = max(maxMemory / (2 * entrySize), size_t(1));
+
+    for (size_t id = 0; id < partitions.size(); ++id) {
+        if ((partitions[id].description == description) &&
+            (partitions[id].maxSearchDepth == maxSearchDepth)) {
+            partitions[id].capacity = max(partitions[id].capacity, capacity);
+            return id;
+        }
+    }
+    partitions.emplace_back(description, maxSearchDepth, capacity);
+    return partitions.size() - 1;
+}
+
+vector<double> const* HeuristicValueCache::lookup(int heuristicId,
+                                                  State const& state) {
+    assert(heuristicId >= 0 && heuristicId < partitions.size());
+    Partition& partition = partitions[heuristicId];
+
+    QValueHashMap::const_iterator it = partition.currentGeneration.find(state);
+    if (it != partition.currentGeneration.end()) {
+        return &it->second;
+    }
+
+    it = partition.olderGeneration.find(state);
+    if (it == partition.olderGeneration.end()) {
+        return nullptr;
+    }
+    vector<double> qValues = it->second;
+    partition.olderGeneration.erase(it);
+    insert(heuristicId, state, qValues);
+    return &partition.currentGeneration.find(state)->second;
+}
+
+void HeuristicValueCache::insert(int heuristicId, State const& state,
+                                 vector<double> const& qValues) {
+    assert(heuristicId >= 0 && heuristicId < partitions.size());
+    Partition& partition = partitions[heuristicId];
+
+    if (partition.currentGeneration.size() >= partition.capacity) {
+        partition.olderGeneration.swap(partition.currentGeneration);
+        partition.currentGeneration.clear();
+    }
+    partition.currentGeneration[state] = qValues;
+}
+
+void HeuristicValueCache::clear() {
+    for (Partition& partition : partitions) {
+        QValueHashMap().swap(partition.currentGeneration);
+        QValueHashMap().swap(partition.olderGeneration);
+    }
+}
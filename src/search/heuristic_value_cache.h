@@ -0,0 +1,72 @@
+#ifndef HEURISTIC_VALUE_CACHE_H
+#define HEURISTIC_VALUE_CACHE_H
+
+// The HeuristicValueCache stores the Q-value estimates of the heuristics that
+// are used to initialize search nodes. Entries are keyed by the state
+// (including the remaining steps) and by the id of the heuristic, which is
+// derived from the description and the maximal search depth of the heuristic
+// such that initializers with identical heuristics share their entries, but
+// the estimates of a heuristic with different search depths (e.g., before and
+// after IDS has reduced its depth) are never mixed. Since the cache is part of
+// the PlanningTask, entries persist across steps and rounds.
+//
+// The memory of each heuristic's entries is bounded: entries are stored in two
+// generations, and if the current generation uses half of the memory that is
+// available to the heuristic, it replaces the older generation (which is
+// discarded) and a new generation is started. Entries that are found in the
+// older generation are moved to the current one, so the entries that have been
+// used recently are kept.
+
+#include "states.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class HeuristicValueCache {
+public:
+    // Returns the id of the heuristic with the given description and maximal
+    // search depth, where the entries of the heuristic use at most
+    // maxMemoryInMB MB
+    int registerHeuristic(std::string const& description, int maxSearchDepth,
+                          int maxMemoryInMB, int numberOfActions);
+
+    // Returns the cached Q-values of state under the heuristic with the given
+    // id, or nullptr if there are none. The returned pointer is valid until
+    // the next call to insert or clear.
+    std::vector<double> const* lookup(int heuristicId, State const& state);
+
+    // Caches the Q-values of state under the heuristic with the given id
+    void insert(int heuristicId, State const& state,
+                std::vector<double> const& qValues);
+
+    // Removes all entries (this is called when memory becomes sparse)
+    void clear();
+
+private:
+    typedef std::unordered_map<State, std::vector<double>,
+                               State::HashWithRemSteps,
+                               State::EqualWithRemSteps>
+        QValueHashMap;
+
+    struct Partition {
+        Partition(std::string const& _description, int _maxSearchDepth,
+                  size_t _capacity)
+            : description(_description),
+              maxSearchDepth(_maxSearchDepth),
+              capacity(_capacity) {}
+
+        std::string description;
+        int maxSearchDepth;
+
+        // The number of entries of a generation
+        size_t capacity;
+
+        QValueHashMap currentGeneration;
+        QValueHashMap olderGeneration;
+    };
+
+    std::vector<Partition> partitions;
+};
+
+#endif
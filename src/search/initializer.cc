@@ -7,6 +7,8 @@
 #include "utils/string_utils.h"
 #include "utils/system_utils.h"
 
+#include <sstream>
+
 /******************************************************************
                      Search Engine Creation
 ******************************************************************/
@@ -25,6 +27,9 @@ Initializer* Initializer::fromString(std::string& desc, THTS* thts) {
     } else if (desc.find("Single") == 0) {
         desc = desc.substr(6, desc.size());
         result = new SingleChildInitializer(thts);
+    } else if (desc.find("Batch") == 0) {
+        desc = desc.substr(5, desc.size());
+        result = new BatchedExpandNodeInitializer(thts);
     } else {
         SystemUtils::abort("Unknown Initializer: " + desc);
     }
@@ -46,7 +51,8 @@ Initializer* Initializer::fromString(std::string& desc, THTS* thts) {
 
 bool Initializer::setValueFromString(std::string& param, std::string& value) {
     if (param == "-h") {
-        setHeuristic(SearchEngine::fromString(value));
+        heuristicDescription = value;
+        setHeuristic(SearchEngine::fromString(value, thts->getTask()));
         return true;
     } else if (param == "-hw") {
         setHeuristicWeight(atof(value.c_str()));
@@ -54,6 +60,9 @@ bool Initializer::setValueFromString(std::string& param, std::string& value) {
     } else if (param == "-iv") {
         setNumberOfInitialVisits(atoi(value.c_str()));
         return true;
+    } else if (param == "-hvc") {
+        setMaxHeuristicValueCacheMemory(atoi(value.c_str()));
+        return true;
     }
 
     return false;
@@ -71,11 +80,44 @@ Initializer::~Initializer() {
 void Initializer::disableCaching() {
     assert(heuristic);
     heuristic->disableCaching();
+    thts->getTask().heuristicValueCache.clear();
+    heuristicId = -1;
+}
+
+void Initializer::loadCaches(PersistentCache const& cache) {
+    assert(heuristic);
+    heuristic->loadCaches(cache);
+}
+
+void Initializer::storeCaches(PersistentCache& cache) const {
+    assert(heuristic);
+    heuristic->storeCaches(cache);
+}
+
+std::string Initializer::getCacheConfig() const {
+    assert(heuristic);
+    std::stringstream ss;
+    ss << name << " -hw " << heuristicWeight << " -iv "
+       << numberOfInitialVisits << " -h [" << heuristic->getCacheConfig()
+       << "]";
+    return ss.str();
 }
 
 void Initializer::initSession() {
     assert(heuristic);
     heuristic->initSession();
+
+    if (maxHeuristicValueCacheMemory > 0) {
+        registerHeuristic();
+    }
+}
+
+void Initializer::registerHeuristic() {
+    PlanningTask& task = thts->getTask();
+    heuristicSearchDepth = heuristic->getMaxSearchDepth();
+    heuristicId = task.heuristicValueCache.registerHeuristic(
+        heuristicDescription, heuristicSearchDepth,
+        maxHeuristicValueCacheMemory, task.numberOfActions);
 }
 
 void Initializer::initRound() {
@@ -91,6 +133,7 @@ void Initializer::finishRound() {
 void Initializer::initStep(State const& current) {
     assert(heuristic);
     heuristic->initStep(current);
+    heuristicValueCacheHits = 0;
 }
 
 void Initializer::finishStep() {
@@ -98,6 +141,31 @@ void Initializer::finishStep() {
     heuristic->finishStep();
 }
 
+void Initializer::estimateQValues(State const& current,
+                                  std::vector<int> const& actionsToExpand,
+                                  std::vector<double>& qValues) {
+    if (heuristicId < 0) {
+        heuristic->estimateQValues(current, actionsToExpand, qValues);
+        return;
+    }
+    // The search depth of the heuristic can change during the search (e.g.,
+    // if IDS runs out of time), and so do its estimates
+    if (heuristic->getMaxSearchDepth() != heuristicSearchDepth) {
+        registerHeuristic();
+    }
+
+    HeuristicValueCache& cache = thts->getTask().heuristicValueCache;
+    std::vector<double> const* cachedQValues =
+        cache.lookup(heuristicId, current);
+    if (cachedQValues) {
+        qValues = *cachedQValues;
+        ++heuristicValueCacheHits;
+    } else {
+        heuristic->estimateQValues(current, actionsToExpand, qValues);
+        cache.insert(heuristicId, current, qValues);
+    }
+}
+
 /******************************************************************
                           Parameter Setter
 ******************************************************************/
@@ -127,11 +195,17 @@ void Initializer::printConfig(std::string indent) const {
                     std::to_string(heuristicWeight), Verbosity::VERBOSE);
     Logger::logLine(indent + "Number of initial visits: " +
                     std::to_string(numberOfInitialVisits), Verbosity::VERBOSE);
+    Logger::logLine(indent + "Heuristic value cache memory: " +
+                    std::to_string(maxHeuristicValueCacheMemory) + "MB",
+                    Verbosity::VERBOSE);
     assert(heuristic);
     heuristic->printConfig(indent);
 }
 
 void Initializer::printStepStatistics(std::string indent) const {
+    Logger::logLine(indent + "Heuristic value cache hits: " +
+                    std::to_string(heuristicValueCacheHits),
+                    Verbosity::VERBOSE);
     assert(heuristic);
     heuristic->printStepStatistics(indent);
 }
@@ -150,12 +224,12 @@ void ExpandNodeInitializer::initialize(SearchNode* node, State const& current) {
     // Logger::logLine(current.toString(), Verbosity::DEBUG);
 
     assert(node->children.empty());
-    node->children.resize(SearchEngine::numberOfActions, nullptr);
+    node->children.resize(thts->getTask().numberOfActions, nullptr);
 
     std::vector<int> actionsToExpand = thts->getApplicableActions(current);
-    std::vector<double> initialQValues(SearchEngine::numberOfActions,
+    std::vector<double> initialQValues(thts->getTask().numberOfActions,
                                        -std::numeric_limits<double>::max());
-    heuristic->estimateQValues(current, actionsToExpand, initialQValues);
+    estimateQValues(current, actionsToExpand, initialQValues);
 
     for (unsigned int index = 0; index < node->children.size(); ++index) {
         if (actionsToExpand[index] == index) {
@@ -181,7 +255,7 @@ void ExpandNodeInitializer::initialize(SearchNode* node, State const& current) {
 }
 
 /******************************************************************
-                        ExpandNodeInitializer
+                        SingleChildInitializer
 ******************************************************************/
 
 void SingleChildInitializer::initialize(SearchNode* node,
@@ -192,7 +266,7 @@ void SingleChildInitializer::initialize(SearchNode* node,
     std::vector<int> candidates;
 
     if (node->children.empty()) {
-        node->children.resize(SearchEngine::numberOfActions, nullptr);
+        node->children.resize(thts->getTask().numberOfActions, nullptr);
 
         std::vector<int> actionsToExpand = thts->getApplicableActions(current);
         for (unsigned int index = 0; index < node->children.size(); ++index) {
@@ -212,7 +286,7 @@ void SingleChildInitializer::initialize(SearchNode* node,
     }
 
     assert(!candidates.empty());
-    int actionIndex = MathUtils::rnd->randomElement(candidates);
+    int actionIndex = thts->getTask().rnd.randomElement(candidates);
 
     double initialQValue = 0.0;
     heuristic->estimateQValue(current, actionIndex, initialQValue);
@@ -231,3 +305,158 @@ void SingleChildInitializer::initialize(SearchNode* node,
     //                 Verbosity::DEBUG);
     // Logger::logLine(node->children[actionIndex]->toString(), Verbosity::DEBUG);
 }
+
+/******************************************************************
+                    BatchedExpandNodeInitializer
+******************************************************************/
+
+bool BatchedExpandNodeInitializer::setValueFromString(std::string& param,
+                                                      std::string& value) {
+    if (param == "-bs") {
+        setBatchSize(atoi(value.c_str()));
+        return true;
+    }
+
+    return Initializer::setValueFromString(param, value);
+}
+
+void BatchedExpandNodeInitializer::initStep(State const& current) {
+    assert(pendingNodes.empty());
+    numberOfBatches = 0;
+    numberOfEvaluatedStates = 0;
+    numberOfSharedEvaluations = 0;
+    numberOfDiscardedNodes = 0;
+
+    Initializer::initStep(current);
+}
+
+void BatchedExpandNodeInitializer::finishStep() {
+    // If the tree is reused in the next step, pending nodes can be part of it
+    // and must not keep their provisional values. Otherwise, they are released
+    // before the next step starts.
+    if (thts->searchesSpeculatively()) {
+        if (numberOfPendingNodes > 0) {
+            evaluateBatch();
+        }
+    } else {
+        discardPendingNodes();
+    }
+
+    Initializer::finishStep();
+}
+
+void BatchedExpandNodeInitializer::initTrial() {
+    if (numberOfPendingNodes >= batchSize) {
+        evaluateBatch();
+    }
+}
+
+void BatchedExpandNodeInitializer::initialize(SearchNode* node,
+                                              State const& current) {
+    // The root node is needed for the recommendation, so the heuristic
+    // estimate is computed immediately
+    if (node == thts->getCurrentRootNode()) {
+        ExpandNodeInitializer::initialize(node, current);
+        return;
+    }
+
+    assert(node->children.empty());
+    PlanningTask const& task = thts->getTask();
+    node->children.resize(task.numberOfActions, nullptr);
+
+    std::vector<int> actionsToExpand = thts->getApplicableActions(current);
+    for (unsigned int index = 0; index < node->children.size(); ++index) {
+        if (actionsToExpand[index] == index) {
+            double reward = 0.0;
+            task.rewardCPF->evaluate(reward, current,
+                                     task.actionStates[index]);
+
+            node->children[index] = thts->createChanceNode(1.0);
+            node->children[index]->futureReward =
+                heuristicWeight * current.stepsToGo() * reward;
+            node->children[index]->numberOfVisits = numberOfInitialVisits;
+            node->children[index]->initialized = true;
+
+            node->numberOfVisits += numberOfInitialVisits;
+            node->futureReward = std::max(node->futureReward,
+                                          node->children[index]->futureReward);
+        }
+    }
+    node->initialized = true;
+
+    pendingNodes[current].push_back(node);
+    ++numberOfPendingNodes;
+}
+
+void BatchedExpandNodeInitializer::evaluateBatch() {
+    PROFILE_PHASE(INITIALIZATION);
+    ++numberOfBatches;
+
+    for (auto const& [state, nodes] : pendingNodes) {
+        std::vector<int> actionsToExpand = thts->getApplicableActions(state);
+        std::vector<double> initialQValues(thts->getTask().numberOfActions,
+                                           -std::numeric_limits<double>::max());
+        estimateQValues(state, actionsToExpand, initialQValues);
+        ++numberOfEvaluatedStates;
+        numberOfSharedEvaluations += nodes.size() - 1;
+
+        // Children that have been visited since their initialization keep
+        // their value. The value of the node is recomputed from its children
+        // like in a backup, while the values of its ancestors are updated by
+        // the next backup that passes through them
+        for (SearchNode* node : nodes) {
+            node->futureReward = -std::numeric_limits<double>::max();
+            for (unsigned int index = 0; index < node->children.size();
+                 ++index) {
+                SearchNode* child = node->children[index];
+                if (!child) {
+                    continue;
+                }
+                if (!child->solved &&
+                    (child->numberOfVisits == numberOfInitialVisits)) {
+                    assert(actionsToExpand[index] == index);
+                    child->futureReward =
+                        heuristicWeight * initialQValues[index];
+                }
+                if (child->initialized) {
+                    node->futureReward = std::max(
+                        node->futureReward, child->getExpectedRewardEstimate());
+                }
+            }
+        }
+    }
+
+    pendingNodes.clear();
+    numberOfPendingNodes = 0;
+}
+
+void BatchedExpandNodeInitializer::discardPendingNodes() {
+    numberOfDiscardedNodes += numberOfPendingNodes;
+    pendingNodes.clear();
+    numberOfPendingNodes = 0;
+}
+
+void BatchedExpandNodeInitializer::printConfig(std::string indent) const {
+    Initializer::printConfig(indent);
+    Logger::logLine(indent + "  Batch size: " + std::to_string(batchSize),
+                    Verbosity::VERBOSE);
+}
+
+void BatchedExpandNodeInitializer::printStepStatistics(
+    std::string indent) const {
+    Logger::logLine(indent + name + " step statistics:", Verbosity::VERBOSE);
+    Logger::logLine(indent + "  Evaluated batches: " +
+                    std::to_string(numberOfBatches), Verbosity::VERBOSE);
+    Logger::logLine(indent + "  Evaluated states: " +
+                    std::to_string(numberOfEvaluatedStates),
+                    Verbosity::VERBOSE);
+    Logger::logLine(indent + "  Shared evaluations: " +
+                    std::to_string(numberOfSharedEvaluations),
+                    Verbosity::VERBOSE);
+    Logger::logLine(indent + "  Discarded nodes: " +
+                    std::to_string(numberOfDiscardedNodes),
+                    Verbosity::VERBOSE);
+    Logger::logLine("", Verbosity::VERBOSE);
+
+    Initializer::printStepStatistics(indent);
+}
@@ -2,9 +2,12 @@
 #define INITIALIZER_H
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "states.h"
 
+class PersistentCache;
 class THTS;
 class SearchEngine;
 class SearchNode;
@@ -22,6 +25,14 @@ public:
     // This is called when caching is disabled because memory becomes sparse
     virtual void disableCaching();
 
+    // Restores or stores the caches of the heuristic
+    virtual void loadCaches(PersistentCache const& cache);
+    virtual void storeCaches(PersistentCache& cache) const;
+
+    // Returns a description of the configuration of this initializer and its
+    // heuristic (see SearchEngine::getCacheConfig)
+    virtual std::string getCacheConfig() const;
+
     virtual void initSession();
     virtual void initRound();
     virtual void finishRound();
@@ -40,6 +51,11 @@ public:
         numberOfInitialVisits = _numberOfInitialVisits;
     }
 
+    virtual void setMaxHeuristicValueCacheMemory(
+        int _maxHeuristicValueCacheMemory) {
+        maxHeuristicValueCacheMemory = _maxHeuristicValueCacheMemory;
+    }
+
     virtual void setMaxSearchDepth(int maxSearchDepth);
 
     // Print
@@ -56,7 +72,21 @@ protected:
           name(_name),
           heuristic(nullptr),
           heuristicWeight(0.5),
-          numberOfInitialVisits(1) {}
+          numberOfInitialVisits(1),
+          maxHeuristicValueCacheMemory(0),
+          heuristicId(-1),
+          heuristicSearchDepth(-1),
+          heuristicValueCacheHits(0) {}
+
+    // Computes the heuristic estimates of the Q-values of all actions in
+    // actionsToExpand, where cached estimates are used if available
+    void estimateQValues(State const& current,
+                         std::vector<int> const& actionsToExpand,
+                         std::vector<double>& qValues);
+
+    // Registers the heuristic with its current search depth in the heuristic
+    // value cache
+    void registerHeuristic();
 
     THTS* thts;
     std::string name;
@@ -65,6 +95,19 @@ protected:
     SearchEngine* heuristic;
     double heuristicWeight;
     int numberOfInitialVisits;
+
+    // The memory (in MB) that is used to cache the estimates of the heuristic
+    // across steps and rounds (caching is disabled if this is 0)
+    int maxHeuristicValueCacheMemory;
+
+    // The description of the heuristic, its id in the heuristic value cache
+    // and the search depth of the heuristic it was registered with
+    std::string heuristicDescription;
+    int heuristicId;
+    int heuristicSearchDepth;
+
+    // Per step statistics
+    int heuristicValueCacheHits;
 };
 
 class ExpandNodeInitializer : public Initializer {
@@ -72,6 +115,10 @@ public:
     ExpandNodeInitializer(THTS* _thts) : Initializer(_thts, "ExpandNode initializer") {}
 
     void initialize(SearchNode* node, State const& current) override;
+
+protected:
+    ExpandNodeInitializer(THTS* _thts, std::string _name)
+        : Initializer(_thts, _name) {}
 };
 
 class SingleChildInitializer : public Initializer {
@@ -81,4 +128,74 @@ public:
     void initialize(SearchNode* node, State const& current) override;
 };
 
+// The BatchedExpandNode initializer expands decision nodes like the ExpandNode
+// initializer, but it does not compute the heuristic estimate immediately.
+// Instead, the children of a new decision node are given the provisional value
+// stepsToGo * R(s,a) (i.e., the value if the immediate reward was achieved in
+// all remaining steps), the node is queued and trials continue. Once
+// batchSize nodes are pending, the heuristic evaluates all their states
+// between two trials, where nodes that represent the same state share a
+// single evaluation, the provisional values of all children that have not
+// been visited since are replaced by the heuristic estimate and the values of
+// the nodes are recomputed from their children. Pending nodes
+// are discarded at the end of the step (so the heuristic is never called for
+// nodes that are not needed for the decision) unless the tree is reused in the
+// next step with speculative search, in which case they are evaluated. The root
+// node is always initialized immediately.
+class BatchedExpandNodeInitializer : public ExpandNodeInitializer {
+public:
+    BatchedExpandNodeInitializer(THTS* _thts)
+        : ExpandNodeInitializer(_thts, "BatchedExpandNode initializer"),
+          batchSize(32),
+          numberOfPendingNodes(0),
+          numberOfBatches(0),
+          numberOfEvaluatedStates(0),
+          numberOfSharedEvaluations(0),
+          numberOfDiscardedNodes(0) {}
+
+    // Set parameters from command line
+    bool setValueFromString(std::string& param, std::string& value) override;
+
+    // Parameter setter
+    void setBatchSize(int _batchSize) {
+        batchSize = _batchSize;
+    }
+
+    void initStep(State const& current) override;
+    void finishStep() override;
+    void initTrial() override;
+
+    // Print
+    void printConfig(std::string indent) const override;
+    void printStepStatistics(std::string indent) const override;
+
+    void initialize(SearchNode* node, State const& current) override;
+
+private:
+    // Computes the heuristic estimates of all pending nodes
+    void evaluateBatch();
+
+    // Discards all pending nodes (which keep their provisional values, so this
+    // must only be called if they are not used anymore)
+    void discardPendingNodes();
+
+    // The pending nodes, grouped by the state they represent
+    typedef std::unordered_map<State, std::vector<SearchNode*>,
+                               State::HashWithRemSteps,
+                               State::EqualWithRemSteps>
+        PendingNodeMap;
+    PendingNodeMap pendingNodes;
+
+    // Parameter
+    int batchSize;
+
+    int numberOfPendingNodes;
+
+    // Per step statistics
+    int numberOfBatches;
+    int numberOfEvaluatedStates;
+    int numberOfSharedEvaluations;
+    int numberOfDiscardedNodes;
+};
+
 #endif
@@ -1,13 +1,17 @@
 #include "ipc_client.h"
 
 #include "parser.h"
+#include "planning_task.h"
 #include "prost_planner.h"
 
 #include "utils/base64.h"
+#include "utils/math_utils.h"
 #include "utils/string_utils.h"
 #include "utils/strxml.h"
 #include "utils/system_utils.h"
+#include "utils/xml_pull_parser.h"
 
+#include <charconv>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
@@ -22,47 +26,89 @@ using namespace std;
 
 IPCClient::IPCClient(
         string _hostName, unsigned short _port, string _parserOptions)
-    : hostName(_hostName),
+    : planner(nullptr),
+      hostName(_hostName),
       port(_port),
       socket(-1),
       parserOptions(_parserOptions),
       numberOfRounds(-1),
-      remainingTime(0) {}
+      totalReward(0.0),
+      remainingTime(0),
+      actionsSubmitted(false),
+      responseReceived(false),
+      ioThreadStopped(false),
+      immediateReward(0.0),
+      roundEndMessage(nullptr) {}
 
 // This destructor is required here to allow forward declaration of
-// ProstPlanner in header because of usage of unique_ptr<ProstPlanner>
+// PlanningTask, ProstPlanner and XMLPullParser in header because of usage of
+// unique_ptr
 IPCClient::~IPCClient() = default;
 
-void IPCClient::run(string const& instanceName, string& plannerDesc) {
-    // Reset static members from possible earlier runs
-    ProstPlanner::resetStaticMembers();
+void IPCClient::run(string const& instanceName, string const& plannerDesc) {
+    // Reset the random number generator from possible earlier runs
+    MathUtils::resetRNG();
     // Init connection to the rddlsim server
     initConnection();
 
-    // Request round
-    initSession(instanceName, plannerDesc);
-
-    vector<double> nextState(stateVariableIndices.size());
-    double immediateReward = 0.0;
-
-    // Main loop
-    for (unsigned int currentRound = 0; currentRound < numberOfRounds;
-         ++currentRound) {
-        initRound(nextState, immediateReward);
-
-        while (true) {
-            planner->initStep(nextState, remainingTime);
-            vector<string> nextActions = planner->plan();
-            if (!submitAction(nextActions, nextState, immediateReward)) {
-                break;
+    try {
+        // Request round
+        initSession(instanceName, plannerDesc);
+
+        nextStateVec.assign(stateVariableIndices.size(), 0.0);
+        actionsSubmitted = false;
+        responseReceived = false;
+        ioThreadStopped = false;
+        ioError = nullptr;
+        ioThread = thread(&IPCClient::runIOThread, this,
+                          Logger::getThreadOutput(),
+                          SystemUtils::getAbortThrows());
+
+        // Main loop
+        for (unsigned int currentRound = 0; currentRound < numberOfRounds;
+             ++currentRound) {
+            initRound();
+
+            while (true) {
+                planner->initStep(nextState, remainingTime);
+                vector<string> nextActions = planner->plan();
+
+                // The statistics of the step are printed (and the search is
+                // continued speculatively) while the I/O thread waits for the
+                // response of the server
+                startSubmission(nextActions);
+                planner->printStepStatistics();
+                planner->searchSpeculatively(
+                    [this] { return responseReceived.load(); });
+                waitForResponse();
+
+                if (roundEndMessage) {
+                    finishRound(roundEndMessage);
+                    delete roundEndMessage;
+                    roundEndMessage = nullptr;
+                    break;
+                }
+                planner->finishStep(immediateReward);
             }
-            planner->finishStep(immediateReward);
         }
+        stopIOThread();
+
+        // Get end of session message and print total result
+        finishSession();
+    } catch (AbortError const&) {
+        // The session was aborted on a thread where aborts throw. The I/O
+        // thread is stopped and the connection is closed, so the client can
+        // be deleted.
+        if (ioThread.joinable()) {
+            stopIOThread();
+        }
+        delete roundEndMessage;
+        roundEndMessage = nullptr;
+        close(socket);
+        socket = -1;
+        throw;
     }
 
-    // Get end of session message and print total result
-    finishSession();
-
     // Close connection to the rddlsim server
     closeConnection();
 }
@@ -78,11 +124,14 @@ void IPCClient::initConnection() {
         if (socket <= 0) {
             SystemUtils::abort("Error: couldn't connect to server.");
         }
+    } catch (AbortError const&) {
+        throw;
     } catch (const exception& e) {
         SystemUtils::abort("Error: couldn't connect to server.");
     } catch (...) {
         SystemUtils::abort("Error: couldn't connect to server.");
     }
+    xmlParser = std::unique_ptr<XMLPullParser>(new XMLPullParser(socket));
 }
 
 int IPCClient::connectToServer() {
@@ -113,13 +162,15 @@ void IPCClient::closeConnection() {
         SystemUtils::abort("Error: couldn't disconnect from server.");
     }
     close(socket);
+    socket = -1;
 }
 
 /******************************************************************************
                      Session and rounds management
 ******************************************************************************/
 
-void IPCClient::initSession(string const& instanceName, string& plannerDesc) {
+void IPCClient::initSession(string const& instanceName,
+                            string const& plannerDesc) {
     stringstream os;
     os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
        << "<session-request>"
@@ -134,21 +185,34 @@ void IPCClient::initSession(string const& instanceName, string& plannerDesc) {
         SystemUtils::abort("Error: writing to socket failed.");
     }
 
-    const XMLNode* serverResponse = XMLNode::readNode(socket);
+    const XMLNode* serverResponse = XMLNode::readNode(*xmlParser);
     if (!serverResponse) {
         SystemUtils::abort("Error: initializing session failed.");
     }
 
     string s;
-    // If the task was not initialized, we have to read it from the server and
-    // run the parser
-    assert(SearchEngine::taskName.empty());
     if (!serverResponse->dissect("task", s)) {
         SystemUtils::abort(
             "Error: server response does not contain task description.");
     }
     s = decodeBase64(s);
-    executeParser(s);
+    // The task is read from the server, and the parser is only run if the task
+    // of the previous session of this client has a different description or
+    // has been parsed with different options
+    if (!task || (s != taskDesc) || (parserOptions != taskParserOptions)) {
+        // The planners of the previous task are deleted before the task
+        planners.clear();
+        stateVariableIndices.clear();
+        stateVariableValues.clear();
+        task = std::unique_ptr<PlanningTask>(new PlanningTask());
+        Parser::parseRDDLTask(*task, s, parserOptions, stateVariableIndices,
+                              stateVariableValues);
+        fluentNames.build(stateVariableIndices);
+        taskDesc = s;
+        taskParserOptions = parserOptions;
+    } else {
+        task->activate();
+    }
 
     if (!serverResponse->dissect("num-rounds", s)) {
         SystemUtils::abort("Error: server response insufficient.");
@@ -162,14 +226,22 @@ void IPCClient::initSession(string const& instanceName, string& plannerDesc) {
 
     delete serverResponse;
     // in c++ 14 we would use make_unique<ProstPlanner>
-    planner = std::unique_ptr<ProstPlanner>(new ProstPlanner(plannerDesc));
+    std::unique_ptr<ProstPlanner>& sessionPlanner = planners[plannerDesc];
+    if (!sessionPlanner) {
+        // The planner consumes the description it is created from
+        string desc = plannerDesc;
+        sessionPlanner =
+            std::unique_ptr<ProstPlanner>(new ProstPlanner(*task, desc));
+    }
+    planner = sessionPlanner.get();
     planner->initSession(numberOfRounds, remainingTime);
 }
 
 void IPCClient::finishSession() {
-    XMLNode const* sessionEndResponse = XMLNode::readNode(socket);
+    XMLNode const* sessionEndResponse = XMLNode::readNode(*xmlParser);
 
-    if (sessionEndResponse->getName() != "session-end") {
+    if (!sessionEndResponse ||
+        sessionEndResponse->getName() != "session-end") {
         SystemUtils::abort("Error: session end message insufficient.");
     }
 
@@ -177,15 +249,14 @@ void IPCClient::finishSession() {
     if (!sessionEndResponse->dissect("total-reward", s)) {
         SystemUtils::abort("Error: session end message insufficient.");
     }
-    double totalReward = atof(s.c_str());
+    totalReward = atof(s.c_str());
 
     delete sessionEndResponse;
 
     planner->finishSession(totalReward);
 }
 
-void IPCClient::initRound(vector<double>& initialState,
-                           double& immediateReward) {
+void IPCClient::initRound() {
     stringstream os;
     os.str("");
     os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
@@ -197,7 +268,7 @@ void IPCClient::initRound(vector<double>& initialState,
         SystemUtils::abort("Error: writing to socket failed.");
     }
 
-    XMLNode const* serverResponse = XMLNode::readNode(socket);
+    XMLNode const* serverResponse = XMLNode::readNode(*xmlParser);
 
     if (!serverResponse || serverResponse->getName() != "round-init") {
         SystemUtils::abort("Error: round-request response insufficient.");
@@ -211,17 +282,14 @@ void IPCClient::initRound(vector<double>& initialState,
 
     delete serverResponse;
 
-    serverResponse = XMLNode::readNode(socket);
-
-    readState(serverResponse, initialState, immediateReward);
+    readStartOfMessage();
+    readState();
     assert(MathUtils::doubleIsEqual(immediateReward, 0.0));
 
-    delete serverResponse;
-
     planner->initRound(remainingTime);
 }
 
-void IPCClient::finishRound(XMLNode const* node, double& immediateReward) {
+void IPCClient::finishRound(XMLNode const* node) {
     // TODO: Move immediate rewards
     string s;
     if (!node->dissect("immediate-reward", s)) {
@@ -243,9 +311,66 @@ void IPCClient::finishRound(XMLNode const* node, double& immediateReward) {
                          Submission of actions
 ******************************************************************************/
 
-bool IPCClient::submitAction(vector<string>& actions,
-                              vector<double>& nextState,
-                              double& immediateReward) {
+void IPCClient::runIOThread(ostream* output, bool abortThrows) {
+    Logger::setThreadOutput(output);
+    SystemUtils::setAbortThrows(abortThrows);
+    // The states that are received on this thread are hashed with the layout
+    // of the task
+    task->activate();
+
+    unique_lock<mutex> lock(ioMutex);
+    while (true) {
+        ioCondition.wait(
+            lock, [this] { return actionsSubmitted || ioThreadStopped; });
+        if (ioThreadStopped) {
+            return;
+        }
+        actionsSubmitted = false;
+
+        // The main thread doesn't access the connection or the response
+        // until the response is received
+        lock.unlock();
+        try {
+            submitAction(submittedActions);
+        } catch (AbortError const&) {
+            ioError = current_exception();
+        }
+        lock.lock();
+
+        responseReceived = true;
+        ioCondition.notify_all();
+    }
+}
+
+void IPCClient::startSubmission(vector<string> const& actions) {
+    {
+        lock_guard<mutex> lock(ioMutex);
+        assert(!actionsSubmitted && !responseReceived);
+        submittedActions = actions;
+        actionsSubmitted = true;
+    }
+    ioCondition.notify_all();
+}
+
+void IPCClient::waitForResponse() {
+    unique_lock<mutex> lock(ioMutex);
+    ioCondition.wait(lock, [this] { return responseReceived.load(); });
+    responseReceived = false;
+    if (ioError) {
+        rethrow_exception(ioError);
+    }
+}
+
+void IPCClient::stopIOThread() {
+    {
+        lock_guard<mutex> lock(ioMutex);
+        ioThreadStopped = true;
+    }
+    ioCondition.notify_all();
+    ioThread.join();
+}
+
+void IPCClient::submitAction(vector<string> const& actions) {
     stringstream os;
     os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
        << "<actions>";
@@ -271,177 +396,214 @@ bool IPCClient::submitAction(vector<string>& actions,
     }
     os << "</actions>" << '\0';
     if (write(socket, os.str().c_str(), os.str().length()) == -1) {
-        return false;
+        SystemUtils::abort("Error: writing to socket failed.");
     }
-    XMLNode const* serverResponse = XMLNode::readNode(socket);
+    readStartOfMessage();
 
-    bool roundContinues = true;
-    if (serverResponse->getName() == "round-end") {
-        finishRound(serverResponse, immediateReward);
-        roundContinues = false;
+    if (xmlParser->getName() == "round-end") {
+        roundEndMessage = XMLNode::readNode(*xmlParser);
+        if (!roundEndMessage) {
+            SystemUtils::abort("Error: round end message insufficient.");
+        }
     } else {
-        readState(serverResponse, nextState, immediateReward);
+        readState();
     }
-
-    delete serverResponse;
-    return roundContinues;
 }
 
 /******************************************************************************
                              Receiving of states
 ******************************************************************************/
 
-void IPCClient::readState(XMLNode const* node, vector<double>& nextState,
-                           double& immediateReward) {
-    assert(node);
-    assert(node->getName() == "turn");
+void IPCClient::readStartOfMessage() {
+    XMLPullParser::Event event = xmlParser->next();
+    while (event == XMLPullParser::TEXT) {
+        event = xmlParser->next();
+    }
+    if (event != XMLPullParser::START_TAG) {
+        SystemUtils::abort("Error: server communication failed.");
+    }
+}
 
-    if (node->size() == 2 &&
-        node->getChild(1)->getName() == "no-observed-fluents") {
-        assert(false);
+void IPCClient::readState() {
+    if (xmlParser->getName() != "turn") {
+        SystemUtils::abort("Error: turn response message insufficient.");
     }
 
-    map<string, string> newValues;
+    bool timeLeftRead = false;
+    bool immediateRewardRead = false;
+    while (xmlParser->next() != XMLPullParser::END_TAG) {
+        if (xmlParser->getEvent() == XMLPullParser::TEXT) {
+            continue;
+        } else if (xmlParser->getEvent() != XMLPullParser::START_TAG) {
+            SystemUtils::abort("Error: turn response message insufficient.");
+        }
 
-    string s;
-    if (!node->dissect("time-left", s)) {
-        SystemUtils::abort("Error: turn response message insufficient.");
+        string_view name = xmlParser->getName();
+        string_view text;
+        bool elementRead = true;
+        if (name == "time-left") {
+            elementRead = xmlParser->readElementText(text);
+            remainingTime = 0;
+            from_chars(text.data(), text.data() + text.size(), remainingTime);
+            timeLeftRead = true;
+        } else if (name == "immediate-reward") {
+            elementRead = xmlParser->readElementText(text);
+            immediateReward = 0.0;
+            from_chars(text.data(), text.data() + text.size(), immediateReward);
+            immediateRewardRead = true;
+        } else if (name == "observed-fluent") {
+            readObservedFluent();
+        } else {
+            assert(name != "no-observed-fluents");
+            elementRead = xmlParser->skipElement();
+        }
+
+        if (!elementRead) {
+            SystemUtils::abort("Error: turn response message insufficient.");
+        }
     }
-    remainingTime = atoi(s.c_str());
 
-    if (!node->dissect("immediate-reward", s)) {
+    if (!timeLeftRead || !immediateRewardRead) {
         SystemUtils::abort("Error: turn response message insufficient.");
     }
-    immediateReward = atof(s.c_str());
 
-    for (int i = 0; i < node->size(); i++) {
-        XMLNode const* child = node->getChild(i);
-        if (child->getName() == "observed-fluent") {
-            readVariable(child, newValues);
-        }
-    }
+    // The hash keys don't depend on the number of remaining steps, which is
+    // set by the planner
+    nextState = State(nextStateVec, -1);
+    State::calcStateFluentHashKeys(nextState);
+    State::calcStateHashKey(nextState);
+}
 
-    for (map<string, string>::iterator it = newValues.begin();
-         it != newValues.end(); ++it) {
-        string varName = it->first;
-        string value = it->second;
+void IPCClient::readObservedFluent() {
+    // The fluent name and the arguments come before the value, so the index of
+    // the state fluent is known when the value is read
+    int node = FluentNameTrie::ROOT;
+    while (xmlParser->next() != XMLPullParser::END_TAG) {
+        if (xmlParser->getEvent() == XMLPullParser::TEXT) {
+            continue;
+        } else if (xmlParser->getEvent() != XMLPullParser::START_TAG) {
+            SystemUtils::abort("Error: observed fluent insufficient.");
+        }
 
-        // If the variable has no parameters, its name is different from the one
-        // that is used by PROST internally where no parents are used (afaik,
-        // this changed at some point in rddlsim, and I am not sure if it will
-        // change back which is why this hacky solution is fine for the moment).
-        if (varName[varName.length() - 2] == '(') {
-            varName = varName.substr(0, varName.length() - 2);
+        string_view name = xmlParser->getName();
+        bool isPartOfName = (name == "fluent-name") || (name == "fluent-arg");
+        bool isValue = (name == "fluent-value");
+        string_view text;
+        if (!xmlParser->readElementText(text)) {
+            SystemUtils::abort("Error: observed fluent insufficient.");
         }
 
-        if (stateVariableIndices.find(varName) != stateVariableIndices.end()) {
-            if (stateVariableValues[stateVariableIndices[varName]].empty()) {
-                // TODO: This should be a numerical variable without
-                // value->index mapping, but it can also be a boolean one atm.
-                if (value == "true") {
-                    nextState[stateVariableIndices[varName]] = 1.0;
-                } else if (value == "false") {
-                    nextState[stateVariableIndices[varName]] = 0.0;
-                } else {
-                    nextState[stateVariableIndices[varName]] =
-                        atof(value.c_str());
-                }
-            } else {
-                for (unsigned int i = 0;
-                     i <
-                     stateVariableValues[stateVariableIndices[varName]].size();
-                     ++i) {
-                    if (stateVariableValues[stateVariableIndices[varName]][i] ==
-                        value) {
-                        nextState[stateVariableIndices[varName]] = i;
-                        break;
-                    }
-                }
+        if (isPartOfName && (node != -1)) {
+            node = fluentNames.getChild(node, text);
+        } else if (isValue && (node != -1)) {
+            // Fluents that are not part of the parsed task are ignored
+            int index = fluentNames.getIndex(node);
+            if (index != -1) {
+                setStateFluentValue(index, text);
             }
         }
     }
 }
 
-void IPCClient::readVariable(XMLNode const* node,
-                              map<string, string>& result) {
-    string name;
-    if (node->getName() != "observed-fluent") {
-        assert(false);
+void IPCClient::setStateFluentValue(int index, string_view value) {
+    vector<string> const& values = stateVariableValues[index];
+    if (values.empty()) {
+        // TODO: This should be a numerical variable without value->index
+        // mapping, but it can also be a boolean one atm.
+        if (value == "true") {
+            nextStateVec[index] = 1.0;
+        } else if (value == "false") {
+            nextStateVec[index] = 0.0;
+        } else {
+            double res = 0.0;
+            from_chars(value.data(), value.data() + value.size(), res);
+            nextStateVec[index] = res;
+        }
+    } else {
+        for (unsigned int i = 0; i < values.size(); ++i) {
+            if (values[i] == value) {
+                nextStateVec[index] = i;
+                break;
+            }
+        }
     }
+}
 
-    if (!node->dissect("fluent-name", name)) {
-        assert(false);
+/******************************************************************************
+                           Resolution of fluent names
+******************************************************************************/
+
+void FluentNameTrie::build(map<string, int> const& stateVariableIndices) {
+    // Split the names of the parsed task (e.g., "at(e0, f1)") into parts
+    vector<vector<string>> names;
+    size_t numberOfParts = 0;
+    for (auto const& nameAndIndex : stateVariableIndices) {
+        string const& name = nameAndIndex.first;
+        vector<string> parts;
+        size_t cutPos = name.find("(");
+        if (cutPos == string::npos) {
+            parts.push_back(name);
+        } else {
+            parts.push_back(name.substr(0, cutPos));
+            string allParams = name.substr(cutPos + 1);
+            assert(allParams[allParams.length() - 1] == ')');
+            allParams = allParams.substr(0, allParams.length() - 1);
+            StringUtils::split(allParams, parts, ",");
+            for (size_t i = 1; i < parts.size(); ++i) {
+                StringUtils::trim(parts[i]);
+            }
+        }
+        numberOfParts += parts.size();
+        names.push_back(parts);
     }
-    name = name.substr(0, name.length() - 1);
 
-    vector<string> params;
-    string value;
-    string fluentName;
+    size_t size = 1;
+    while (size < 2 * numberOfParts) {
+        size *= 2;
+    }
+    edges.assign(size, Edge());
+    indices.assign(1, -1);
 
-    for (int i = 0; i < node->size(); i++) {
-        XMLNode const* paramNode = node->getChild(i);
-        if (!paramNode) {
-            assert(false);
-            continue;
-        } else if (paramNode->getName() == "fluent-arg") {
-            string param = paramNode->getText();
-            params.push_back(param.substr(0, param.length() - 1));
-        } else if (paramNode->getName() == "fluent-value") {
-            value = paramNode->getText();
-            value = value.substr(0, value.length() - 1);
+    size_t nameIndex = 0;
+    for (auto const& nameAndIndex : stateVariableIndices) {
+        int node = ROOT;
+        for (string const& part : names[nameIndex]) {
+            int child = getChild(node, part);
+            node = (child == -1) ? addChild(node, part) : child;
         }
+        indices[node] = nameAndIndex.second;
+        ++nameIndex;
+    }
+}
+
+int FluentNameTrie::getChild(int node, string_view part) const {
+    if (edges.empty()) {
+        return -1;
     }
-    name += "(";
-    for (unsigned int i = 0; i < params.size(); ++i) {
-        name += params[i];
-        if (i != params.size() - 1) {
-            name += ", ";
+    for (size_t slot = getSlot(node, part); edges[slot].child != -1;
+         slot = (slot + 1) & (edges.size() - 1)) {
+        if ((edges[slot].parent == node) && (edges[slot].part == part)) {
+            return edges[slot].child;
         }
     }
-    name += ")";
-    assert(result.find(name) == result.end());
-    result[name] = value;
+    return -1;
 }
 
-/******************************************************************************
-                             Parser Interaction
-******************************************************************************/
+int FluentNameTrie::addChild(int node, string const& part) {
+    size_t slot = getSlot(node, part);
+    while (edges[slot].child != -1) {
+        slot = (slot + 1) & (edges.size() - 1);
+    }
+    int child = indices.size();
+    indices.push_back(-1);
+    edges[slot].parent = node;
+    edges[slot].part = part;
+    edges[slot].child = child;
+    return child;
+}
 
-void IPCClient::executeParser(string const& taskDesc) {
-#ifdef NDEBUG
-    std::string parserExec = "./rddl-parser-release ";
-#else
-    std::string parserExec = "./rddl-parser-debug ";
-#endif
-    Logger::logLine(
-        "Running RDDL parser at " + parserExec, Verbosity::VERBOSE);
-    // Generate temporary input file for parser
-    std::ofstream taskFile;
-    stringstream taskFileNameStream;
-    taskFileNameStream << "./parser_in_" << ::getpid() << ".rddl";
-    string taskFileName = taskFileNameStream.str();
-    taskFile.open(taskFileName.c_str());
-    taskFile << taskDesc << endl;
-    taskFile.close();
-
-    stringstream parserOutStream;
-    parserOutStream << "parser_out_" << ::getpid();
-    string parserOut = parserOutStream.str();
-
-    stringstream callString;
-    callString << parserExec << taskFileName << " ./"
-               << parserOut << " " << parserOptions;
-    int result = std::system(callString.str().c_str());
-    if (result != 0) {
-        SystemUtils::abort("Error: " + parserExec + " had an error");
-    }
-
-    Parser parser(parserOut);
-    parser.parseTask(stateVariableIndices, stateVariableValues);
-
-    // Remove temporary files
-    if ((remove(taskFileName.c_str()) != 0) ||
-        (remove(parserOut.c_str()) != 0)) {
-        SystemUtils::abort("Error: deleting temporary file failed");
-    }
+size_t FluentNameTrie::getSlot(int node, string_view part) const {
+    size_t hash = std::hash<string_view>()(part);
+    hash ^= static_cast<size_t>(node) * 0x9e3779b97f4a7c15ULL;
+    return hash & (edges.size() - 1);
 }
@@ -8,13 +8,61 @@
   substantially.
 */
 
+#include "states.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+class PlanningTask;
 class ProstPlanner;
 class XMLNode;
+class XMLPullParser;
+
+// Maps the names of state fluents as they are sent by the server (a fluent
+// name and a list of arguments) to the index of the state fluent. The trie is
+// built at session start from the names of the parsed task, and its edges are
+// labeled with the parts of a name (the fluent name and the arguments), so a
+// name is resolved part by part while it is read without building it.
+class FluentNameTrie {
+public:
+    static int const ROOT = 0;
+
+    void build(std::map<std::string, int> const& stateVariableIndices);
+
+    // Returns the node that is reached from node via the edge that is labeled
+    // with part, or -1 if there is no such edge
+    int getChild(int node, std::string_view part) const;
+
+    // Returns the index of the state fluent whose name leads from the root to
+    // node, or -1 if there is no such state fluent
+    int getIndex(int node) const {
+        return indices[node];
+    }
+
+private:
+    int addChild(int node, std::string const& part);
+    size_t getSlot(int node, std::string_view part) const;
+
+    struct Edge {
+        int parent = -1;
+        std::string part;
+        int child = -1;
+    };
+
+    // The edges are stored in a hash table with open addressing (the size is
+    // a power of two that is at least twice the number of edges)
+    std::vector<Edge> edges;
+    std::vector<int> indices;
+};
 
 class IPCClient {
 public:
@@ -22,45 +70,108 @@ public:
             std::string parserOptions);
     ~IPCClient();
 
-    void run(std::string const& instanceName, std::string& plannerDesc);
+    // Runs a session on the given instance. A client can run several sessions
+    // one after another: the task is only parsed again if its description or
+    // the parser options have changed, and the planner (with its search
+    // engine and everything it has learned) of an earlier session with the
+    // same planner description is reused.
+    void run(std::string const& instanceName, std::string const& plannerDesc);
+
+    // Sets the server and the parser options of the next session
+    void setServer(std::string _hostName, unsigned short _port) {
+        hostName = _hostName;
+        port = _port;
+    }
+    void setParserOptions(std::string _parserOptions) {
+        parserOptions = _parserOptions;
+    }
+
+    // The total reward of the session that is reported by the server
+    double getTotalReward() const {
+        return totalReward;
+    }
 
 private:
     void initConnection();
     int connectToServer();
     void closeConnection();
 
-    void initSession(std::string const& instanceName, std::string& plannerDesc);
+    void initSession(std::string const& instanceName,
+                     std::string const& plannerDesc);
     void finishSession();
 
-    void initRound(std::vector<double>& initialState, double& immediateReward);
-    void finishRound(XMLNode const* node, double& immediateReward);
-
-    bool submitAction(std::vector<std::string>& action,
-                      std::vector<double>& nextState, double& immediateReward);
-
-    void readState(XMLNode const* node, std::vector<double>& nextState,
-                   double& immediateReward);
-    void readVariable(XMLNode const* node,
-                      std::map<std::string, std::string>& result);
-
-    // If the client call did not contain a task file, we have to read the task
-    // description from the server and run the external parser to create a task
-    // in PROST format.
-    void executeParser(std::string const& taskDesc);
+    void initRound();
+    void finishRound(XMLNode const* node);
+
+    // Network I/O of the steps runs on its own thread: the main thread hands
+    // the actions over to the I/O thread, which submits them and reads,
+    // decodes and hashes the response of the server as soon as it arrives,
+    // while the main thread does the bookkeeping of the step. The I/O thread
+    // writes its output where the main thread does, and if an abort throws on
+    // the main thread (see SystemUtils::abort), an abort on the I/O thread is
+    // rethrown on the main thread when it waits for the response.
+    void runIOThread(std::ostream* output, bool abortThrows);
+    void startSubmission(std::vector<std::string> const& actions);
+    void waitForResponse();
+    void stopIOThread();
+
+    // Submits the actions and reads the response (this is called on the I/O
+    // thread)
+    void submitAction(std::vector<std::string> const& actions);
+
+    // Reads up to the start tag of the next message of the server
+    void readStartOfMessage();
+
+    // Reads the turn message whose start tag has just been read, writes the
+    // values of the observed fluents directly to nextStateVec and computes
+    // the hash keys of the resulting state
+    void readState();
+    void readObservedFluent();
+    void setStateFluentValue(int index, std::string_view value);
+
+    // The parsed task and the description and parser options it was parsed
+    // from
+    std::unique_ptr<PlanningTask> task;
+    std::string taskDesc;
+    std::string taskParserOptions;
+
+    // The planners of the sessions on task by planner description, and the
+    // planner of the current session
+    std::map<std::string, std::unique_ptr<ProstPlanner>> planners;
+    ProstPlanner* planner;
 
-    std::unique_ptr<ProstPlanner> planner;
     std::string hostName;
     unsigned short port;
     int socket;
+    std::unique_ptr<XMLPullParser> xmlParser;
 
     std::string parserOptions;
 
     int numberOfRounds;
+    double totalReward;
 
     long remainingTime;
 
     std::map<std::string, int> stateVariableIndices;
     std::vector<std::vector<std::string>> stateVariableValues;
+    FluentNameTrie fluentNames;
+
+    std::thread ioThread;
+    std::mutex ioMutex;
+    std::condition_variable ioCondition;
+    std::vector<std::string> submittedActions;
+    bool actionsSubmitted;
+    std::atomic<bool> responseReceived;
+    bool ioThreadStopped;
+    std::exception_ptr ioError;
+
+    // The last response of the server: either the next state and the
+    // immediate reward, or the message that ends the round (which is nullptr
+    // otherwise)
+    std::vector<double> nextStateVec;
+    State nextState;
+    double immediateReward;
+    XMLNode const* roundEndMessage;
 };
 
 #endif // IPC_CLIENT_H
@@ -2,6 +2,7 @@
 
 #include "depth_first_search.h"
 #include "minimal_lookahead_search.h"
+#include "persistent_cache.h"
 #include "prost_planner.h"
 
 #include "utils/logger.h"
@@ -14,10 +15,8 @@
 
 using namespace std;
 
-IDS::HashMap IDS::rewardCache;
-
-IDS::IDS()
-    : DeterministicSearchEngine("IDS"),
+IDS::IDS(PlanningTask& _task)
+    : DeterministicSearchEngine("IDS", _task),
       mlh(nullptr),
       isLearning(true),
       stopwatch(),
@@ -33,13 +32,11 @@ IDS::IDS()
       numberOfRunsInCurrentRound(0) {
     setTimeout(0.005);
 
-    if (rewardCache.bucket_count() < 520241) {
-        rewardCache.reserve(520241);
-    }
+    rewardCache.reserve(520241);
 
     elapsedTime.resize(maxSearchDepth + 1);
 
-    dfs = new DepthFirstSearch();
+    dfs = new DepthFirstSearch(task);
     dfs->setMaxSearchDepth(maxSearchDepth);
 }
 
@@ -81,6 +78,23 @@ void IDS::disableCaching() {
     }
 }
 
+void IDS::loadCaches(PersistentCache const& cache) {
+    // The reward cache is not used if IDS is replaced by mlh
+    if (mlh || !cachingEnabled) {
+        return;
+    }
+    for (PersistentCache::Entry const& entry :
+         cache.getEntries(name + " reward cache")) {
+        rewardCache[entry.state] = entry.values;
+    }
+}
+
+void IDS::storeCaches(PersistentCache& cache) const {
+    for (auto const& [state, rewards] : rewardCache) {
+        cache.addEntry(name + " reward cache", state, rewards);
+    }
+}
+
 void IDS::initSession() {
     dfs->initSession();
 
@@ -91,8 +105,8 @@ void IDS::initSession() {
 
         // Perform IDS for all states in trainingSet and record the time it
         // takes
-        for (State const& state : trainingSet) {
-            vector<double> res(numberOfActions);
+        for (State const& state : task.trainingSet) {
+            vector<double> res(task.numberOfActions);
             vector<int> actionsToExpand = getApplicableActions(state);
             estimateQValues(state, actionsToExpand, res);
         }
@@ -108,7 +122,7 @@ void IDS::initSession() {
 
             for (size_t index = 2; index < elapsedTime.size(); ++index) {
                 vector<double> const& times = elapsedTime[index];
-                if (times.size() <= (trainingSet.size() / 2)) {
+                if (times.size() <= (task.trainingSet.size() / 2)) {
                     break;
                 }
                 double timeSum =
@@ -194,7 +208,7 @@ void IDS::finishStep() {
 
 void IDS::createMinimalLookaheadSearch() {
     assert(!mlh);
-    mlh = new MinimalLookaheadSearch();
+    mlh = new MinimalLookaheadSearch(task);
     mlh->prependName("Replacement of " + name + " ");
     mlh->setCachingEnabled(cachingEnabled);
     rewardCache.clear();
@@ -235,7 +249,7 @@ void IDS::estimateQValue(State const& state, int actionIndex, double& qValue) {
         if (cachingEnabled) {
             if (it == rewardCache.end()) {
                 rewardCache[currentState] =
-                    vector<double>(SearchEngine::numberOfActions,
+                    vector<double>(task.numberOfActions,
                                    -std::numeric_limits<double>::max());
             }
             rewardCache[currentState][actionIndex] = qValue;
@@ -382,7 +396,7 @@ bool IDS::moreIterations(int const& stepsToGo,
 
     // 2. Check if the result is already significant (if noop is applicable, we
     // check if there is an action that yields a higher reward than noop)
-    if (terminateWithReasonableAction && actionStates[0].isNoop &&
+    if (terminateWithReasonableAction && task.actionStates[0].isNoop &&
         (actionsToExpand[0] == 0)) {
         for (size_t index = 1; index < qValues.size(); ++index) {
             if ((actionsToExpand[index] == index) &&
@@ -444,8 +458,8 @@ void IDS::printStepStatistics(std::string indent) const {
 }
 
 void IDS::printRewardCacheUsage(std::string indent, Verbosity verbosity) const {
-    long entriesIDSRewardCache = IDS::rewardCache.size();
-    long bucketsIDSRewardCache = IDS::rewardCache.bucket_count();
+    long entriesIDSRewardCache = rewardCache.size();
+    long bucketsIDSRewardCache = rewardCache.bucket_count();
     Logger::logLine(indent + "Entries in IDS reward cache: " +
                         to_string(entriesIDSRewardCache),
                     verbosity);
@@ -17,7 +17,7 @@ class MinimalLookaheadSearch;
 
 class IDS : public DeterministicSearchEngine {
 public:
-    IDS();
+    IDS(PlanningTask& _task);
 
     // Set parameters from command line
     bool setValueFromString(std::string& param, std::string& value) override;
@@ -25,6 +25,10 @@ public:
     // This is called when caching is disabled because memory becomes sparse.
     void disableCaching() override;
 
+    // Restores or stores the entries of the reward cache
+    void loadCaches(PersistentCache const& cache) override;
+    void storeCaches(PersistentCache& cache) const override;
+
     // Notify the search engine that the session starts
     void initSession() override;
 
@@ -75,7 +79,7 @@ public:
     using HashMap = std::unordered_map<State, std::vector<double>,
                                        State::HashWithoutRemSteps,
                                        State::EqualWithoutRemSteps>;
-    static HashMap rewardCache;
+    HashMap rewardCache;
 
 protected:
     // Decides whether more iterations are possible and reasonable
@@ -0,0 +1,145 @@
+#include "local_simulator.h"
+
+#include "parser.h"
+#include "planning_task.h"
+#include "prost_planner.h"
+#include "simulator.h"
+
+#include "utils/logger.h"
+#include "utils/math_utils.h"
+#include "utils/stopwatch.h"
+#include "utils/system_utils.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+LocalSimulator::LocalSimulator(vector<string> _rddlFiles, int _numberOfRounds,
+                               int _seed, long _totalTime,
+                               string _parserOptions)
+    : rddlFiles(_rddlFiles),
+      numberOfRounds(_numberOfRounds),
+      seed(_seed),
+      totalTime(_totalTime),
+      parserOptions(_parserOptions),
+      totalReward(0.0),
+      numberOfDecisions(0),
+      numberOfTrials(0),
+      planningTime(0.0) {}
+
+// This destructor is required here to allow forward declaration of
+// PlanningTask, ProstPlanner and Simulator in header because of usage of
+// unique_ptr
+LocalSimulator::~LocalSimulator() = default;
+
+void LocalSimulator::run(string& plannerDesc) {
+    // Reset the random number generator from possible earlier runs
+    MathUtils::resetRNG();
+
+    initSession(plannerDesc);
+
+    for (int currentRound = 0; currentRound < numberOfRounds; ++currentRound) {
+        planner->initRound(getRemainingTime());
+        simulator->initRound();
+        double roundReward = 0.0;
+
+        for (int step = 0; step < task->horizon; ++step) {
+            planner->initStep(simulator->getCurrentState(),
+                              getRemainingTime());
+
+            Stopwatch stopwatch;
+            planner->plan();
+            planningTime += stopwatch();
+            ++numberOfDecisions;
+            numberOfTrials += planner->getSearchEngine()->getNumberOfTrials();
+
+            double immediateReward =
+                simulator->applyAction(planner->getExecutedActionIndex());
+            roundReward += immediateReward;
+            planner->printStepStatistics();
+            planner->finishStep(immediateReward);
+        }
+        totalReward += roundReward;
+        planner->finishRound(roundReward);
+    }
+
+    finishSession();
+}
+
+/******************************************************************************
+                     Session and rounds management
+******************************************************************************/
+
+void LocalSimulator::initSession(string& plannerDesc) {
+    // The simulator works directly on the internal representation of states,
+    // so the mapping of variable names and values is not needed
+    map<string, int> stateVariableIndices;
+    vector<vector<string>> stateVariableValues;
+    task = std::unique_ptr<PlanningTask>(new PlanningTask());
+    Parser::parseRDDLTask(*task, Simulator::readRDDLFiles(rddlFiles),
+                          parserOptions, stateVariableIndices,
+                          stateVariableValues);
+    simulator = std::unique_ptr<Simulator>(new Simulator(*task, seed));
+
+    // in c++ 14 we would use make_unique<ProstPlanner>
+    planner = std::unique_ptr<ProstPlanner>(
+        new ProstPlanner(*task, plannerDesc));
+    planner->initSession(numberOfRounds, getRemainingTime());
+}
+
+void LocalSimulator::finishSession() {
+    planner->finishSession(totalReward);
+
+    double avgReward = totalReward / numberOfRounds;
+    double decisionsPerSecond = 0.0;
+    if (MathUtils::doubleIsGreater(planningTime, 0.0)) {
+        decisionsPerSecond = numberOfDecisions / planningTime;
+    }
+    double trialsPerDecision = 0.0;
+    if (numberOfDecisions > 0) {
+        trialsPerDecision =
+            static_cast<double>(numberOfTrials) / numberOfDecisions;
+    }
+    int peakRAM = SystemUtils::getPeakRAMUsedByThis();
+
+    Logger::logSeparator(Verbosity::NORMAL);
+    Logger::logLine("Benchmark results of local simulation:",
+                    Verbosity::SILENT);
+    Logger::logLine("  Task: " + task->taskName, Verbosity::SILENT);
+    Logger::logLine("  Rounds: " + to_string(numberOfRounds) +
+                    " (simulator seed " + to_string(seed) + ")",
+                    Verbosity::SILENT);
+    Logger::logLine("  Decisions: " + to_string(numberOfDecisions) + " in " +
+                    to_string(planningTime) + "s", Verbosity::SILENT);
+    Logger::logLine("  Decisions per second: " +
+                    to_string(decisionsPerSecond), Verbosity::SILENT);
+    Logger::logLine("  Trials per decision: " + to_string(trialsPerDecision),
+                    Verbosity::SILENT);
+    Logger::logLine("  Average reward: " + to_string(avgReward),
+                    Verbosity::SILENT);
+    Logger::logLine("  Peak RAM usage: " + to_string(peakRAM) + " KB",
+                    Verbosity::SILENT);
+
+    stringstream json;
+    json << "BENCHMARK {\"task\": \"" << task->taskName << "\", "
+         << "\"rounds\": " << numberOfRounds << ", "
+         << "\"seed\": " << seed << ", "
+         << "\"decisions\": " << numberOfDecisions << ", "
+         << "\"planning_time\": " << planningTime << ", "
+         << "\"decisions_per_second\": " << decisionsPerSecond << ", "
+         << "\"trials_per_decision\": " << trialsPerDecision << ", "
+         << "\"average_reward\": " << avgReward << ", "
+         << "\"peak_ram\": " << peakRAM << "}";
+    Logger::logLine(json.str(), Verbosity::SILENT);
+}
+
+long LocalSimulator::getRemainingTime() const {
+    if (totalTime == 0) {
+        return numeric_limits<int>::max();
+    }
+    long remainingTime = totalTime - static_cast<long>(planningTime * 1000.0);
+    return max(remainingTime, 0L);
+}
@@ -0,0 +1,56 @@
+#ifndef LOCAL_SIMULATOR_H
+#define LOCAL_SIMULATOR_H
+
+/*
+  The local simulator runs the planner on an RDDL task without an rddlsim
+  server. The task is parsed with the external parser like in the IPC client,
+  and the environment is simulated with the CPFs and the reward function of the
+  parsed task (see simulator.h). The sequence of states is reproducible for a
+  fixed simulator seed if the planner behaves deterministically.
+
+  After the last round, the simulator prints statistics that can be used to
+  benchmark the planner (decisions per second, trials per decision, average
+  reward and peak RAM usage), both in a human readable format and as a single
+  line in JSON format that starts with "BENCHMARK".
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class PlanningTask;
+class ProstPlanner;
+class Simulator;
+
+class LocalSimulator {
+public:
+    LocalSimulator(std::vector<std::string> _rddlFiles, int _numberOfRounds,
+                   int _seed, long _totalTime, std::string _parserOptions);
+    ~LocalSimulator();
+
+    void run(std::string& plannerDesc);
+
+private:
+    void initSession(std::string& plannerDesc);
+    void finishSession();
+
+    long getRemainingTime() const;
+
+    std::unique_ptr<PlanningTask> task;
+    std::unique_ptr<ProstPlanner> planner;
+    std::unique_ptr<Simulator> simulator;
+    std::vector<std::string> rddlFiles;
+    int numberOfRounds;
+    int seed;
+    // The total time in ms for all rounds (no time limit if this is 0)
+    long totalTime;
+    std::string parserOptions;
+
+    // Statistics
+    double totalReward;
+    int numberOfDecisions;
+    long numberOfTrials;
+    double planningTime;
+};
+
+#endif // LOCAL_SIMULATOR_H
@@ -1,6 +1,6 @@
 #include "logical_expressions.h"
 
-#include "search_engine.h"
+#include "planning_task.h"
 #include "utils/math_utils.h"
 #include "utils/string_utils.h"
 #include "utils/system_utils.h"
@@ -15,13 +15,17 @@ LogicalExpression* LogicalExpression::createFromString(string& desc) {
     if (StringUtils::startsWith(desc, "$s(")) {
         desc = desc.substr(3, desc.length() - 4);
         int index = atoi(desc.c_str());
-        assert((index >= 0) && (index < SearchEngine::stateFluents.size()));
-        return SearchEngine::stateFluents[index];
+        vector<StateFluent*> const& stateFluents =
+            PlanningTask::active().stateFluents;
+        assert((index >= 0) && (index < stateFluents.size()));
+        return stateFluents[index];
     } else if (StringUtils::startsWith(desc, "$a(")) {
         desc = desc.substr(3, desc.length() - 4);
         int index = atoi(desc.c_str());
-        assert((index >= 0) && (index < SearchEngine::actionFluents.size()));
-        return SearchEngine::actionFluents[index];
+        vector<ActionFluent*> const& actionFluents =
+            PlanningTask::active().actionFluents;
+        assert((index >= 0) && (index < actionFluents.size()));
+        return actionFluents[index];
     } else if (StringUtils::startsWith(desc, "$c(")) {
         desc = desc.substr(3, desc.length() - 4);
         double value = atof(desc.c_str());
@@ -153,6 +157,21 @@ LogicalExpressionPair LogicalExpression::splitExpressionPair(string& desc) {
     return make_pair(first, second);
 }
 
+void LogicalExpression::deleteSubexpression(LogicalExpression* expr) {
+    if (!dynamic_cast<StateFluent*>(expr) &&
+        !dynamic_cast<ActionFluent*>(expr)) {
+        delete expr;
+    }
+}
+
+void LogicalExpression::deleteSubexpressions(
+    vector<LogicalExpression*>& exprs) {
+    for (LogicalExpression* expr : exprs) {
+        deleteSubexpression(expr);
+    }
+    exprs.clear();
+}
+
 #include "logical_expressions_includes/evaluate.cc"
 #include "logical_expressions_includes/evaluate_to_kleene.cc"
 #include "logical_expressions_includes/evaluate_to_pd.cc"
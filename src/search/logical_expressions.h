@@ -20,6 +20,11 @@ public:
 
     virtual ~LogicalExpression() {}
 
+    // Deletes a subexpression of a formula. Fluents are shared by all formulas
+    // and owned by the PlanningTask, so they are not deleted.
+    static void deleteSubexpression(LogicalExpression* expr);
+    static void deleteSubexpressions(std::vector<LogicalExpression*>& exprs);
+
     virtual void evaluate(double& res, State const& current,
                           ActionState const& actions) const;
     virtual void evaluateToPD(DiscretePD& res, State const& current,
@@ -120,6 +125,9 @@ public:
 class Conjunction : public LogicalExpression {
 public:
     Conjunction(std::vector<LogicalExpression*>& _exprs) : exprs(_exprs) {}
+    ~Conjunction() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -136,6 +144,9 @@ public:
 class Disjunction : public LogicalExpression {
 public:
     Disjunction(std::vector<LogicalExpression*>& _exprs) : exprs(_exprs) {}
+    ~Disjunction() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -152,6 +163,9 @@ public:
 class EqualsExpression : public LogicalExpression {
 public:
     EqualsExpression(std::vector<LogicalExpression*>& _exprs) : exprs(_exprs) {}
+    ~EqualsExpression() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -169,6 +183,9 @@ class GreaterExpression : public LogicalExpression {
 public:
     GreaterExpression(std::vector<LogicalExpression*>& _exprs)
         : exprs(_exprs) {}
+    ~GreaterExpression() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -185,6 +202,9 @@ public:
 class LowerExpression : public LogicalExpression {
 public:
     LowerExpression(std::vector<LogicalExpression*>& _exprs) : exprs(_exprs) {}
+    ~LowerExpression() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -202,6 +222,9 @@ class GreaterEqualsExpression : public LogicalExpression {
 public:
     GreaterEqualsExpression(std::vector<LogicalExpression*>& _exprs)
         : exprs(_exprs) {}
+    ~GreaterEqualsExpression() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -219,6 +242,9 @@ class LowerEqualsExpression : public LogicalExpression {
 public:
     LowerEqualsExpression(std::vector<LogicalExpression*>& _exprs)
         : exprs(_exprs) {}
+    ~LowerEqualsExpression() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -235,6 +261,9 @@ public:
 class Addition : public LogicalExpression {
 public:
     Addition(std::vector<LogicalExpression*>& _exprs) : exprs(_exprs) {}
+    ~Addition() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -251,6 +280,9 @@ public:
 class Subtraction : public LogicalExpression {
 public:
     Subtraction(std::vector<LogicalExpression*>& _exprs) : exprs(_exprs) {}
+    ~Subtraction() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -267,6 +299,9 @@ public:
 class Multiplication : public LogicalExpression {
 public:
     Multiplication(std::vector<LogicalExpression*>& _exprs) : exprs(_exprs) {}
+    ~Multiplication() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -283,6 +318,9 @@ public:
 class Division : public LogicalExpression {
 public:
     Division(std::vector<LogicalExpression*>& _exprs) : exprs(_exprs) {}
+    ~Division() override {
+        deleteSubexpressions(exprs);
+    }
 
     std::vector<LogicalExpression*> exprs;
 
@@ -303,6 +341,9 @@ public:
 class Negation : public LogicalExpression {
 public:
     Negation(LogicalExpression*& _expr) : expr(_expr) {}
+    ~Negation() override {
+        deleteSubexpression(expr);
+    }
 
     LogicalExpression* expr;
 
@@ -319,6 +360,9 @@ public:
 class ExponentialFunction : public LogicalExpression {
 public:
     ExponentialFunction(LogicalExpression*& _expr) : expr(_expr) {}
+    ~ExponentialFunction() override {
+        deleteSubexpression(expr);
+    }
 
     LogicalExpression* expr;
 
@@ -339,6 +383,9 @@ public:
 class BernoulliDistribution : public LogicalExpression {
 public:
     BernoulliDistribution(LogicalExpression*& _expr) : expr(_expr) {}
+    ~BernoulliDistribution() override {
+        deleteSubexpression(expr);
+    }
 
     LogicalExpression* expr;
 
@@ -357,6 +404,10 @@ public:
     DiscreteDistribution(std::vector<LogicalExpression*>& _values,
                          std::vector<LogicalExpression*> _probabilities)
         : values(_values), probabilities(_probabilities) {}
+    ~DiscreteDistribution() override {
+        deleteSubexpressions(values);
+        deleteSubexpressions(probabilities);
+    }
 
     std::vector<LogicalExpression*> values;
     std::vector<LogicalExpression*> probabilities;
@@ -380,6 +431,10 @@ public:
     MultiConditionChecker(std::vector<LogicalExpression*> _conditions,
                           std::vector<LogicalExpression*> _effects)
         : conditions(_conditions), effects(_effects) {}
+    ~MultiConditionChecker() override {
+        deleteSubexpressions(conditions);
+        deleteSubexpressions(effects);
+    }
 
     std::vector<LogicalExpression*> conditions;
     std::vector<LogicalExpression*> effects;
@@ -12,16 +12,14 @@ void DeterministicStateFluent::evaluateToKleene(
     set<double>& res, KleeneState const& current,
     ActionState const& /*actions*/) const {
     assert(res.empty());
-    res.insert(current[index].begin(), current[index].end());
+    current.getValues(index, res);
 }
 
 void ProbabilisticStateFluent::evaluateToKleene(
     set<double>& res, KleeneState const& current,
     ActionState const& /*actions*/) const {
     assert(res.empty());
-    res.insert(
-        current[State::numberOfDeterministicStateFluents + index].begin(),
-        current[State::numberOfDeterministicStateFluents + index].end());
+    current.getValues(State::numberOfDeterministicStateFluents() + index, res);
 }
 
 void ActionFluent::evaluateToKleene(set<double>& res,
@@ -1,4 +1,7 @@
 #include "ipc_client.h"
+#include "local_simulator.h"
+#include "planner_daemon.h"
+#include "simulator_server.h"
 
 #define DOCTEST_CONFIG_IMPLEMENT
 #define DOCTEST_CONFIG_NO_UNPREFIXED_OPTIONS
@@ -10,6 +13,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -18,6 +22,92 @@ void printUsage() {
             "[PROST <options>]"
          << endl;
 
+    cout << "   or: ./prost <benchmark-directory> --server [<options>]" << endl;
+    cout << "   or: ./prost <daemon-directory> --daemon [<options>] "
+            "[PROST <options>]"
+         << endl
+         << endl;
+
+    cout << "By default, PROST connects to an rddlsim server that runs the "
+            "given problem. With --simulate, the first argument is instead the "
+            "path to an RDDL file that contains the instance (and possibly the "
+            "domain), and PROST runs the task in a local simulation that "
+            "requires no server. With --server, PROST does not plan but "
+            "replaces the rddlsim server: it serves the instances in the given "
+            "directory on the given port (use it with the IPC client of PROST, "
+            "as the observed fluents are those of the parsed task). With "
+            "--daemon, PROST runs as a long-lived process that accepts plan "
+            "requests on the given port and runs each requested session with "
+            "an rddlsim server in a pool of worker threads (see "
+            "planner_daemon.h for the format of plan requests); the given "
+            "directory is used for the session logs and the cache of the RDDL "
+            "parser, and the planner options are the default for requests "
+            "without planner description."
+         << endl
+         << endl;
+
+    cout << "  -h, --hostname <string>" << endl;
+    cout << "    The host name of the rddlsim server." << endl;
+    cout << "    Default: localhost" << endl << endl;
+
+    cout << "  -p, --port <int>" << endl;
+    cout << "    The port of the rddlsim server (or the port where the server "
+            "or daemon listens with --server or --daemon)."
+         << endl;
+    cout << "    Default: 2323" << endl << endl;
+
+    cout << "  --parser-options <string>" << endl;
+    cout << "    Options that are passed to the RDDL parser." << endl;
+    cout << "    Default: \"\"" << endl << endl;
+
+    cout << "  --simulate" << endl;
+    cout << "    Run the task in a local simulation and print benchmark "
+            "statistics at the end of the session."
+         << endl << endl;
+
+    cout << "  --domain <path>" << endl;
+    cout << "    The RDDL file with the domain if the instance file doesn't "
+            "contain it (only with --simulate)."
+         << endl << endl;
+
+    cout << "  --server" << endl;
+    cout << "    Run a simulator server that speaks the rddlsim protocol."
+         << endl << endl;
+
+    cout << "  -r, --rounds <int>" << endl;
+    cout << "    The number of simulated rounds (only with --simulate or "
+            "--server)."
+         << endl;
+    cout << "    Default: 30" << endl << endl;
+
+    cout << "  --simulator-seed <int>" << endl;
+    cout << "    The seed of the simulation (only with --simulate or "
+            "--server)."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
+    cout << "  --time <int>" << endl;
+    cout << "    The total time in seconds that is reported to the planner, "
+            "or 0 for no time limit (only with --simulate or --server)."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
+    cout << "  --daemon" << endl;
+    cout << "    Run a planner daemon that serves plan requests." << endl
+         << endl;
+
+    cout << "  --workers <int>" << endl;
+    cout << "    The number of sessions that the daemon runs in parallel, or 0 "
+            "for the number of cores (only with --daemon)."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
+    cout << "  --sessions <int>" << endl;
+    cout << "    The number of sessions after which the server or daemon "
+            "terminates, or 0 for no limit (only with --server or --daemon)."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
     cout << "**************************************************************"
          << endl
          << "                     PROST Planner Options" << endl
@@ -39,6 +129,37 @@ void printUsage() {
          << endl;
     cout << "    Default: sizeof(long)*8" << endl << endl;
 
+    cout << "  -tm <NONE | UNI | [ADA <options>]>" << endl;
+    cout << "    Specifies how the remaining time is distributed among the "
+            "decisions: not at all (NONE, the timeout of the search engine is "
+            "used), uniformly among the remaining steps (UNI) or adaptively "
+            "(ADA). ADA distributes the time proportionally to the time that "
+            "was used in the same step of the previous round, keeps time that "
+            "is not used in a bank and uses the bank to extend the search if "
+            "the values of the two best actions are close (THTS only). It has "
+            "the following options:"
+         << endl;
+    cout << "      -ext <double>: the maximal factor by which the time of a "
+            "decision is extended (Default: 2.0)"
+         << endl;
+    cout << "      -gap <double>: the maximal difference of the two best "
+            "action values, relative to the best, of a close decision "
+            "(Default: 0.05)"
+         << endl;
+    cout << "      -minw <double>: the minimal weight of a step, relative to "
+            "the average time of a step (Default: 0.1)"
+         << endl;
+    cout << "    Default: NONE" << endl << endl;
+
+    cout << "  -pc <file>" << endl;
+    cout << "    Specifies a file where the values of solved states, the "
+            "results of reward lock detection, the BDDs of dead ends and goals "
+            "and the reward cache of IDS are stored at the end of the session. "
+            "If the file exists and belongs to the same task, these are "
+            "restored from it at the start of the session."
+         << endl;
+    cout << "    Default: None" << endl << endl;
+
     cout << "  -se <SearchEngine>" << endl;
     cout << "    Specifies the used main search engine." << endl;
     cout << "    MANDATORY." << endl << endl << endl;
@@ -206,8 +327,10 @@ void printUsage() {
 
     cout << "  -crl <0|1>" << endl;
     cout << "    Specifies if reward lock caching with BDDs as described in "
-            "our ICAPS 2013 paper is used. If reward lock detection is not "
-            "used, this parameter has no influence on the planner."
+            "our ICAPS 2013 paper is used. The results of checks on "
+            "concrete states are additionally cached in a hash map. If "
+            "reward lock detection is not used, this parameter has no "
+            "influence on the planner."
          << endl;
     cout << "    Default: 1" << endl << endl;
 
@@ -221,11 +344,16 @@ void printUsage() {
     cout << "    Specifies the considered horizon." << endl;
     cout << "    Default: Horizon of the task" << endl << endl;
 
-    cout << "  -T <TIME | TRIALS | TIME_AND_TRIALS>" << endl;
+    cout << "  -T <TIME | TRIALS | TIME_AND_TRIALS | TIME_AND_CONV>" << endl;
     cout << "    Specifies the termination criterion of trials, which can be "
             "based on a timeout (TIME), the number of trials (TRIALS) or on "
             "both, whichever comes first (TIME_AND_TRIALS). If one of the "
-            "latter two is used, you MUST set the maximum number of trials."
+            "latter two is used, you MUST set the maximum number of trials. "
+            "TIME_AND_CONV stops after the timeout or as soon as the "
+            "recommendation in the root is settled, i.e., if the confidence "
+            "bounds on the value of the best action are separated from those "
+            "of all other actions, or if the trials that can be performed in "
+            "the remaining time cannot change the recommendation."
          << endl;
     cout << "    Default:TIME" << endl << endl;
 
@@ -241,6 +369,12 @@ void printUsage() {
          << endl;
     cout << "    Default: 0" << endl << endl;
 
+    cout << "  -cerr <double>" << endl;
+    cout << "    Specifies the probability that the confidence bounds are "
+            "violated (if TIME_AND_CONV is the termination criterion)."
+         << endl;
+    cout << "    Default: 0.05" << endl << endl;
+
     cout << "  -ndn <int|H>" << endl;
     cout << "    This is the parameter that describes the trial length "
             "ingredient. It specifies the number of previously unvisited "
@@ -249,6 +383,25 @@ void printUsage() {
          << endl;
     cout << "    Default: 1" << endl << endl;
 
+    cout << "  -spec <0|1>" << endl;
+    cout << "    Specifies if THTS searches speculatively while the server "
+            "computes the outcome of the submitted action (i.e., performs "
+            "trials under the submitted action), and reuses the subtree of "
+            "the observed outcome as search tree in the next step. This has "
+            "only an effect in communication with an rddlsim server."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
+    cout << "  -tt <0|1>" << endl;
+    cout << "    Specifies if THTS detects transpositions, i.e., decision "
+            "nodes of the same state with the same number of remaining steps "
+            "that are reached on different paths. If enabled, such decision "
+            "nodes share the chance nodes of their actions (and therefore "
+            "their values and visits), which turns the search tree into a "
+            "directed acyclic graph."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
     cout << "  -mv <0|1>" << endl;
     cout << "    This is the parameter that describes the recommendation "
             "function: if this is set to 0, the action with the highest "
@@ -322,16 +475,27 @@ void printUsage() {
          << endl;
 
     cout << "Monte-Carlo outcome selection samples each outcome according to "
-            "its probability. It is created by [MC] and has no options."
-         << endl
+            "its probability. It is created by [MC <options>] with the "
+            "following options:"
+         << endl;
+
+    cout << "  -joint <0|1>" << endl;
+    cout << "    If enabled, the outcomes of all probabilistic state fluents "
+            "are sampled in a single pass, and the successor state is "
+            "represented by a single decision node below the chance node of "
+            "the applied action (instead of one layer of chance nodes per "
+            "probabilistic state fluent). Transitions with more joint outcomes "
+            "than can be indexed by an int are sampled per state fluent."
          << endl;
+    cout << "    Default: 0" << endl << endl;
 
     cout << "*************************** UMC **************************"
          << endl;
 
     cout << "Monte-Carlo outcome selection that only considers actions that "
-            "are not labeled as solved. It is created by [UMC] and has no "
-            "options."
+            "are not labeled as solved. It is created by [UMC <options>] and "
+            "supports the options of [MC]. If outcomes are sampled jointly, "
+            "sampled successor states that are labeled as solved are rejected."
          << endl
          << endl;
 
@@ -422,6 +586,16 @@ void printUsage() {
          << endl;
     cout << "    Default: 0.5" << endl << endl;
 
+    cout << "  -hvc <int>" << endl;
+    cout << "    Specifies the memory (in MB) that is used to cache the "
+            "heuristic estimates of states across steps and rounds, such that "
+            "the heuristic is computed only once for states that are "
+            "encountered repeatedly. The cache is shared by all initializers "
+            "with the same heuristic and search depth, and caching is "
+            "disabled if this is 0."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
     cout << "*********************** Single Child **********************"
          << endl;
 
@@ -451,6 +625,29 @@ void printUsage() {
          << endl;
     cout << "    Default: 0.5" << endl << endl;
 
+    cout << "******************* Batched Expand Node *******************"
+         << endl;
+
+    cout << "The Batched Expand Node initializer expands the current decision "
+            "node like the Expand Node initializer, but the children are "
+            "initialized with the provisional value stepsToGo * R(s,a) and the "
+            "heuristic is computed later for a batch of nodes. Trials continue "
+            "with the provisional values until the batch is full, then the "
+            "heuristic values of all states in the batch are computed between "
+            "two trials (once per state, even if several nodes represent it) "
+            "and replace the provisional values of all children that have not "
+            "been visited since (the values of the nodes are recomputed from "
+            "their children). Nodes that are still pending at the end of "
+            "the step are never evaluated. It is created by [Batch <options>] "
+            "with the options of the Expand Node initializer and the following "
+            "options:"
+         << endl;
+
+    cout << "  -bs <int>" << endl;
+    cout << "    Specifies the number of nodes that are evaluated in a batch."
+         << endl;
+    cout << "    Default: 32" << endl << endl;
+
     cout << "******************************************************************"
             "**"
          << endl
@@ -569,6 +766,15 @@ int main(int argc, char** argv) {
     string hostName = "localhost";
     unsigned short port = 2323;
     string parserOptions = "";
+    bool simulate = false;
+    string domainFileName = "";
+    int numberOfRounds = 30;
+    int simulatorSeed = 0;
+    long simulationTime = 0;
+    bool runServer = false;
+    bool runDaemon = false;
+    int numberOfWorkers = 0;
+    int numberOfSessions = 0;
 
     bool allParamsRead = false;
     string plannerDesc;
@@ -586,6 +792,24 @@ int main(int argc, char** argv) {
                 port = (unsigned short)(atoi(string(argv[++i]).c_str()));
             } else if (nextOption == "--parser-options") {
                 parserOptions = string(argv[++i]);
+            } else if (nextOption == "--simulate") {
+                simulate = true;
+            } else if (nextOption == "--domain") {
+                domainFileName = string(argv[++i]);
+            } else if (nextOption == "-r" || nextOption == "--rounds") {
+                numberOfRounds = atoi(string(argv[++i]).c_str());
+            } else if (nextOption == "--simulator-seed") {
+                simulatorSeed = atoi(string(argv[++i]).c_str());
+            } else if (nextOption == "--time") {
+                simulationTime = 1000 * atol(string(argv[++i]).c_str());
+            } else if (nextOption == "--server") {
+                runServer = true;
+            } else if (nextOption == "--daemon") {
+                runDaemon = true;
+            } else if (nextOption == "--workers") {
+                numberOfWorkers = atoi(string(argv[++i]).c_str());
+            } else if (nextOption == "--sessions") {
+                numberOfSessions = atoi(string(argv[++i]).c_str());
             } else {
                 cerr << "Unknown option: " << nextOption << endl;
                 printUsage();
@@ -594,9 +818,35 @@ int main(int argc, char** argv) {
         }
     }
 
-    // Create connector to rddlsim and run
-    IPCClient* client = new IPCClient(hostName, port, parserOptions);
-    client->run(problemFileName, plannerDesc);
+    if (runServer) {
+        // Run a simulator server for the benchmarks in the given directory
+        SimulatorServer server(problemFileName, port, numberOfRounds,
+                               simulatorSeed, simulationTime, numberOfSessions,
+                               parserOptions);
+        server.run();
+        return 0;
+    } else if (runDaemon) {
+        // Run a planner daemon that writes to the given directory
+        PlannerDaemon daemon(problemFileName, port, numberOfWorkers,
+                             numberOfSessions, hostName, plannerDesc,
+                             parserOptions);
+        daemon.run();
+        return 0;
+    } else if (simulate) {
+        // Run the task in a local simulation
+        vector<string> rddlFiles;
+        if (!domainFileName.empty()) {
+            rddlFiles.push_back(domainFileName);
+        }
+        rddlFiles.push_back(problemFileName);
+        LocalSimulator simulator(rddlFiles, numberOfRounds, simulatorSeed,
+                                 simulationTime, parserOptions);
+        simulator.run(plannerDesc);
+    } else {
+        // Create connector to rddlsim and run
+        IPCClient* client = new IPCClient(hostName, port, parserOptions);
+        client->run(problemFileName, plannerDesc);
+    }
 
     Logger::logLine(
         "PROST complete running time: " + to_string(totalTime()),
@@ -2,18 +2,17 @@
 
 #include "utils/logger.h"
 
-using namespace std;
+#include <algorithm>
 
-MinimalLookaheadSearch::HashMap MinimalLookaheadSearch::rewardCache;
+using namespace std;
 
-MinimalLookaheadSearch::MinimalLookaheadSearch()
-    : DeterministicSearchEngine("MLS"),
+MinimalLookaheadSearch::MinimalLookaheadSearch(PlanningTask& _task)
+    : DeterministicSearchEngine("MLS", _task),
       numberOfRuns(0),
       cacheHits(0),
+      sharedEvaluations(0),
       numberOfRunsInCurrentRound(0) {
-    if (rewardCache.bucket_count() < 520241) {
-        rewardCache.reserve(520241);
-    }
+    rewardCache.reserve(520241);
 }
 
 void MinimalLookaheadSearch::estimateQValue(State const& state, int actionIndex,
@@ -29,9 +28,9 @@ void MinimalLookaheadSearch::estimateQValue(State const& state, int actionIndex,
         // Apply the action to state
         calcReward(state, actionIndex, qValue);
 
-        if (rewardCPF->isActionIndependent() ||
-            (actionStates[0].isNoop &&
-             actionStates[0].actionPreconditions.empty())) {
+        if (task.rewardCPF->isActionIndependent() ||
+            (task.actionStates[0].isNoop &&
+             task.actionStates[0].actionPreconditions.empty())) {
             // Caculate the successor state if the action with index actionIndex
             // is applied, and use noop to calculate the reward in the next
             // state. This increases the informativeness of the reward that can
@@ -47,7 +46,7 @@ void MinimalLookaheadSearch::estimateQValue(State const& state, int actionIndex,
         if (cachingEnabled) {
             if (it == rewardCache.end()) {
                 rewardCache[state] =
-                    vector<double>(SearchEngine::numberOfActions,
+                    vector<double>(task.numberOfActions,
                                    -std::numeric_limits<double>::max());
             }
             rewardCache[state][actionIndex] = qValue;
@@ -74,54 +73,46 @@ void MinimalLookaheadSearch::estimateQValues(State const& state,
             }
         }
     } else {
-        if (rewardCPF->isActionIndependent()) {
+        vector<int> actionIndices;
+        for (size_t index = 0; index < actionsToExpand.size(); ++index) {
+            if (actionsToExpand[index] == index) {
+                actionIndices.push_back(index);
+            }
+        }
+
+        vector<double> rewards(actionIndices.size());
+        if (task.rewardCPF->isActionIndependent()) {
             // Calculate the reward in state. It doesn't matter which action we
             // use for this, since there is no action fluent in the reward
             // formula anyway (it therefore doesn't even matter if the used
             // action is applicable or not)
             double reward = 0.0;
             calcReward(state, 0, reward);
+            fill(rewards.begin(), rewards.end(), reward);
+        } else {
+            evaluateForAllActions(
+                task.rewardCPF, state, actionIndices, rewards);
+        }
 
-            for (size_t index = 0; index < actionsToExpand.size(); ++index) {
-                if (actionsToExpand[index] == index) {
-                    // Calculate the successor state given this action is
-                    // applied (i.e., the action matters here!)
-                    State next;
-                    calcSuccessorState(state, index, next);
-
-                    // Now that we have the successor state, we can (again) use
-                    // any action to calculate the reward of the next state.
-                    double reward2;
-                    calcReward(next, 0, reward2);
-                    qValues[index] = (reward + reward2) / 2.0;
-                }
-            }
-        } else if (actionStates[0].isNoop &&
-                   actionStates[0].actionPreconditions.empty()) {
-            // There is an action fluent in the reward (and the reward in state
-            // hence depends on the applied action), but it is often the case
-            // that only the "bad" part of applying an action is in this result,
+        if (task.rewardCPF->isActionIndependent() ||
+            (task.actionStates[0].isNoop &&
+             task.actionStates[0].actionPreconditions.empty())) {
+            // If the reward is action independent, the applied action only
+            // matters in the successor state. Otherwise, it is often the case
+            // that only the "bad" part of applying an action is in the reward,
             // while the positive effect of the action is not. Since noop is
-            // always applicable in this task, we apply in the next state to
-            // account for those positive effects.
-            for (size_t index = 0; index < actionsToExpand.size(); ++index) {
-                if (actionsToExpand[index] == index) {
-                    State next;
-                    double reward;
-                    calcStateTransition(state, index, next, reward);
-
-                    // Use noop to calculate the reward in the next state.
-                    double reward2;
-                    calcReward(next, 0, reward2);
-                    qValues[index] = (reward + reward2) / 2.0;
-                }
+            // always applicable in this task, we apply it in the successor
+            // state to account for those positive effects.
+            vector<State> successors;
+            calcSuccessorStates(state, actionIndices, successors);
+            for (size_t i = 0; i < actionIndices.size(); ++i) {
+                double reward2;
+                calcReward(successors[i], 0, reward2);
+                qValues[actionIndices[i]] = (rewards[i] + reward2) / 2.0;
             }
         } else {
-            // Apply all actions to state
-            for (size_t index = 0; index < actionsToExpand.size(); ++index) {
-                if (actionsToExpand[index] == index) {
-                    calcReward(state, index, qValues[index]);
-                }
+            for (size_t i = 0; i < actionIndices.size(); ++i) {
+                qValues[actionIndices[i]] = rewards[i];
             }
         }
 
@@ -139,6 +130,54 @@ void MinimalLookaheadSearch::estimateQValues(State const& state,
     }
 }
 
+void MinimalLookaheadSearch::calcSuccessorStates(
+    State const& state, vector<int> const& actionIndices,
+    vector<State>& successors) {
+    successors.assign(actionIndices.size(), State(state.stepsToGo() - 1));
+    vector<double> values(actionIndices.size());
+    for (int index = 0; index < State::numberOfDeterministicStateFluents();
+         ++index) {
+        evaluateForAllActions(
+            task.deterministicCPFs[index], state, actionIndices, values);
+        for (size_t i = 0; i < actionIndices.size(); ++i) {
+            successors[i].deterministicStateFluent(index) = values[i];
+        }
+    }
+    for (int index = 0; index < State::numberOfProbabilisticStateFluents();
+         ++index) {
+        evaluateForAllActions(
+            task.determinizedCPFs[index], state, actionIndices, values);
+        for (size_t i = 0; i < actionIndices.size(); ++i) {
+            successors[i].probabilisticStateFluent(index) = values[i];
+        }
+    }
+    for (State& successor : successors) {
+        State::calcStateFluentHashKeys(successor);
+        State::calcStateHashKey(successor);
+    }
+}
+
+void MinimalLookaheadSearch::evaluateForAllActions(
+    DeterministicEvaluatable* eval, State const& state,
+    vector<int> const& actionIndices, vector<double>& values) {
+    vector<long> const& actionHashKeys = eval->actionHashKeyMap;
+    actionWithHashKey.assign(task.numberOfActions, -1);
+    for (size_t i = 0; i < actionIndices.size(); ++i) {
+        int actionIndex = actionIndices[i];
+        long key = actionHashKeys[actionIndex];
+        bool keyIsIndex = (key >= 0) && (key < actionWithHashKey.size());
+        if (keyIsIndex && (actionWithHashKey[key] >= 0)) {
+            values[i] = values[actionWithHashKey[key]];
+            ++sharedEvaluations;
+        } else {
+            eval->evaluate(values[i], state, task.actionStates[actionIndex]);
+            if (keyIsIndex) {
+                actionWithHashKey[key] = i;
+            }
+        }
+    }
+}
+
 void MinimalLookaheadSearch::printRoundStatistics(std::string indent) const {
     Logger::logLine(indent + name + " round statistics:", Verbosity::NORMAL);
     indent += "  ";
@@ -164,14 +203,15 @@ void MinimalLookaheadSearch::printStepStatistics(std::string indent) const {
         Verbosity::NORMAL);
     Logger::logLine(
         indent + "Cache hits: " + to_string(cacheHits), Verbosity::VERBOSE);
+    Logger::logLine(
+        indent + "Shared evaluations: " + to_string(sharedEvaluations),
+        Verbosity::VERBOSE);
 }
 
 void MinimalLookaheadSearch::printRewardCacheUsage(
         std::string indent, Verbosity verbosity) const {
-    long entriesMLSRewardCache =
-            MinimalLookaheadSearch::rewardCache.size();
-    long bucketsMLSRewardCache =
-            MinimalLookaheadSearch::rewardCache.bucket_count();
+    long entriesMLSRewardCache = rewardCache.size();
+    long bucketsMLSRewardCache = rewardCache.bucket_count();
     Logger::logLine(
             indent + "Entries in MLS reward cache: " +
             to_string(entriesMLSRewardCache), verbosity);
@@ -7,7 +7,7 @@
 
 class MinimalLookaheadSearch : public DeterministicSearchEngine {
 public:
-    MinimalLookaheadSearch();
+    MinimalLookaheadSearch(PlanningTask& _task);
 
     // Notify the search engine that a new round starts
     void initRound() override {
@@ -18,6 +18,7 @@ public:
     void initStep(State const& /*current*/) override {
         numberOfRuns = 0;
         cacheHits = 0;
+        sharedEvaluations = 0;
     }
     void finishStep() override {
         numberOfRunsInCurrentRound += numberOfRuns;
@@ -46,15 +47,34 @@ public:
                                State::HashWithoutRemSteps,
                                State::EqualWithoutRemSteps>
         HashMap;
-    static HashMap rewardCache;
+    HashMap rewardCache;
 
 protected:
     void printRewardCacheUsage(
             std::string indent, Verbosity verbosity = Verbosity::VERBOSE) const;
 
+    // Computes the successor states of state under all given actions
+    void calcSuccessorStates(State const& state,
+                             std::vector<int> const& actionIndices,
+                             std::vector<State>& successors);
+
+    // Evaluates eval in state under all given actions and writes the results
+    // to values (values[i] is the result of actionIndices[i]). Actions with
+    // the same action hash key in eval agree on all action fluents eval
+    // depends on, so eval is evaluated only once per action hash key.
+    void evaluateForAllActions(DeterministicEvaluatable* eval,
+                               State const& state,
+                               std::vector<int> const& actionIndices,
+                               std::vector<double>& values);
+
+    // In evaluateForAllActions, actionWithHashKey[key] is the position in
+    // actionIndices of the evaluated action with action hash key key (or -1)
+    std::vector<int> actionWithHashKey;
+
     // Per step statistics
     int numberOfRuns;
     int cacheHits;
+    int sharedEvaluations;
 
     // Per round statistics
     int numberOfRunsInCurrentRound;
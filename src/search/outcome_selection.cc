@@ -3,9 +3,12 @@
 #include "thts.h"
 
 #include "utils/logger.h"
+#include "utils/math_utils.h"
 #include "utils/string_utils.h"
 #include "utils/system_utils.h"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 using std::vector;
@@ -60,12 +63,14 @@ SearchNode* MCOutcomeSelection::selectOutcome(SearchNode* node,
                                               int lastProbVarIndex) {
     if (node->children.empty()) {
         node->children.resize(
-            SearchEngine::probabilisticCPFs[varIndex]->getDomainSize(),
+            thts->getTask().probabilisticCPFs[varIndex]->getDomainSize(),
             nullptr);
     }
-    vector<int> blacklist = computeBlacklist(node, nextState, varIndex);
+    blacklist.clear();
+    computeBlacklist(node, nextState, varIndex, blacklist);
 
-    std::pair<double, double> sample = nextState.sample(varIndex, blacklist);
+    std::pair<double, double> sample =
+        nextState.sample(varIndex, thts->getTask().rnd, blacklist);
     int childIndex = static_cast<int>(sample.first);
     assert((childIndex >= 0) && childIndex < node->children.size());
 
@@ -81,22 +86,156 @@ SearchNode* MCOutcomeSelection::selectOutcome(SearchNode* node,
     return node->children[childIndex];
 }
 
+SearchNode* MCOutcomeSelection::selectJointOutcome(
+    SearchNode* node, PDState& nextState, vector<int> const& varIndices) {
+    // Rejection sampling needs many draws if only outcomes with a small
+    // probability are not rejected, so the number of draws is bounded and the
+    // outcome is sampled among the outcomes that are not rejected afterwards
+    size_t maxDraws = node->children.size() + 1;
+    for (size_t draw = 0; draw < maxDraws; ++draw) {
+        double prob = 1.0;
+        for (int varIndex : varIndices) {
+            prob *= nextState.sample(varIndex, thts->getTask().rnd).second;
+        }
+        int outcomeIndex = thts->getJointOutcomeIndex(nextState, varIndices);
+
+        auto it = node->findJointOutcome(outcomeIndex);
+        if ((it == node->children.end()) ||
+            ((*it)->outcomeIndex != outcomeIndex)) {
+            SearchNode* child = thts->createDecisionNode(prob);
+            child->outcomeIndex = outcomeIndex;
+            node->children.insert(it, child);
+            return child;
+        } else if (!rejectJointOutcome(*it)) {
+            return *it;
+        }
+    }
+    return sampleNonRejectedJointOutcome(node, nextState, varIndices);
+}
+
+SearchNode* MCOutcomeSelection::sampleNonRejectedJointOutcome(
+    SearchNode* node, PDState& nextState, vector<int> const& varIndices) {
+    PlanningTask const& task = thts->getTask();
+    int numberOfOutcomes = 1;
+    for (int varIndex : varIndices) {
+        numberOfOutcomes *= task.probabilisticCPFs[varIndex]->getDomainSize();
+    }
+
+    // The values are sampled from the most to the least significant digit of
+    // the outcome index, so the joint outcomes with the values that have been
+    // sampled so far are the outcomes with an index in [outcomeIndex,
+    // outcomeIndex + numberOfOutcomes), and the decision nodes of these
+    // outcomes are adjacent among the children
+    int outcomeIndex = 0;
+    double prob = 1.0;
+    for (auto varIt = varIndices.rbegin(); varIt != varIndices.rend();
+         ++varIt) {
+        int varIndex = *varIt;
+        numberOfOutcomes /= task.probabilisticCPFs[varIndex]->getDomainSize();
+        DiscretePD const& pd = nextState.probabilisticStateFluentAsPD(varIndex);
+
+        // The weight of a value is the probability of the joint outcomes with
+        // this value minus the probability of those that are rejected. It is
+        // only zero if all these outcomes are rejected, as rounding errors
+        // must neither make a value with remaining outcomes impossible nor
+        // allow a value without remaining outcomes
+        outcomeWeights.assign(pd.size(), 0.0);
+        double weightSum = 0.0;
+        for (int i = 0; i < pd.size(); ++i) {
+            int firstIndex =
+                outcomeIndex + static_cast<int>(pd.values[i]) * numberOfOutcomes;
+            double weight = prob * pd.probabilities[i];
+            int numberOfRejectedOutcomes = 0;
+            for (auto it = node->findJointOutcome(firstIndex);
+                 (it != node->children.end()) &&
+                 ((*it)->outcomeIndex < firstIndex + numberOfOutcomes);
+                 ++it) {
+                if (rejectJointOutcome(*it)) {
+                    weight -= (*it)->prob;
+                    ++numberOfRejectedOutcomes;
+                }
+            }
+            if (numberOfRejectedOutcomes < numberOfOutcomes) {
+                outcomeWeights[i] =
+                    std::max(weight, std::numeric_limits<double>::min());
+                weightSum += outcomeWeights[i];
+            }
+        }
+        assert(weightSum > 0.0);
+
+        double randNum = thts->getTask().rnd.genDouble(0.0, weightSum);
+        int sampled = 0;
+        for (int i = 0; i < pd.size(); ++i) {
+            if (outcomeWeights[i] > 0.0) {
+                sampled = i;
+                randNum -= outcomeWeights[i];
+                if (randNum < 0.0) {
+                    break;
+                }
+            }
+        }
+
+        nextState.probabilisticStateFluent(varIndex) = pd.values[sampled];
+        outcomeIndex +=
+            static_cast<int>(pd.values[sampled]) * numberOfOutcomes;
+        prob *= pd.probabilities[sampled];
+    }
+    assert(outcomeIndex == thts->getJointOutcomeIndex(nextState, varIndices));
+
+    auto it = node->findJointOutcome(outcomeIndex);
+    if ((it != node->children.end()) && ((*it)->outcomeIndex == outcomeIndex)) {
+        return *it;
+    }
+    SearchNode* child = thts->createDecisionNode(prob);
+    child->outcomeIndex = outcomeIndex;
+    node->children.insert(it, child);
+    return child;
+}
+
+bool MCOutcomeSelection::setValueFromString(std::string& param,
+                                            std::string& value) {
+    if (param == "-joint") {
+        setJointOutcomes(atoi(value.c_str()));
+        return true;
+    }
+
+    return false;
+}
+
+void MCOutcomeSelection::printConfig(std::string indent) const {
+    OutcomeSelection::printConfig(indent);
+
+    indent += "  ";
+    if (jointOutcomes) {
+        Logger::logLine(indent + "Joint outcomes: enabled",
+                        Verbosity::VERBOSE);
+    } else {
+        Logger::logLine(indent + "Joint outcomes: disabled",
+                        Verbosity::VERBOSE);
+    }
+}
+
 /******************************************************************
              MC Outcome Selection with Solve Labeling
 ******************************************************************/
 
-vector<int> UnsolvedMCOutcomeSelection::computeBlacklist(
-    SearchNode* node, PDState const& nextState, int varIndex) const {
-    vector<int> blacklist;
+void UnsolvedMCOutcomeSelection::computeBlacklist(
+    SearchNode* node, PDState const& nextState, int varIndex,
+    OutcomeMask& blacklist) const {
     // Determines the indices of all solved outcomes
     DiscretePD const& pd = nextState.probabilisticStateFluentAsPD(varIndex);
-    for (size_t i = 0; i < pd.size(); ++i) {
+    for (int i = 0; i < pd.size(); ++i) {
         int childIndex = pd.values[i];
         if (node->children[childIndex] && node->children[childIndex]->solved) {
-            blacklist.push_back(i);
+            blacklist.insert(i);
         }
     }
-    return blacklist;
+}
+
+bool UnsolvedMCOutcomeSelection::rejectJointOutcome(
+    SearchNode const* child) const {
+    // The chance node is not solved, so there is an unsolved outcome
+    return child->solved;
 }
 
 void OutcomeSelection::printConfig(std::string indent) const {
@@ -33,6 +33,22 @@ public:
     virtual SearchNode* selectOutcome(SearchNode* node, PDState& nextState,
                                       int varIndex, int lastProbVarIndex) = 0;
 
+    // If this returns true, the outcomes of all probabilistic state fluents
+    // are selected in a single pass with selectJointOutcome instead of one
+    // chance node layer per state fluent with selectOutcome
+    virtual bool selectsJointOutcomes() const {
+        return false;
+    }
+
+    // Joint outcome selection of the probabilistic state fluents with the
+    // given indices, which returns the decision node of the successor state
+    virtual SearchNode* selectJointOutcome(
+        SearchNode* /*node*/, PDState& /*nextState*/,
+        std::vector<int> const& /*varIndices*/) {
+        assert(false);
+        return nullptr;
+    }
+
     // Prints statistics
     virtual void printConfig(std::string indent) const;
     virtual void printStepStatistics(std::string /*indent*/) const {}
@@ -52,18 +68,62 @@ protected:
 class MCOutcomeSelection : public OutcomeSelection {
 public:
     MCOutcomeSelection(THTS* _thts)
-        : OutcomeSelection(_thts, "MonteCarlo outcome selection") {}
+        : OutcomeSelection(_thts, "MonteCarlo outcome selection"),
+          jointOutcomes(false) {}
+
+    // Set parameters from command line
+    bool setValueFromString(std::string& param, std::string& value) override;
+
+    // Parameter setter
+    void setJointOutcomes(bool _jointOutcomes) {
+        jointOutcomes = _jointOutcomes;
+    }
 
     SearchNode* selectOutcome(SearchNode* node, PDState& nextState,
                               int varIndex, int lastProbVarIndex) override;
 
+    bool selectsJointOutcomes() const override {
+        return jointOutcomes;
+    }
+
+    SearchNode* selectJointOutcome(
+        SearchNode* node, PDState& nextState,
+        std::vector<int> const& varIndices) override;
+
     // A blacklist indicates which values are ignored for outcome selection.
     // Basic MC Sampling does not ignore any values.
-    virtual std::vector<int> computeBlacklist(SearchNode* /*node*/,
-                                              PDState const& /*nextState*/,
-                                              int /*varIndex*/) const {
-        return std::vector<int>{};
+    virtual void computeBlacklist(SearchNode* /*node*/,
+                                  PDState const& /*nextState*/,
+                                  int /*varIndex*/,
+                                  OutcomeMask& /*blacklist*/) const {}
+
+    // In joint outcome selection, a sampled outcome is rejected (and another
+    // one is sampled) if this returns true for its decision node. Basic MC
+    // Sampling does not reject any outcomes. At least one outcome must not be
+    // rejected if this is called (e.g., UMC is only called on unsolved chance
+    // nodes).
+    virtual bool rejectJointOutcome(SearchNode const* /*child*/) const {
+        return false;
     }
+
+    void printConfig(std::string indent) const override;
+
+private:
+    // Samples a joint outcome among the outcomes that are not rejected with
+    // probabilities proportional to their probabilities, without rejection
+    SearchNode* sampleNonRejectedJointOutcome(
+        SearchNode* node, PDState& nextState,
+        std::vector<int> const& varIndices);
+
+    // The blacklist is reused in each outcome selection to avoid allocations
+    OutcomeMask blacklist;
+
+    // The weights of the values of a state fluent in
+    // sampleNonRejectedJointOutcome (reused to avoid allocations)
+    std::vector<double> outcomeWeights;
+
+    // Parameter
+    bool jointOutcomes;
 };
 
 class UnsolvedMCOutcomeSelection : public MCOutcomeSelection {
@@ -74,9 +134,11 @@ public:
     }
 
     // Unsolved outcome selection ignores values which are already solved.
-    std::vector<int> computeBlacklist(SearchNode* node,
-                                      PDState const& nextState,
-                                      int varIndex) const override;
+    void computeBlacklist(SearchNode* node, PDState const& nextState,
+                          int varIndex, OutcomeMask& blacklist) const override;
+
+    // Unsolved outcome selection rejects joint outcomes which are solved.
+    bool rejectJointOutcome(SearchNode const* child) const override;
 };
 
 #endif
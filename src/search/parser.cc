@@ -1,12 +1,30 @@
 #include "parser.h"
 
-#include "search_engine.h"
+#include "planning_task.h"
 
+#include "utils/logger.h"
 #include "utils/string_utils.h"
 #include "utils/system_utils.h"
 
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace std;
 
+string Parser::cacheDirectory;
+
+namespace {
+// The temporary files of the external parser are numbered, as several threads
+// of a process may run it concurrently
+atomic<int> numberOfParserRuns{0};
+} // namespace
+
 void Parser::parseTask(map<string, int>& stateVariableIndices,
                        vector<vector<string>>& stateVariableValues) {
     // Read the parser output file
@@ -16,75 +34,82 @@ void Parser::parseTask(map<string, int>& stateVariableIndices,
                            problemFileName);
     }
     stringstream desc(problemDesc);
+
+    // States and action states are created while the task is parsed, so the
+    // task must be active
+    task.activate();
+    State::Layout& stateLayout = task.stateLayout;
+    KleeneState::Layout& kleeneStateLayout = task.kleeneStateLayout;
+
     // Parse general task properties
-    desc >> SearchEngine::taskName;
-    desc >> SearchEngine::horizon;
-    desc >> SearchEngine::discountFactor;
+    desc >> task.taskName;
+    desc >> task.horizon;
+    desc >> task.discountFactor;
 
     // Parse numbers of fluents and evaluatables
     int numberOfActionFluents;
     desc >> numberOfActionFluents;
 
-    desc >> State::numberOfDeterministicStateFluents;
-    desc >> State::numberOfProbabilisticStateFluents;
+    desc >> stateLayout.numberOfDeterministicStateFluents;
+    desc >> stateLayout.numberOfProbabilisticStateFluents;
 
     int numberOfPreconds;
     desc >> numberOfPreconds;
 
-    desc >> SearchEngine::numberOfActions;
-    desc >> State::numberOfStateFluentHashKeys;
-    KleeneState::numberOfStateFluentHashKeys =
-        State::numberOfStateFluentHashKeys;
+    desc >> task.numberOfActions;
+    desc >> stateLayout.numberOfStateFluentHashKeys;
+    kleeneStateLayout.numberOfStateFluentHashKeys =
+        stateLayout.numberOfStateFluentHashKeys;
 
-    KleeneState::stateSize = State::numberOfDeterministicStateFluents +
-                             State::numberOfProbabilisticStateFluents;
+    kleeneStateLayout.stateSize = State::numberOfDeterministicStateFluents() +
+                                  State::numberOfProbabilisticStateFluents();
 
     // Parse initial state
     vector<double> initialValsOfDeterministicStateFluents(
-        State::numberOfDeterministicStateFluents, 0.0);
-    for (size_t i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
+        State::numberOfDeterministicStateFluents(), 0.0);
+    for (size_t i = 0; i < State::numberOfDeterministicStateFluents(); ++i) {
         desc >> initialValsOfDeterministicStateFluents[i];
     }
     vector<double> initialValsOfProbabilisticStateFluents(
-        State::numberOfProbabilisticStateFluents, 0.0);
-    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
+        State::numberOfProbabilisticStateFluents(), 0.0);
+    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents(); ++i) {
         desc >> initialValsOfProbabilisticStateFluents[i];
     }
-    SearchEngine::initialState =
+    task.initialState =
         State(initialValsOfDeterministicStateFluents,
-              initialValsOfProbabilisticStateFluents, SearchEngine::horizon);
+              initialValsOfProbabilisticStateFluents, task.horizon);
 
     // Parse task properties
-    desc >> SearchEngine::taskIsDeterministic;
-    desc >> State::stateHashingPossible;
-    desc >> KleeneState::stateHashingPossible;
+    desc >> task.taskIsDeterministic;
+    desc >> stateLayout.stateHashingPossible;
+    desc >> kleeneStateLayout.stateHashingPossible;
 
     string finalReward;
     desc >> finalReward;
     if (finalReward == "CONSTANT") {
-        SearchEngine::candidatesForOptimalFinalAction.resize(1);
-        desc >> SearchEngine::candidatesForOptimalFinalAction[0];
-        SearchEngine::goalTestActionIndex =
-            SearchEngine::candidatesForOptimalFinalAction[0];
+        task.candidatesForOptimalFinalAction.resize(1);
+        desc >> task.candidatesForOptimalFinalAction[0];
+        task.goalTestActionIndex =
+            task.candidatesForOptimalFinalAction[0];
     } else if (finalReward == "CANDIDATE_SET") {
         int sizeOfCandidateSet;
         desc >> sizeOfCandidateSet;
-        SearchEngine::candidatesForOptimalFinalAction.resize(
+        task.candidatesForOptimalFinalAction.resize(
             sizeOfCandidateSet);
         for (size_t i = 0; i < sizeOfCandidateSet; ++i) {
-            desc >> SearchEngine::candidatesForOptimalFinalAction[i];
+            desc >> task.candidatesForOptimalFinalAction[i];
         }
     } else {
         assert(finalReward == "FIRST_APPLICABLE");
     }
 
-    desc >> SearchEngine::rewardLockDetected;
-    if (!SearchEngine::rewardLockDetected) {
-        SearchEngine::goalTestActionIndex = -1;
+    desc >> task.rewardLockDetected;
+    if (!task.rewardLockDetected) {
+        task.goalTestActionIndex = -1;
     }
 
-    desc >> ProbabilisticSearchEngine::hasUnreasonableActions;
-    desc >> DeterministicSearchEngine::hasUnreasonableActions;
+    desc >> task.hasUnreasonableActions;
+    desc >> task.determinizationHasUnreasonableActions;
 
     int encounteredStates;
     int encounteredUnqiueStates;
@@ -108,43 +133,51 @@ void Parser::parseTask(map<string, int>& stateVariableIndices,
     vector<string> deterministicFormulas;
     vector<string> probabilisticFormulas;
     vector<string> determinizedFormulas;
-    for (size_t i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
+    for (size_t i = 0; i < State::numberOfDeterministicStateFluents(); ++i) {
         parseCPF(desc, deterministicFormulas, probabilisticFormulas,
                  determinizedFormulas, false);
     }
 
-    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
+    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents(); ++i) {
         parseCPF(desc, deterministicFormulas, probabilisticFormulas,
                  determinizedFormulas, true);
     }
 
     assert(deterministicFormulas.size() ==
-           State::numberOfDeterministicStateFluents);
-    assert(SearchEngine::deterministicCPFs.size() ==
-           State::numberOfDeterministicStateFluents);
+           State::numberOfDeterministicStateFluents());
+    assert(task.deterministicCPFs.size() ==
+           State::numberOfDeterministicStateFluents());
 
     assert(probabilisticFormulas.size() ==
-           State::numberOfProbabilisticStateFluents);
-    assert(SearchEngine::probabilisticCPFs.size() ==
-           State::numberOfProbabilisticStateFluents);
+           State::numberOfProbabilisticStateFluents());
+    assert(task.probabilisticCPFs.size() ==
+           State::numberOfProbabilisticStateFluents());
 
     assert(determinizedFormulas.size() ==
-           State::numberOfProbabilisticStateFluents);
-    assert(SearchEngine::determinizedCPFs.size() ==
-           State::numberOfProbabilisticStateFluents);
-
-    assert(SearchEngine::allCPFs.size() == KleeneState::stateSize);
+           State::numberOfProbabilisticStateFluents());
+    assert(task.determinizedCPFs.size() ==
+           State::numberOfProbabilisticStateFluents());
+
+    assert(task.allCPFs.size() == KleeneState::stateSize());
+    kleeneStateLayout.domainSizes.clear();
+    kleeneStateLayout.hasLargeDomains = false;
+    for (Evaluatable const* cpf : task.allCPFs) {
+        kleeneStateLayout.domainSizes.push_back(cpf->getDomainSize());
+        if (cpf->getDomainSize() > KleeneState::maxBitsetDomainSize) {
+            kleeneStateLayout.hasLargeDomains = true;
+        }
+    }
 
     // All fluents have been created -> create the CPF formulas
-    for (size_t i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
-        SearchEngine::deterministicCPFs[i]->formula =
+    for (size_t i = 0; i < State::numberOfDeterministicStateFluents(); ++i) {
+        task.deterministicCPFs[i]->formula =
             LogicalExpression::createFromString(deterministicFormulas[i]);
     }
 
-    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
-        SearchEngine::probabilisticCPFs[i]->formula =
+    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents(); ++i) {
+        task.probabilisticCPFs[i]->formula =
             LogicalExpression::createFromString(probabilisticFormulas[i]);
-        SearchEngine::determinizedCPFs[i]->formula =
+        task.determinizedCPFs[i]->formula =
             LogicalExpression::createFromString(determinizedFormulas[i]);
     }
 
@@ -157,54 +190,185 @@ void Parser::parseTask(map<string, int>& stateVariableIndices,
     }
 
     // Parse action states
-    for (size_t i = 0; i < SearchEngine::numberOfActions; ++i) {
+    for (size_t i = 0; i < task.numberOfActions; ++i) {
         parseActionState(desc);
     }
 
     // Parse hash keys
-    if (State::stateHashingPossible) {
-        State::stateHashKeysOfDeterministicStateFluents.resize(
-            State::numberOfDeterministicStateFluents);
-        State::stateHashKeysOfProbabilisticStateFluents.resize(
-            State::numberOfProbabilisticStateFluents);
+    if (State::stateHashingPossible()) {
+        stateLayout.stateHashKeysOfDeterministicStateFluents.resize(
+            State::numberOfDeterministicStateFluents());
+        stateLayout.stateHashKeysOfProbabilisticStateFluents.resize(
+            State::numberOfProbabilisticStateFluents());
     }
-    State::stateFluentHashKeysOfDeterministicStateFluents.resize(
-        State::numberOfDeterministicStateFluents);
-    State::stateFluentHashKeysOfProbabilisticStateFluents.resize(
-        State::numberOfProbabilisticStateFluents);
+    stateLayout.stateFluentHashKeysOfDeterministicStateFluents.resize(
+        State::numberOfDeterministicStateFluents());
+    stateLayout.stateFluentHashKeysOfProbabilisticStateFluents.resize(
+        State::numberOfProbabilisticStateFluents());
 
-    if (KleeneState::stateHashingPossible) {
-        KleeneState::hashKeyBases.resize(KleeneState::stateSize);
+    if (kleeneStateLayout.stateHashingPossible) {
+        kleeneStateLayout.hashKeyBases.resize(KleeneState::stateSize());
     }
-    KleeneState::indexToStateFluentHashKeyMap.resize(KleeneState::stateSize);
+    kleeneStateLayout.indexToStateFluentHashKeyMap.resize(
+        KleeneState::stateSize());
 
     parseHashKeys(desc);
+    if (!State::stateHashingPossible()) {
+        createZobristKeys();
+    }
+    task.determineActionDependentEvaluatables();
 
     // Calculate hash keys of initial state
-    State::calcStateFluentHashKeys(SearchEngine::initialState);
-    State::calcStateHashKey(SearchEngine::initialState);
+    State::calcStateFluentHashKeys(task.initialState);
+    State::calcStateHashKey(task.initialState);
 
     // Parse training set
     parseTrainingSet(desc);
 
     // Set mapping of variables to variable names and of values as strings to
     // internal values for communication between planner and environment
-    for (size_t i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
+    for (size_t i = 0; i < State::numberOfDeterministicStateFluents(); ++i) {
         assert(stateVariableIndices.find(
-                   SearchEngine::deterministicCPFs[i]->name) ==
+                   task.deterministicCPFs[i]->name) ==
                stateVariableIndices.end());
-        stateVariableIndices[SearchEngine::deterministicCPFs[i]->name] = i;
+        stateVariableIndices[task.deterministicCPFs[i]->name] = i;
         stateVariableValues.push_back(
-            SearchEngine::deterministicCPFs[i]->head->values);
+            task.deterministicCPFs[i]->head->values);
     }
-    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
+    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents(); ++i) {
         assert(stateVariableIndices.find(
-                   SearchEngine::probabilisticCPFs[i]->name) ==
+                   task.probabilisticCPFs[i]->name) ==
                stateVariableIndices.end());
-        stateVariableIndices[SearchEngine::probabilisticCPFs[i]->name] =
-            State::numberOfDeterministicStateFluents + i;
+        stateVariableIndices[task.probabilisticCPFs[i]->name] =
+            State::numberOfDeterministicStateFluents() + i;
         stateVariableValues.push_back(
-            SearchEngine::probabilisticCPFs[i]->head->values);
+            task.probabilisticCPFs[i]->head->values);
+    }
+}
+
+// Returns the key of the cache entry of the parser output, which consists of
+// the parser executable (and its size and modification time, which identify
+// its build), the parser options and the task description
+inline string getParserCacheKey(string const& parserExec,
+                                string const& parserOptions,
+                                string const& taskDesc) {
+    stringstream key;
+    key << parserExec;
+    struct stat parserStat;
+    if (stat(parserExec.c_str(), &parserStat) == 0) {
+        key << " " << parserStat.st_size << " " << parserStat.st_mtime;
+    }
+    key << '\n' << parserOptions << '\n' << taskDesc;
+    return key.str();
+}
+
+// The key of a cache entry is stored in comment lines at the beginning of the
+// entry, so it is ignored when the entry is parsed
+inline string getParserCacheHeader(string const& key) {
+    stringstream keyStream(key);
+    stringstream header;
+    string line;
+    while (getline(keyStream, line)) {
+        header << "#" << line << '\n';
+    }
+    return header.str();
+}
+
+void Parser::parseRDDLTask(PlanningTask& task, string const& taskDesc,
+                           string const& parserOptions,
+                           map<string, int>& stateVariableIndices,
+                           vector<vector<string>>& stateVariableValues) {
+#ifdef NDEBUG
+    std::string parserExec = "./rddl-parser-release";
+#else
+    std::string parserExec = "./rddl-parser-debug";
+#endif
+    // Look up the parser output in the cache. The name of a cache entry is
+    // the hash value of its key, so the entry is only used if it starts with
+    // the whole key.
+    string cachedParserOut;
+    string cacheHeader;
+    if (!cacheDirectory.empty()) {
+        string key = getParserCacheKey(parserExec, parserOptions, taskDesc);
+        cacheHeader = getParserCacheHeader(key);
+        stringstream cacheFileStream;
+        cacheFileStream << cacheDirectory << "/" << hex << hash<string>()(key)
+                        << ".parsed";
+        cachedParserOut = cacheFileStream.str();
+        ifstream cacheFile(cachedParserOut);
+        string cachedHeader(cacheHeader.size(), '\0');
+        if (cacheFile.read(&cachedHeader[0], cachedHeader.size()) &&
+            (cachedHeader == cacheHeader) && (cacheFile.peek() != '#')) {
+            Logger::logLine("Using cached parser output " + cachedParserOut,
+                            Verbosity::VERBOSE);
+            Parser parser(cachedParserOut, task);
+            parser.parseTask(stateVariableIndices, stateVariableValues);
+            return;
+        }
+    }
+
+    Logger::logLine(
+        "Running RDDL parser at " + parserExec, Verbosity::VERBOSE);
+    // Generate temporary input file for parser
+    int parserRun = numberOfParserRuns++;
+    std::ofstream taskFile;
+    stringstream taskFileNameStream;
+    taskFileNameStream << "./parser_in_" << ::getpid() << "_" << parserRun
+                       << ".rddl";
+    string taskFileName = taskFileNameStream.str();
+    taskFile.open(taskFileName.c_str());
+    taskFile << taskDesc << endl;
+    taskFile.close();
+
+    stringstream parserOutStream;
+    parserOutStream << "parser_out_" << ::getpid() << "_" << parserRun;
+    string parserOut = parserOutStream.str();
+
+    stringstream callString;
+    callString << parserExec << " " << taskFileName << " ./"
+               << parserOut << " " << parserOptions;
+    // The parser writes to the output of the process, so its output is
+    // copied to the output of this thread if the thread has its own (e.g., in
+    // a session of the planner daemon)
+    ostream* threadOutput = Logger::getThreadOutput();
+    string parserLog = parserOut + ".log";
+    if (threadOutput) {
+        callString << " > " << parserLog << " 2>&1";
+    }
+    int result = std::system(callString.str().c_str());
+    if (threadOutput) {
+        ifstream parserLogFile(parserLog);
+        if (parserLogFile.peek() != EOF) {
+            *threadOutput << parserLogFile.rdbuf();
+        }
+        parserLogFile.close();
+        remove(parserLog.c_str());
+    }
+    if (result != 0) {
+        SystemUtils::abort("Error: " + parserExec + " had an error");
+    }
+
+    // The output is written to the cache with its key and then moved there
+    // atomically, so concurrent sessions never read incomplete files (an
+    // entry with the same hash value but a different key is replaced)
+    if (!cachedParserOut.empty()) {
+        string tmpCacheFile = parserOut + ".cache";
+        ofstream cacheFile(tmpCacheFile);
+        cacheFile << cacheHeader << ifstream(parserOut).rdbuf();
+        cacheFile.close();
+        if (!cacheFile || (rename(tmpCacheFile.c_str(),
+                                  cachedParserOut.c_str()) != 0)) {
+            remove(tmpCacheFile.c_str());
+        }
+    }
+
+    Parser parser(parserOut, task);
+    parser.parseTask(stateVariableIndices, stateVariableValues);
+
+    // Remove temporary files
+    if ((remove(taskFileName.c_str()) != 0) ||
+        (remove(parserOut.c_str()) != 0)) {
+        SystemUtils::abort("Error: deleting temporary file failed");
     }
 }
 
@@ -235,7 +399,7 @@ void Parser::parseActionFluent(stringstream& desc) const {
         replace(value.begin(), value.end(), '~', ' ');
         values.push_back(value);
     }
-    SearchEngine::actionFluents.push_back(
+    task.actionFluents.push_back(
         new ActionFluent(index, name, isFDR, values));
 }
 
@@ -281,28 +445,28 @@ void Parser::parseCPF(stringstream& desc, vector<string>& deterministicFormulas,
     if (isProbabilistic) {
         ProbabilisticStateFluent* sf =
             new ProbabilisticStateFluent(index, name, values);
-        SearchEngine::stateFluents.push_back(sf);
+        task.stateFluents.push_back(sf);
 
         ProbabilisticCPF* probCPF = new ProbabilisticCPF(hashIndex, sf);
         DeterministicCPF* detCPF = new DeterministicCPF(hashIndex, sf);
         parseCachingType(desc, probCPF, detCPF);
         parseActionHashKeyMap(desc, probCPF, detCPF);
 
-        SearchEngine::probabilisticCPFs.push_back(probCPF);
-        SearchEngine::allCPFs.push_back(probCPF);
+        task.probabilisticCPFs.push_back(probCPF);
+        task.allCPFs.push_back(probCPF);
 
-        SearchEngine::determinizedCPFs.push_back(detCPF);
+        task.determinizedCPFs.push_back(detCPF);
     } else {
         DeterministicStateFluent* sf =
             new DeterministicStateFluent(index, name, values);
-        SearchEngine::stateFluents.push_back(sf);
+        task.stateFluents.push_back(sf);
 
         DeterministicCPF* cpf = new DeterministicCPF(hashIndex, sf);
         parseCachingType(desc, nullptr, cpf);
         parseActionHashKeyMap(desc, nullptr, cpf);
 
-        SearchEngine::deterministicCPFs.push_back(cpf);
-        SearchEngine::allCPFs.push_back(cpf);
+        task.deterministicCPFs.push_back(cpf);
+        task.allCPFs.push_back(cpf);
     }
 }
 
@@ -325,11 +489,11 @@ void Parser::parseRewardFunction(stringstream& desc) const {
     int hashIndex;
     desc >> hashIndex;
 
-    SearchEngine::rewardCPF = new RewardFunction(
+    task.rewardCPF = new RewardFunction(
         rewardFormula, hashIndex, minVal, maxVal, actionIndependent);
 
-    parseCachingType(desc, nullptr, SearchEngine::rewardCPF);
-    parseActionHashKeyMap(desc, nullptr, SearchEngine::rewardCPF);
+    parseCachingType(desc, nullptr, task.rewardCPF);
+    parseActionHashKeyMap(desc, nullptr, task.rewardCPF);
 }
 
 void Parser::parseActionPrecondition(stringstream& desc) const {
@@ -352,8 +516,8 @@ void Parser::parseActionPrecondition(stringstream& desc) const {
     DeterministicEvaluatable* precond =
         new DeterministicEvaluatable(name.str(), formula, hashIndex);
 
-    assert(SearchEngine::actionPreconditions.size() == index);
-    SearchEngine::actionPreconditions.push_back(precond);
+    assert(task.actionPreconditions.size() == index);
+    task.actionPreconditions.push_back(precond);
 
     parseCachingType(desc, nullptr, precond);
     parseActionHashKeyMap(desc, nullptr, precond);
@@ -428,13 +592,19 @@ void Parser::parseCachingType(stringstream& desc,
         int cachingVecSize;
         desc >> cachingVecSize;
 
+        // Kleene results of CPFs with small domains are cached as bitsets
+        Evaluatable* kleeneEval = detEval;
         if (probEval) {
-            probEval->kleeneCachingType = Evaluatable::VECTOR;
-            probEval->kleeneEvaluationCacheVector.resize(cachingVecSize);
+            kleeneEval = probEval;
             detEval->kleeneCachingType = Evaluatable::NONE;
+        }
+        kleeneEval->kleeneCachingType = Evaluatable::VECTOR;
+        int domainSize = kleeneEval->getDomainSize();
+        if ((domainSize > 0) &&
+            (domainSize <= KleeneState::maxBitsetDomainSize)) {
+            kleeneEval->kleeneBitsCacheVector.resize(cachingVecSize, 0);
         } else {
-            detEval->kleeneCachingType = Evaluatable::VECTOR;
-            detEval->kleeneEvaluationCacheVector.resize(cachingVecSize);
+            kleeneEval->kleeneEvaluationCacheVector.resize(cachingVecSize);
         }
     } else {
         assert(cachingType == "MAP");
@@ -452,12 +622,12 @@ void Parser::parseCachingType(stringstream& desc,
 void Parser::parseActionHashKeyMap(stringstream& desc,
                                    ProbabilisticEvaluatable* probEval,
                                    DeterministicEvaluatable* detEval) const {
-    detEval->actionHashKeyMap.resize(SearchEngine::numberOfActions);
+    detEval->actionHashKeyMap.resize(task.numberOfActions);
     if (probEval) {
-        probEval->actionHashKeyMap.resize(SearchEngine::numberOfActions);
+        probEval->actionHashKeyMap.resize(task.numberOfActions);
     }
 
-    for (size_t i = 0; i < SearchEngine::numberOfActions; ++i) {
+    for (size_t i = 0; i < task.numberOfActions; ++i) {
         int actionIndex;
         desc >> actionIndex;
         assert(actionIndex == i);
@@ -472,8 +642,8 @@ void Parser::parseActionState(stringstream& desc) const {
     int index;
     desc >> index;
 
-    vector<int> values(SearchEngine::actionFluents.size());
-    for (size_t j = 0; j < SearchEngine::actionFluents.size(); ++j) {
+    vector<int> values(task.actionFluents.size());
+    for (size_t j = 0; j < task.actionFluents.size(); ++j) {
         desc >> values[j];
     }
 
@@ -486,33 +656,33 @@ void Parser::parseActionState(stringstream& desc) const {
         int precondIndex;
         desc >> precondIndex;
         relevantPreconditions[j] =
-            SearchEngine::actionPreconditions[precondIndex];
+            task.actionPreconditions[precondIndex];
     }
 
-    SearchEngine::actionStates.push_back(ActionState(
+    task.actionStates.push_back(ActionState(
         index, values, relevantPreconditions));
 }
 
 void Parser::parseHashKeys(stringstream& desc) const {
-    for (size_t i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
+    State::Layout& stateLayout = task.stateLayout;
+    KleeneState::Layout& kleeneStateLayout = task.kleeneStateLayout;
+
+    for (size_t i = 0; i < State::numberOfDeterministicStateFluents(); ++i) {
         int index;
         desc >> index;
         assert(index == i);
 
-        if (State::stateHashingPossible) {
-            State::stateHashKeysOfDeterministicStateFluents[index].resize(
-                SearchEngine::deterministicCPFs[index]->head->values.size());
-            for (size_t j = 0;
-                 j <
-                 SearchEngine::deterministicCPFs[index]->head->values.size();
-                 ++j) {
-                desc >>
-                    State::stateHashKeysOfDeterministicStateFluents[index][j];
+        if (State::stateHashingPossible()) {
+            vector<long>& hashKeys =
+                stateLayout.stateHashKeysOfDeterministicStateFluents[index];
+            hashKeys.resize(task.deterministicCPFs[index]->head->values.size());
+            for (size_t j = 0; j < hashKeys.size(); ++j) {
+                desc >> hashKeys[j];
             }
         }
 
-        if (KleeneState::stateHashingPossible) {
-            desc >> KleeneState::hashKeyBases[index];
+        if (kleeneStateLayout.stateHashingPossible) {
+            desc >> kleeneStateLayout.hashKeyBases[index];
         }
 
         int numberOfKeys;
@@ -521,7 +691,7 @@ void Parser::parseHashKeys(stringstream& desc) const {
             int var;
             long key;
             desc >> var >> key;
-            State::stateFluentHashKeysOfDeterministicStateFluents[index]
+            stateLayout.stateFluentHashKeysOfDeterministicStateFluents[index]
                 .push_back(make_pair(var, key));
         }
 
@@ -530,31 +700,28 @@ void Parser::parseHashKeys(stringstream& desc) const {
             int var;
             long key;
             desc >> var >> key;
-            KleeneState::indexToStateFluentHashKeyMap[index].push_back(
+            kleeneStateLayout.indexToStateFluentHashKeyMap[index].push_back(
                 make_pair(var, key));
         }
     }
 
-    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
+    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents(); ++i) {
         int index;
         desc >> index;
         assert(index == i);
 
-        if (State::stateHashingPossible) {
-            State::stateHashKeysOfProbabilisticStateFluents[index].resize(
-                SearchEngine::probabilisticCPFs[index]->head->values.size());
-            for (size_t j = 0;
-                 j <
-                 SearchEngine::probabilisticCPFs[index]->head->values.size();
-                 ++j) {
-                desc >>
-                    State::stateHashKeysOfProbabilisticStateFluents[index][j];
+        if (State::stateHashingPossible()) {
+            vector<long>& hashKeys =
+                stateLayout.stateHashKeysOfProbabilisticStateFluents[index];
+            hashKeys.resize(task.probabilisticCPFs[index]->head->values.size());
+            for (size_t j = 0; j < hashKeys.size(); ++j) {
+                desc >> hashKeys[j];
             }
         }
 
-        if (KleeneState::stateHashingPossible) {
-            desc >> KleeneState::hashKeyBases
-                        [index + State::numberOfDeterministicStateFluents];
+        if (kleeneStateLayout.stateHashingPossible) {
+            desc >> kleeneStateLayout.hashKeyBases
+                        [index + State::numberOfDeterministicStateFluents()];
         }
 
         int numberOfKeys;
@@ -563,7 +730,7 @@ void Parser::parseHashKeys(stringstream& desc) const {
             int var;
             long key;
             desc >> var >> key;
-            State::stateFluentHashKeysOfProbabilisticStateFluents[index]
+            stateLayout.stateFluentHashKeysOfProbabilisticStateFluents[index]
                 .push_back(make_pair(var, key));
         }
 
@@ -572,34 +739,64 @@ void Parser::parseHashKeys(stringstream& desc) const {
             int var;
             long key;
             desc >> var >> key;
-            KleeneState::indexToStateFluentHashKeyMap
-                [index + State::numberOfDeterministicStateFluents]
+            kleeneStateLayout.indexToStateFluentHashKeyMap
+                [index + State::numberOfDeterministicStateFluents()]
                     .push_back(make_pair(var, key));
         }
     }
 }
 
+void Parser::createZobristKeys() const {
+    // The parser does not create state hash keys if their product overflows,
+    // so states are hashed with Zobrist keys instead. A fixed seed is used,
+    // so the hash values of states do not differ between runs.
+    State::Layout& stateLayout = task.stateLayout;
+    Xoshiro256 generator(0x5eed);
+
+    stateLayout.zobristKeysOfDeterministicStateFluents.resize(
+        State::numberOfDeterministicStateFluents());
+    for (size_t i = 0; i < State::numberOfDeterministicStateFluents(); ++i) {
+        vector<uint64_t>& zobristKeys =
+            stateLayout.zobristKeysOfDeterministicStateFluents[i];
+        zobristKeys.resize(task.deterministicCPFs[i]->head->values.size());
+        for (uint64_t& key : zobristKeys) {
+            key = generator();
+        }
+    }
+
+    stateLayout.zobristKeysOfProbabilisticStateFluents.resize(
+        State::numberOfProbabilisticStateFluents());
+    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents(); ++i) {
+        vector<uint64_t>& zobristKeys =
+            stateLayout.zobristKeysOfProbabilisticStateFluents[i];
+        zobristKeys.resize(task.probabilisticCPFs[i]->head->values.size());
+        for (uint64_t& key : zobristKeys) {
+            key = generator();
+        }
+    }
+}
+
 void Parser::parseTrainingSet(stringstream& desc) const {
     int numberOfTrainingStates;
     desc >> numberOfTrainingStates;
     for (size_t i = 0; i < numberOfTrainingStates; ++i) {
         vector<double> valuesOfDeterministicStateFluents(
-            State::numberOfDeterministicStateFluents);
-        for (size_t j = 0; j < State::numberOfDeterministicStateFluents; ++j) {
+            State::numberOfDeterministicStateFluents());
+        for (size_t j = 0; j < valuesOfDeterministicStateFluents.size(); ++j) {
             desc >> valuesOfDeterministicStateFluents[j];
         }
 
         vector<double> valuesOfProbabilisticStateFluents(
-            State::numberOfProbabilisticStateFluents);
-        for (size_t j = 0; j < State::numberOfProbabilisticStateFluents; ++j) {
+            State::numberOfProbabilisticStateFluents());
+        for (size_t j = 0; j < valuesOfProbabilisticStateFluents.size(); ++j) {
             desc >> valuesOfProbabilisticStateFluents[j];
         }
 
         State trainingState(valuesOfDeterministicStateFluents,
                             valuesOfProbabilisticStateFluents,
-                            SearchEngine::horizon);
+                            task.horizon);
         State::calcStateFluentHashKeys(trainingState);
         State::calcStateHashKey(trainingState);
-        SearchEngine::trainingSet.push_back(trainingState);
+        task.trainingSet.push_back(trainingState);
     }
 }
@@ -17,13 +17,31 @@ class State;
 
 class Parser {
 public:
-    Parser(std::string _problemFileName) : problemFileName(_problemFileName) {}
+    Parser(std::string _problemFileName, PlanningTask& _task)
+        : problemFileName(_problemFileName), task(_task) {}
 
+    // Parses the task description into task (which is made the active task
+    // of the calling thread)
     void parseTask(std::map<std::string, int>& stateVariableIndices,
                    std::vector<std::vector<std::string>>& stateVariableValues);
 
+    // Runs the external RDDL parser on the given task description and parses
+    // the resulting task into task
+    static void parseRDDLTask(
+        PlanningTask& task, std::string const& taskDesc,
+        std::string const& parserOptions,
+        std::map<std::string, int>& stateVariableIndices,
+        std::vector<std::vector<std::string>>& stateVariableValues);
+
+    // If this is not empty, the output of the external parser is stored in
+    // this directory, and the parser is not run again on a task description
+    // whose output is there if the parser options and the parser executable
+    // (including its build) are the same
+    static std::string cacheDirectory;
+
 private:
     std::string problemFileName;
+    PlanningTask& task;
 
     inline void parseActionFluent(std::stringstream& desc) const;
     inline void parseCPF(std::stringstream& desc,
@@ -41,6 +59,7 @@ private:
                                       DeterministicEvaluatable* detEval) const;
     inline void parseActionState(std::stringstream& desc) const;
     inline void parseHashKeys(std::stringstream& desc) const;
+    inline void createZobristKeys() const;
     inline void parseTrainingSet(std::stringstream& desc) const;
 };
 
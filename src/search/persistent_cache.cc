@@ -0,0 +1,356 @@
+#include "persistent_cache.h"
+
+#include "planning_task.h"
+#include "search_engine.h"
+
+#include "utils/logger.h"
+#include "utils/math_utils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+// The names of the caches of the task
+string const probabilisticStateValues = "probabilisticStateValueCache";
+string const deterministicStateValues = "deterministicStateValueCache";
+string const rewardLocks = "rewardLockCache";
+
+char const magic[8] = {'P', 'R', 'O', 'S', 'T', 'P', 'C', '2'};
+
+struct FileHeader {
+    char magic[8];
+    uint64_t taskHash;
+    uint64_t configHash;
+    uint64_t numberOfStateFluents;
+    uint64_t numberOfValues;
+    uint64_t numberOfRecords;
+};
+
+// A record consists of the hash of the name of its cache, the number of
+// remaining steps of its state, the number of its values, the values of the
+// state fluents and the values (padded to the maximal number of values)
+size_t const numberOfRecordHeaderWords = 3;
+
+// The FNV-1a hash function is used since the hashes are stored in the file,
+// so they must not differ between builds
+uint64_t hashString(string const& s,
+                    uint64_t hash = 14695981039346656037ULL) {
+    for (char c : s) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Creates a temporary file with a unique name in the directory of fileName
+// (which is accessible to the owner and readable by everyone else like the
+// files that replace it) and returns its file descriptor, or -1 on failure
+int createTemporaryFile(string const& fileName, string& tmpFileName) {
+    tmpFileName = fileName + ".XXXXXX";
+    int fd = mkstemp(&tmpFileName[0]);
+    if ((fd >= 0) && (fchmod(fd, 0644) != 0)) {
+        close(fd);
+        unlink(tmpFileName.c_str());
+        return -1;
+    }
+    return fd;
+}
+
+void loadBDD(string fileName, bdd& cachedBDD) {
+    if (access(fileName.c_str(), R_OK) != 0) {
+        return;
+    }
+    bdd loaded;
+    if (bdd_fnload(&fileName[0], loaded) == 0) {
+        cachedBDD |= loaded;
+    } else {
+        Logger::logWarning("Could not read BDD from " + fileName);
+    }
+}
+
+void storeBDD(string fileName, bdd const& cachedBDD) {
+    // Like the records, the BDD is written to a temporary file first
+    string tmpFileName;
+    int fd = createTemporaryFile(fileName, tmpFileName);
+    if (fd >= 0) {
+        close(fd);
+        if ((bdd_fnsave(&tmpFileName[0], cachedBDD) == 0) &&
+            (rename(tmpFileName.c_str(), fileName.c_str()) == 0)) {
+            return;
+        }
+        unlink(tmpFileName.c_str());
+    }
+    Logger::logWarning("Could not write BDD to " + fileName);
+}
+} // namespace
+
+void PersistentCache::load(PlanningTask& task, SearchEngine* searchEngine) {
+    long numberOfRecords =
+        readRecords(task, hashString(searchEngine->getCacheConfig()));
+    if (numberOfRecords < 0) {
+        Logger::logLine("No persistent cache for this task and configuration "
+                        "in " + fileName, Verbosity::NORMAL);
+        return;
+    }
+
+    for (Entry const& entry : getEntries(probabilisticStateValues)) {
+        task.probabilisticCaches.stateValueCache[entry.state] =
+            entry.values[0];
+    }
+    for (Entry const& entry : getEntries(deterministicStateValues)) {
+        task.deterministicCaches.stateValueCache[entry.state] =
+            entry.values[0];
+    }
+    for (Entry const& entry : getEntries(rewardLocks)) {
+        task.rewardLockCache[entry.state] =
+            MathUtils::doubleIsEqual(entry.values[0], 1.0);
+    }
+    searchEngine->loadCaches(*this);
+
+    // The BDDs are only used if they have been initialized for this task. The
+    // files refer to the BDD variables by index, so they are only used by a
+    // task whose blocks are the first ones of the process.
+    if (!task.bddVariables.empty() && (task.firstBDDBlock == 0)) {
+        lock_guard<mutex> lock(PlanningTask::bddMutex);
+        loadBDD(fileName + ".deadends", task.cachedDeadEnds);
+        loadBDD(fileName + ".goals", task.cachedGoals);
+    }
+
+    entries.clear();
+
+    Logger::logLine("Loaded " + to_string(numberOfRecords) +
+                    " entries from persistent cache " + fileName,
+                    Verbosity::NORMAL);
+}
+
+void PersistentCache::store(PlanningTask const& task,
+                            SearchEngine const* searchEngine) {
+    entries.clear();
+    PlanningTask::SearchCaches const& probCaches = task.probabilisticCaches;
+    for (auto const& [state, value] : probCaches.stateValueCache) {
+        addEntry(probabilisticStateValues, state, {value});
+    }
+    PlanningTask::SearchCaches const& detCaches = task.deterministicCaches;
+    for (auto const& [state, value] : detCaches.stateValueCache) {
+        addEntry(deterministicStateValues, state, {value});
+    }
+    for (auto const& [state, isRewardLock] : task.rewardLockCache) {
+        addEntry(rewardLocks, state, {isRewardLock ? 1.0 : 0.0});
+    }
+    searchEngine->storeCaches(*this);
+
+    if (!writeRecords(task, hashString(searchEngine->getCacheConfig()))) {
+        Logger::logWarning("Could not write persistent cache " + fileName);
+        return;
+    }
+    if (!task.bddVariables.empty() && (task.firstBDDBlock == 0)) {
+        lock_guard<mutex> lock(PlanningTask::bddMutex);
+        storeBDD(fileName + ".deadends", task.cachedDeadEnds);
+        storeBDD(fileName + ".goals", task.cachedGoals);
+    }
+
+    size_t numberOfRecords = 0;
+    for (auto const& cacheEntries : entries) {
+        numberOfRecords += cacheEntries.second.size();
+    }
+    Logger::logLine("Stored " + to_string(numberOfRecords) +
+                    " entries in persistent cache " + fileName,
+                    Verbosity::NORMAL);
+}
+
+vector<PersistentCache::Entry> const& PersistentCache::getEntries(
+    string const& cacheName) const {
+    static vector<Entry> const noEntries;
+    auto it = entries.find(hashString(cacheName));
+    if (it == entries.end()) {
+        return noEntries;
+    }
+    return it->second;
+}
+
+void PersistentCache::addEntry(string const& cacheName, State const& state,
+                               vector<double> const& values) {
+    entries[hashString(cacheName)].emplace_back(state, values);
+}
+
+uint64_t PersistentCache::computeTaskHash(PlanningTask const& task) {
+    stringstream ss;
+    ss << task.taskName << " " << task.horizon << endl;
+    for (Evaluatable const* cpf : task.allCPFs) {
+        ss << cpf->name << ": ";
+        cpf->formula->print(ss);
+        ss << endl;
+    }
+    task.rewardCPF->formula->print(ss);
+    ss << endl;
+    for (Evaluatable const* precond : task.actionPreconditions) {
+        precond->formula->print(ss);
+        ss << endl;
+    }
+    for (ActionState const& action : task.actionStates) {
+        ss << action.toCompactString() << endl;
+    }
+    return hashString(ss.str());
+}
+
+long PersistentCache::readRecords(PlanningTask const& task,
+                                  uint64_t configHash) {
+    entries.clear();
+
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat fileStat;
+    if ((fstat(fd, &fileStat) != 0) ||
+        (static_cast<size_t>(fileStat.st_size) < sizeof(FileHeader))) {
+        close(fd);
+        return -1;
+    }
+    size_t fileSize = fileStat.st_size;
+    void* data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+
+    size_t numberOfDetFluents = State::numberOfDeterministicStateFluents();
+    size_t numberOfStateFluents =
+        numberOfDetFluents + State::numberOfProbabilisticStateFluents();
+    size_t numberOfValues = max(task.numberOfActions, 1);
+    size_t recordSize = sizeof(uint64_t) * (numberOfRecordHeaderWords +
+                                            numberOfStateFluents +
+                                            numberOfValues);
+
+    FileHeader const* header = static_cast<FileHeader const*>(data);
+    if ((memcmp(header->magic, magic, sizeof(magic)) != 0) ||
+        (header->taskHash != computeTaskHash(task)) ||
+        (header->configHash != configHash) ||
+        (header->numberOfStateFluents != numberOfStateFluents) ||
+        (header->numberOfValues != numberOfValues) ||
+        (fileSize !=
+         sizeof(FileHeader) + header->numberOfRecords * recordSize)) {
+        munmap(data, fileSize);
+        return -1;
+    }
+
+    long numberOfRecords = header->numberOfRecords;
+    char const* record = static_cast<char const*>(data) + sizeof(FileHeader);
+    for (long index = 0; index < numberOfRecords; ++index) {
+        uint64_t const* words = reinterpret_cast<uint64_t const*>(record);
+        double const* stateValues = reinterpret_cast<double const*>(
+            words + numberOfRecordHeaderWords);
+        double const* values = stateValues + numberOfStateFluents;
+
+        // The file is discarded if a record is corrupt
+        int64_t remainingSteps = static_cast<int64_t>(words[1]);
+        if ((words[2] > numberOfValues) || (remainingSteps < 0) ||
+            (remainingSteps > task.horizon)) {
+            entries.clear();
+            munmap(data, fileSize);
+            return -1;
+        }
+
+        State state(
+            vector<double>(stateValues, stateValues + numberOfStateFluents),
+            static_cast<int>(remainingSteps));
+        State::calcStateFluentHashKeys(state);
+        State::calcStateHashKey(state);
+        entries[words[0]].emplace_back(
+            state, vector<double>(values, values + words[2]));
+        record += recordSize;
+    }
+    munmap(data, fileSize);
+    return numberOfRecords;
+}
+
+bool PersistentCache::writeRecords(PlanningTask const& task,
+                                   uint64_t configHash) const {
+    size_t numberOfDetFluents = State::numberOfDeterministicStateFluents();
+    size_t numberOfStateFluents =
+        numberOfDetFluents + State::numberOfProbabilisticStateFluents();
+    size_t numberOfValues = max(task.numberOfActions, 1);
+    size_t recordSize = sizeof(uint64_t) * (numberOfRecordHeaderWords +
+                                            numberOfStateFluents +
+                                            numberOfValues);
+
+    FileHeader header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.taskHash = computeTaskHash(task);
+    header.configHash = configHash;
+    header.numberOfStateFluents = numberOfStateFluents;
+    header.numberOfValues = numberOfValues;
+    header.numberOfRecords = 0;
+    for (auto const& cacheEntries : entries) {
+        header.numberOfRecords += cacheEntries.second.size();
+    }
+    size_t fileSize = sizeof(FileHeader) + header.numberOfRecords * recordSize;
+
+    // The records are written to a temporary file that replaces the old one,
+    // so the file is never left in an inconsistent state. The temporary file
+    // has a unique name since several sessions (e.g., of the planner daemon)
+    // can store the same persistent cache at the same time.
+    string tmpFileName;
+    int fd = createTemporaryFile(fileName, tmpFileName);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, fileSize) != 0) {
+        close(fd);
+        unlink(tmpFileName.c_str());
+        return false;
+    }
+    void* data =
+        mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        unlink(tmpFileName.c_str());
+        return false;
+    }
+
+    memcpy(data, &header, sizeof(FileHeader));
+    char* record = static_cast<char*>(data) + sizeof(FileHeader);
+    for (auto const& [cacheHash, cacheEntries] : entries) {
+        for (Entry const& entry : cacheEntries) {
+            assert(entry.values.size() <= numberOfValues);
+            memset(record, 0, recordSize);
+            uint64_t* words = reinterpret_cast<uint64_t*>(record);
+            words[0] = cacheHash;
+            words[1] = static_cast<uint64_t>(
+                static_cast<int64_t>(entry.state.stepsToGo()));
+            words[2] = entry.values.size();
+
+            double* stateValues =
+                reinterpret_cast<double*>(words + numberOfRecordHeaderWords);
+            for (size_t i = 0; i < numberOfDetFluents; ++i) {
+                stateValues[i] = entry.state.deterministicStateFluent(i);
+            }
+            double* probStateValues = stateValues + numberOfDetFluents;
+            for (size_t i = 0; i < numberOfStateFluents - numberOfDetFluents;
+                 ++i) {
+                probStateValues[i] = entry.state.probabilisticStateFluent(i);
+            }
+            copy(entry.values.begin(), entry.values.end(),
+                 stateValues + numberOfStateFluents);
+            record += recordSize;
+        }
+    }
+
+    bool success = (msync(data, fileSize, MS_SYNC) == 0);
+    munmap(data, fileSize);
+    if (!success || (rename(tmpFileName.c_str(), fileName.c_str()) != 0)) {
+        unlink(tmpFileName.c_str());
+        return false;
+    }
+    return true;
+}
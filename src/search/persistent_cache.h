@@ -0,0 +1,80 @@
+#ifndef PERSISTENT_CACHE_H
+#define PERSISTENT_CACHE_H
+
+// A PersistentCache keeps what is learned about a task in a session in a file,
+// such that a later session on the same task can warm-start from it. It
+// contains the values of solved states, the results of reward lock detection
+// in concrete states, the BDDs of dead ends and goals and the entries of the
+// caches of search engines (see SearchEngine::storeCaches).
+//
+// The file starts with a header that contains a hash of the task (which is
+// computed from the formulas of the task, so it does not depend on the
+// training set that is created by the parser) and a hash of the configuration
+// of the search engine (see SearchEngine::getCacheConfig, which includes, e.g.,
+// the search depth that IDS has learned), followed by an array of records
+// of fixed size. Each record consists of the hash of the name of the cache it
+// belongs to, a state and the cached values. The file is mapped into memory
+// when it is read and written, and it is discarded if one of the hashes or
+// the size of the records does not match. Since all records are loaded into
+// the caches of the task and the search engines at the start of the session,
+// the file is a plain array and not a hash table, which keeps file access out
+// of the search. The BDDs are written with BuDDy to separate files with the
+// suffixes .deadends and .goals. These files refer to BDD variables by index,
+// so they are only used by the task whose finite domain blocks are the first
+// ones of the process (see PlanningTask::initBDDs).
+
+#include "states.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class PlanningTask;
+class SearchEngine;
+
+class PersistentCache {
+public:
+    PersistentCache(std::string _fileName) : fileName(_fileName) {}
+
+    // Restores the caches of the task and of the search engine from the file,
+    // if it exists and belongs to the task
+    void load(PlanningTask& task, SearchEngine* searchEngine);
+
+    // Writes the caches of the task and of the search engine to the file
+    void store(PlanningTask const& task, SearchEngine const* searchEngine);
+
+    struct Entry {
+        Entry(State const& _state, std::vector<double> const& _values)
+            : state(_state), values(_values) {}
+
+        State state;
+        std::vector<double> values;
+    };
+
+    // Returns the loaded entries of the cache with the given name
+    std::vector<Entry> const& getEntries(std::string const& cacheName) const;
+
+    // Adds an entry of the cache with the given name that is stored
+    void addEntry(std::string const& cacheName, State const& state,
+                  std::vector<double> const& values);
+
+private:
+    // Returns a hash of the task that is independent from the training set
+    static uint64_t computeTaskHash(PlanningTask const& task);
+
+    // Reads the records of the file and returns the number of records, or -1
+    // if there is no file that belongs to the task and the configuration with
+    // the given hash
+    long readRecords(PlanningTask const& task, uint64_t configHash);
+
+    // Writes all entries to the file and returns true if successful
+    bool writeRecords(PlanningTask const& task, uint64_t configHash) const;
+
+    std::string fileName;
+
+    // The entries of all caches, indexed by the hash of the name of the cache
+    std::unordered_map<uint64_t, std::vector<Entry>> entries;
+};
+
+#endif
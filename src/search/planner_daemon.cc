@@ -0,0 +1,223 @@
+#include "planner_daemon.h"
+
+#include "ipc_client.h"
+#include "parser.h"
+
+#include "utils/logger.h"
+#include "utils/strxml.h"
+#include "utils/system_utils.h"
+#include "utils/xml_pull_parser.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+PlannerDaemon::PlannerDaemon(string _directory, unsigned short _port,
+                             int _numberOfWorkers, int _numberOfSessions,
+                             string _hostName, string _plannerDesc,
+                             string _parserOptions)
+    : directory(_directory),
+      port(_port),
+      numberOfWorkers(_numberOfWorkers),
+      numberOfSessions(_numberOfSessions),
+      hostName(_hostName),
+      plannerDesc(_plannerDesc),
+      parserOptions(_parserOptions),
+      acceptingJobs(true) {
+    if (numberOfWorkers <= 0) {
+        numberOfWorkers = max(1u, thread::hardware_concurrency());
+    }
+}
+
+// This destructor is required here to allow forward declaration of IPCClient
+// in header because of usage of unique_ptr
+PlannerDaemon::~PlannerDaemon() = default;
+
+void PlannerDaemon::run() {
+    // The parser output and the persistent caches are stored in files that
+    // are shared by all sessions
+    string cacheDirectory = directory + "/parser-cache";
+    string persistentCacheDirectory = directory + "/persistent-cache";
+    for (string const& dir :
+         {directory, cacheDirectory, persistentCacheDirectory}) {
+        if ((mkdir(dir.c_str(), 0755) == -1) && (errno != EEXIST)) {
+            SystemUtils::abort("Error: couldn't create directory " + dir +
+                               ".");
+        }
+    }
+    Parser::cacheDirectory = cacheDirectory;
+
+    int serverSocket = SystemUtils::listenOnPort(port);
+    Logger::logLine("Planner daemon is listening on port " + to_string(port) +
+                    " with " + to_string(numberOfWorkers) + " workers",
+                    Verbosity::SILENT);
+
+    vector<thread> workers;
+    for (int i = 0; i < numberOfWorkers; ++i) {
+        workers.emplace_back(&PlannerDaemon::runWorker, this);
+    }
+
+    int session = 0;
+    while ((numberOfSessions == 0) || (session < numberOfSessions)) {
+        int jobSocket = ::accept(serverSocket, nullptr, nullptr);
+        if (jobSocket == -1) {
+            continue;
+        }
+        ++session;
+        {
+            lock_guard<std::mutex> lock(mutex);
+            jobs.emplace_back(jobSocket, session);
+        }
+        jobAvailable.notify_one();
+    }
+
+    // Wait until all sessions are finished
+    {
+        lock_guard<std::mutex> lock(mutex);
+        acceptingJobs = false;
+    }
+    jobAvailable.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    close(serverSocket);
+}
+
+void PlannerDaemon::runWorker() {
+    // A failing session must not terminate the daemon (see SystemUtils::abort)
+    SystemUtils::setAbortThrows(true);
+
+    while (true) {
+        pair<int, int> job;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(
+                lock, [this] { return !jobs.empty() || !acceptingJobs; });
+            if (jobs.empty()) {
+                return;
+            }
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        try {
+            runSession(job.first, job.second);
+        } catch (AbortError const&) {
+            // The connection is closed without an answer
+            Logger::setThreadOutput(nullptr);
+            Logger::logLine("Session " + to_string(job.second) + " failed",
+                            Verbosity::SILENT);
+        }
+        close(job.first);
+    }
+}
+
+PlannerDaemon::Instance& PlannerDaemon::getInstance(
+    string const& instanceName) {
+    lock_guard<std::mutex> lock(mutex);
+    unique_ptr<Instance>& instance = instances[instanceName];
+    if (!instance) {
+        instance = unique_ptr<Instance>(new Instance());
+    }
+    return *instance;
+}
+
+void PlannerDaemon::runSession(int socket, int session) {
+    XMLPullParser parser(socket);
+    XMLNode const* request = XMLNode::readNode(parser);
+    string instanceName;
+    if (!request || (request->getName() != "plan-request") ||
+        !request->dissect("instance", instanceName)) {
+        delete request;
+        SystemUtils::abort("Error: plan request insufficient.");
+    }
+    auto readValue = [&](string const& name, string& value) {
+        string s;
+        if (request->dissect(name, s)) {
+            value = string(XMLPullParser::trim(s));
+        }
+    };
+    instanceName = string(XMLPullParser::trim(instanceName));
+    // The instance name is part of the name of the log file, so it must not
+    // refer to a file outside of the directory of the daemon
+    if (instanceName.empty() || (instanceName[0] == '.') ||
+        (instanceName.find('/') != string::npos)) {
+        delete request;
+        SystemUtils::abort("Error: invalid instance name in plan request: " +
+                           instanceName);
+    }
+    string sessionHostName = hostName;
+    readValue("host", sessionHostName);
+    string sessionPort = "2323";
+    readValue("port", sessionPort);
+    string sessionPlannerDesc = plannerDesc;
+    readValue("planner", sessionPlannerDesc);
+    string sessionParserOptions = parserOptions;
+    readValue("parser-options", sessionParserOptions);
+    delete request;
+
+
+    // Sessions on the same instance share a persistent cache, unless the
+    // planner description specifies one. The option is added after the name
+    // of the planner (which is the first word of the planner description).
+    size_t optionsPos = sessionPlannerDesc.find_first_not_of("[ ");
+    optionsPos = sessionPlannerDesc.find_first_of(" ]", optionsPos);
+    if ((optionsPos != string::npos) &&
+        (sessionPlannerDesc.find(" -pc ") == string::npos)) {
+        string cacheFile = directory + "/persistent-cache/" + instanceName;
+        sessionPlannerDesc.insert(optionsPos, " -pc " + cacheFile);
+    }
+
+    Logger::logLine("Starting session " + to_string(session) + " on " +
+                    instanceName + " with " + sessionHostName + ":" +
+                    sessionPort, Verbosity::SILENT);
+
+    // The output of the session is written to its log file
+    string logFile =
+        directory + "/" + instanceName + "_" + to_string(session) + ".log";
+    ofstream log(logFile);
+    if (!log) {
+        SystemUtils::abort("Error: couldn't create log file " + logFile + ".");
+    }
+    Logger::setThreadOutput(&log);
+
+    // Sessions on the same instance wait until the client of the instance is
+    // available
+    Instance& instance = getInstance(instanceName);
+    lock_guard<std::mutex> instanceLock(instance.mutex);
+    unsigned short serverPort = (unsigned short)(atoi(sessionPort.c_str()));
+    if (!instance.client) {
+        instance.client = unique_ptr<IPCClient>(
+            new IPCClient(sessionHostName, serverPort, sessionParserOptions));
+    } else {
+        instance.client->setServer(sessionHostName, serverPort);
+        instance.client->setParserOptions(sessionParserOptions);
+    }
+    try {
+        instance.client->run(instanceName, sessionPlannerDesc);
+    } catch (AbortError const&) {
+        // The planner of the client may have been interrupted in the middle
+        // of a round, so the client is not used by later sessions
+        instance.client.reset();
+        throw;
+    }
+    Logger::setThreadOutput(nullptr);
+
+    stringstream os;
+    os << "<plan-result>"
+       << "<instance>" << instanceName << "</instance>"
+       << "<total-reward>" << instance.client->getTotalReward()
+       << "</total-reward>"
+       << "</plan-result>" << '\0';
+    if (write(socket, os.str().c_str(), os.str().length()) == -1) {
+        SystemUtils::abort("Error: writing to socket failed.");
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef PLANNER_DAEMON_H
+#define PLANNER_DAEMON_H
+
+/*
+  The planner daemon is a long-lived process that runs the sessions of many
+  episodes, so the task and the planner of an instance are not set up again
+  for every episode (see below). Jobs connect to the daemon on a TCP port
+  and send a plan request, which is an XML message that is terminated by a
+  null character (like the messages of the rddlsim protocol):
+
+    <plan-request>
+      <instance>elevators_inst_mdp__1</instance>
+      <host>localhost</host>
+      <port>2323</port>
+      <planner>[PROST -s 1 -se [IPC2014]]</planner>
+    </plan-request>
+
+  All elements but the instance are optional (the defaults are the host name
+  and planner description the daemon was started with, and port 2323). The
+  daemon runs a session of the IPC client with the rddlsim server and answers
+  with <plan-result><total-reward>...</total-reward></plan-result> when the
+  session is finished. The connection is closed without an answer if the
+  session fails or if the instance name is not a plain file name (i.e., if it
+  is empty, starts with a dot or contains a slash).
+
+  Sessions are run by a pool of worker threads of fixed size, so everything
+  that is set up for an instance is kept in the daemon: the client of the
+  sessions on an instance keeps the parsed task (with the caches of its
+  search engines, e.g., the values of solved states and the results of reward
+  lock detection) and the planner of each planner description (with its
+  search engine and everything it has learned, e.g., the search depth of IDS)
+  after a session, and later sessions on the instance reuse them (see
+  IPCClient::run). Since they share the client, sessions on the same
+  instance run one after another, while sessions on different instances run
+  concurrently. The task is parsed again if the server sends a different
+  task description or if different parser options are requested, and the
+  client of an instance is discarded if a session on the instance fails.
+  Clients are never discarded otherwise, so the memory of the daemon grows
+  with the number of instances, and the RAM limit of the planners (-ram) is
+  compared with the RAM that is used by the whole daemon.
+
+  The output of the RDDL parser is cached in the directory of the daemon, so
+  the parser only runs once per task even if the daemon is restarted. Unless
+  the planner description of a session specifies a persistent cache (with
+  -pc), the sessions on an instance also share the persistent cache
+  persistent-cache/<instance> in the directory of the daemon (see
+  persistent_cache.h), which restores the caches of a task after a restart
+  of the daemon. The output of each session is written to a log file in the
+  directory of the daemon.
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+class IPCClient;
+
+class PlannerDaemon {
+public:
+    PlannerDaemon(std::string _directory, unsigned short _port,
+                  int _numberOfWorkers, int _numberOfSessions,
+                  std::string _hostName, std::string _plannerDesc,
+                  std::string _parserOptions);
+    ~PlannerDaemon();
+
+    void run();
+
+private:
+    // The client of the sessions on an instance, which is only used by one
+    // session at a time
+    struct Instance {
+        std::mutex mutex;
+        std::unique_ptr<IPCClient> client;
+    };
+
+    // Runs the sessions of the jobs in the queue until the daemon stops
+    // accepting jobs and the queue is empty (this is run by each worker)
+    void runWorker();
+
+    // Handles the plan request of the job that is connected via socket
+    void runSession(int socket, int session);
+
+    // Returns the instance with the given name (which is created if the
+    // daemon has no client for it yet)
+    Instance& getInstance(std::string const& instanceName);
+
+    // The directory where the parser cache and the session logs are written
+    std::string directory;
+    unsigned short port;
+    int numberOfWorkers;
+    // The daemon terminates after this many sessions (no limit if this is 0)
+    int numberOfSessions;
+
+    // The defaults of plan requests
+    std::string hostName;
+    std::string plannerDesc;
+    std::string parserOptions;
+
+    // The queue of accepted jobs (the socket of the job and the number of its
+    // session) and the instances, which are guarded by mutex
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::deque<std::pair<int, int>> jobs;
+    bool acceptingJobs;
+    std::map<std::string, std::unique_ptr<Instance>> instances;
+};
+
+#endif // PLANNER_DAEMON_H
@@ -0,0 +1,429 @@
+#include "planning_task.h"
+
+#include "utils/logger.h"
+#include "utils/math_utils.h"
+#include "utils/system_utils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+mutex PlanningTask::bddMutex;
+
+PlanningTask::PlanningTask()
+    : rewardCPF(nullptr),
+      taskIsDeterministic(true),
+      horizon(numeric_limits<int>::max()),
+      discountFactor(1.0),
+      numberOfActions(-1),
+      cacheApplicableActions(true),
+      actionEquivalenceKeysPossible(false),
+      hasUnreasonableActions(true),
+      determinizationHasUnreasonableActions(true),
+      rewardLockDetected(true),
+      goalTestActionIndex(-1),
+      cachedDeadEnds(bddfalse),
+      cachedGoals(bddfalse),
+      firstBDDBlock(-1),
+      probabilisticCaches(62233, 520241),
+      deterministicCaches(520241, 520241),
+      rewardLockCache(62233),
+      rnd(MathUtils::createRNGStream()) {}
+
+PlanningTask::~PlanningTask() {
+    if (activeTask == this) {
+        activeTask = nullptr;
+        State::setLayout(nullptr);
+        KleeneState::setLayout(nullptr);
+    }
+
+    if (!bddVariables.empty()) {
+        lock_guard<mutex> lock(bddMutex);
+        cachedDeadEnds = bddfalse;
+        cachedGoals = bddfalse;
+    }
+
+    for (Evaluatable* cpf : allCPFs) {
+        delete cpf;
+    }
+    for (DeterministicCPF* cpf : determinizedCPFs) {
+        delete cpf;
+    }
+    delete rewardCPF;
+    for (DeterministicEvaluatable* precond : actionPreconditions) {
+        delete precond;
+    }
+    for (StateFluent* sf : stateFluents) {
+        delete sf;
+    }
+    for (ActionFluent* af : actionFluents) {
+        delete af;
+    }
+}
+
+void PlanningTask::activate() {
+    activeTask = this;
+    State::setLayout(&stateLayout);
+    KleeneState::setLayout(&kleeneStateLayout);
+}
+
+/******************************************************************
+                   Action Equivalence and BDDs
+******************************************************************/
+
+void PlanningTask::initBDDs() {
+    if (!bddVariables.empty()) {
+        return;
+    }
+
+    // BuDDy encodes the values of a state variable with a domain of size n in
+    // max(1, ceil(log2(n))) BDD variables
+    vector<int> domains(kleeneStateLayout.stateSize);
+    int numberOfBDDVariables = 0;
+    for (size_t index = 0; index < allCPFs.size(); ++index) {
+        domains[index] = allCPFs[index]->getDomainSize();
+        int bits = 1;
+        while ((1 << bits) < domains[index]) {
+            ++bits;
+        }
+        numberOfBDDVariables += bits;
+    }
+
+    lock_guard<mutex> lock(bddMutex);
+    static bool bddsInitialized = false;
+    if (!bddsInitialized) {
+        // The cached BDDs are disjunctions of cubes over all BDD variables, so
+        // we choose the initial size of the node table proportional to the
+        // number of BDD variables (BuDDy grows the node table if necessary,
+        // e.g., when the blocks of further tasks are added)
+        int nodeTableSize = numberOfBDDVariables * 10000;
+        nodeTableSize = std::max(nodeTableSize, 100000);
+        nodeTableSize = std::min(nodeTableSize, 5000000);
+        int cacheSize = std::max(nodeTableSize / 50, 20000);
+        bdd_init(nodeTableSize, cacheSize);
+        bdd_setmaxincrease(nodeTableSize);
+        bddsInitialized = true;
+    }
+    firstBDDBlock = fdd_extdomain(domains.data(), kleeneStateLayout.stateSize);
+    if (firstBDDBlock < 0) {
+        SystemUtils::abort("Error: creating the BDD variables of " + taskName +
+                           " failed.");
+    }
+
+    bddVariables.assign(bdd_varnum(), make_pair(-1, -1));
+    for (int index = 0; index < kleeneStateLayout.stateSize; ++index) {
+        int* vars = fdd_vars(firstBDDBlock + index);
+        for (int bit = 0; bit < fdd_varnum(firstBDDBlock + index); ++bit) {
+            bddVariables[vars[bit]] = make_pair(index, bit);
+        }
+    }
+}
+
+void PlanningTask::determineActionDependentEvaluatables() {
+    actionDependentHashIndices.clear();
+    actionEquivalenceKeysPossible = true;
+
+    auto addEvaluatable = [this](Evaluatable const* eval) {
+        actionDependentHashIndices.push_back(eval->hashIndex);
+        if (eval->cachingType == Evaluatable::NONE) {
+            actionEquivalenceKeysPossible = false;
+        }
+    };
+
+    // CPFs where all actions have the same action hash key cannot distinguish
+    // between actions, so they are irrelevant for action equivalence
+    for (Evaluatable const* cpf : allCPFs) {
+        if (any_of(cpf->actionHashKeyMap.begin(), cpf->actionHashKeyMap.end(),
+                   [](long key) { return key != 0; })) {
+            addEvaluatable(cpf);
+        }
+    }
+    for (DeterministicEvaluatable const* precond : actionPreconditions) {
+        addEvaluatable(precond);
+    }
+}
+
+/******************************************************************
+                              Printing
+******************************************************************/
+
+void PlanningTask::print() const {
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout.precision(std::numeric_limits<double>::digits10);
+
+    Logger::logLine("----------------Actions---------------");
+    Logger::logLine();
+    Logger::logLine("Action fluents:");
+    for (ActionFluent const* af : actionFluents) {
+        Logger::logLine(af->name);
+    }
+    Logger::logSmallSeparator();
+    Logger::logLine();
+    Logger::logLine("Legal Action Combinations:");
+    for (ActionState const& state : actionStates) {
+        Logger::logLine(state.toString());
+        Logger::logSmallSeparator();
+    }
+
+    Logger::logLine();
+    Logger::logLine("-----------------CPFs-----------------");
+    Logger::logLine();
+
+    int numDetStateFluents = stateLayout.numberOfDeterministicStateFluents;
+    for (size_t index = 0; index < numDetStateFluents; ++index) {
+        printDeterministicCPFInDetail(index);
+        Logger::logSmallSeparator();
+    }
+
+    int numProbStateFluents = stateLayout.numberOfProbabilisticStateFluents;
+    for (size_t index = 0; index < numProbStateFluents; ++index) {
+        printProbabilisticCPFInDetail(index);
+        Logger::logSmallSeparator();
+    }
+    Logger::logLine();
+
+    Logger::logLine("Reward CPF:");
+    printRewardCPFInDetail();
+
+    Logger::logLine();
+    Logger::logLine("------State Fluent Hash Key Map-------");
+    Logger::logLine();
+
+    for (size_t index = 0; index < numDetStateFluents; ++index) {
+        Logger::log("a change of deterministic state fluent " +
+                    to_string(index) + " influences variables ");
+        vector<pair<int, long>> const& influencedVars =
+            stateLayout.stateFluentHashKeysOfDeterministicStateFluents[index];
+
+        for (pair<int, long> const& influencedVar : influencedVars) {
+            Logger::log(to_string(influencedVar.first) + " (" +
+                        to_string(influencedVar.second) + ") ");
+        }
+        Logger::logLine();
+    }
+    Logger::logLine();
+
+    for (size_t index = 0; index < numProbStateFluents; ++index) {
+        Logger::log("a change of probabilistic state fluent " +
+                    to_string(index) + " influences variables ");
+        vector<pair<int, long>> const& influencedVars =
+            stateLayout.stateFluentHashKeysOfProbabilisticStateFluents[index];
+
+        for (pair<int, long> const& influencedVar : influencedVars) {
+            Logger::log(to_string(influencedVar.first) + " (" +
+                        to_string(influencedVar.second) + ") ");
+        }
+        Logger::logLine();
+    }
+    Logger::logLine();
+
+    for (size_t index = 0; index < kleeneStateLayout.stateSize; ++index) {
+        Logger::log("a change of variable " + to_string(index) +
+                    " influences variables in Kleene states ");
+        vector<pair<int, long>> const& influencedVars =
+            kleeneStateLayout.indexToStateFluentHashKeyMap[index];
+
+        for (pair<int, long> const& influencedVar : influencedVars) {
+            Logger::log(to_string(influencedVar.first) + " (" +
+                        to_string(influencedVar.second) + ") ");
+        }
+        Logger::logLine();
+    }
+    Logger::logLine();
+
+    Logger::logLine();
+    Logger::logLine("---------Action Preconditions---------");
+    Logger::logLine();
+
+    for (size_t index = 0; index < actionPreconditions.size(); ++index) {
+        printActionPreconditionInDetail(index);
+        Logger::logSmallSeparator();
+    }
+
+    Logger::logLine();
+    Logger::logLine("----------Initial State---------------");
+    Logger::logLine();
+    Logger::logLine(initialState.toString());
+
+    if (stateLayout.stateHashingPossible) {
+        Logger::logLine("Hashing of States is possible.");
+    } else {
+        Logger::logLine("Hashing of States is not possible.");
+    }
+    if (kleeneStateLayout.stateHashingPossible) {
+        Logger::logLine("Hashing of KleeneStates is possible.");
+    } else {
+        Logger::logLine("Hashing of KleeneStates is not possible.");
+    }
+
+
+    if (rewardLockDetected) {
+        if (goalTestActionIndex >= 0) {
+            Logger::logLine(
+                "A goal and a dead end were found in the training phase.");
+        } else {
+            Logger::logLine(
+                "A dead end but no goal was found in the training phase.");
+        }
+    } else {
+        Logger::logLine("No reward locks detected in the training phase.");
+    }
+
+    if (hasUnreasonableActions &&
+        determinizationHasUnreasonableActions) {
+        Logger::logLine("This task contains unreasonable actions.");
+    } else if (hasUnreasonableActions) {
+        assert(false);
+    } else if (determinizationHasUnreasonableActions) {
+        Logger::logLine(
+            "Only the determinization contains unreasonable actions.");
+    } else {
+        Logger::logLine("This task does not contain unreasonable actions.");
+    }
+    Logger::logLine();
+}
+
+void PlanningTask::printDeterministicCPFInDetail(int index) const {
+    printEvaluatableInDetail(deterministicCPFs[index]);
+    Logger::logLine();
+
+    Logger::log("  Domain: ");
+    for (std::string const& val : deterministicCPFs[index]->head->values) {
+        Logger::log(val + " ");
+    }
+    Logger::logLine();
+
+    if (stateLayout.stateHashingPossible) {
+        Logger::log("  HashKeyBase: ");
+        std::vector<long> const& stateHashKeys =
+            stateLayout.stateHashKeysOfDeterministicStateFluents[index];
+        for (size_t i = 0; i < stateHashKeys.size(); ++i) {
+            Logger::log(to_string(i) + ": " + to_string(stateHashKeys[i]));
+            if (i != stateHashKeys.size() - 1) {
+                Logger::log(", ");
+            } else {
+                Logger::logLine();
+            }
+        }
+    }
+
+    if (kleeneStateLayout.stateHashingPossible) {
+        Logger::logLine("  KleeneHashKeyBase: " +
+                    to_string(kleeneStateLayout.hashKeyBases[index]));
+    }
+}
+
+void PlanningTask::printProbabilisticCPFInDetail(int index) const {
+    printEvaluatableInDetail(probabilisticCPFs[index]);
+    Logger::logLine();
+
+    Logger::logLine("  Determinized formula: ");
+
+    // TODO: Replace print() method with toString()
+    stringstream ss;
+    determinizedCPFs[index]->formula->print(ss);
+    ss << endl;
+    Logger::logLine(ss.str());
+
+    Logger::log("  Domain: ");
+    for (std::string const& val : probabilisticCPFs[index]->head->values) {
+        Logger::log(val + " ");
+    }
+    Logger::logLine();
+
+    if (stateLayout.stateHashingPossible) {
+        Logger::log("  HashKeyBase: ");
+        std::vector<long> const& stateHashKeys =
+            stateLayout.stateHashKeysOfProbabilisticStateFluents[index];
+        for (size_t i = 0; i < stateHashKeys.size(); ++i) {
+            Logger::log(to_string(i) + ": " + to_string(stateHashKeys[i]));
+            if (i != stateHashKeys.size() - 1) {
+                Logger::log(", ");
+            } else {
+                Logger::logLine();
+            }
+        }
+    }
+
+    if (kleeneStateLayout.stateHashingPossible) {
+        index += stateLayout.numberOfDeterministicStateFluents;
+        Logger::logLine("  KleeneHashKeyBase: " +
+                    to_string(kleeneStateLayout.hashKeyBases[index]));
+    }
+}
+
+void PlanningTask::printRewardCPFInDetail() const {
+    printEvaluatableInDetail(rewardCPF);
+
+    Logger::logLine("Minimal reward: " + to_string(rewardCPF->getMinVal()));
+    Logger::logLine("Maximal reward: " + to_string(rewardCPF->getMaxVal()));
+    Logger::logLine("Is action independent: " +
+                    to_string(rewardCPF->isActionIndependent()));
+    Logger::logLine();
+}
+
+void PlanningTask::printActionPreconditionInDetail(int index) const {
+    printEvaluatableInDetail(actionPreconditions[index]);
+    Logger::logLine();
+}
+
+void PlanningTask::printEvaluatableInDetail(Evaluatable* eval) const {
+    Logger::logLine(eval->name);
+    Logger::log("  HashIndex: " + to_string(eval->hashIndex) + ",");
+
+    if (!eval->isProbabilistic()) {
+        Logger::log(" deterministic,");
+    } else {
+        Logger::log(" probabilistic,");
+    }
+
+    switch (eval->cachingType) {
+    case Evaluatable::NONE:
+        Logger::log(" no caching,");
+        break;
+    case Evaluatable::MAP:
+    case Evaluatable::DISABLED_MAP:
+        Logger::log(" caching in maps,");
+        break;
+    case Evaluatable::VECTOR:
+        Logger::log(" caching in vectors,");
+        break;
+    }
+
+    switch (eval->kleeneCachingType) {
+    case Evaluatable::NONE:
+        Logger::log(" no Kleene caching.");
+        break;
+    case Evaluatable::MAP:
+    case Evaluatable::DISABLED_MAP:
+        Logger::log(" Kleene caching in maps.");
+        break;
+    case Evaluatable::VECTOR:
+        Logger::log(" Kleene caching in vectors of size " +
+                    to_string(eval->kleeneEvaluationCacheVector.size()) + ".");
+        break;
+    }
+    Logger::logLine();
+    Logger::logLine();
+
+    if (!eval->actionHashKeyMap.empty()) {
+        Logger::logLine("  Action Hash Key Map:");
+        for (size_t i = 0; i < eval->actionHashKeyMap.size(); ++i) {
+            if (eval->actionHashKeyMap[i] != 0) {
+                Logger::logLine("    " + actionStates[i].toCompactString() +
+                                " : " + to_string(eval->actionHashKeyMap[i]));
+            }
+        }
+    } else {
+        Logger::logLine("  Has no positive dependencies on actions.");
+    }
+
+    // TODO: Replace print() method with toString()
+    stringstream ss;
+    ss << "  Formula: " << endl;
+    eval->formula->print(ss);
+    Logger::logLine(ss.str());
+}
@@ -0,0 +1,244 @@
+#ifndef PLANNING_TASK_H
+#define PLANNING_TASK_H
+
+// A PlanningTask contains everything that is known about the task that is
+// solved: the evaluatables and action states that are created by the parser,
+// the properties that are derived from them (e.g., the hash keys of states),
+// the caches that are shared among all search engines that solve the task and
+// the random number generator of these search engines. Search engines are
+// given the task they solve when they are created. States use the Layout of
+// the task that is active on the thread where they are used (the active task
+// is also used by the parser and to print states), so different tasks can be
+// solved by different threads of the same process. BuDDy has a single node
+// table per process: each task has its own finite domain blocks in it, and
+// all BDD operations must hold bddMutex.
+
+#include "evaluatables.h"
+#include "heuristic_value_cache.h"
+
+#include "utils/hash.h"
+#include "utils/random.h"
+
+#include <fdd.h>
+
+#include <cassert>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class PlanningTask {
+public:
+    PlanningTask();
+
+    // Deletes the evaluatables, fluents and cached BDDs of this task and
+    // deactivates it if it is the active task of the calling thread
+    ~PlanningTask();
+
+    PlanningTask(PlanningTask const&) = delete;
+    PlanningTask& operator=(PlanningTask const&) = delete;
+
+    // Makes this the active task of the calling thread
+    void activate();
+
+    // Returns the active task of the calling thread
+    static PlanningTask& active() {
+        assert(activeTask);
+        return *activeTask;
+    }
+
+    // Determines actionDependentHashIndices and actionEquivalenceKeysPossible.
+    // Must be called after the hash keys have been parsed.
+    void determineActionDependentEvaluatables();
+
+    // Creates one finite domain block per state variable of this task. BuDDy
+    // is initialized by the first task of the process that calls this, with a
+    // node table that is adjusted to the size of that task. Calling this again
+    // for the same task has no effect.
+    void initBDDs();
+
+    typedef std::unordered_map<State, double, State::HashWithRemSteps,
+                               State::EqualWithRemSteps>
+        StateValueHashMap;
+    typedef std::unordered_map<State, std::vector<int>,
+                               State::HashWithoutRemSteps,
+                               State::EqualWithoutRemSteps>
+        ActionHashMap;
+
+    struct HashKeyVectorHash {
+        unsigned int operator()(std::vector<long> const& v) const {
+            return utils::hash(v);
+        }
+    };
+    typedef std::unordered_map<std::vector<long>, std::vector<int>,
+                               HashKeyVectorHash>
+        ActionEquivalenceHashMap;
+
+    typedef std::unordered_map<State, bool, State::HashWithoutRemSteps,
+                               State::EqualWithoutRemSteps>
+        RewardLockHashMap;
+
+    // The caches that are shared among all search engines that work on the
+    // original task or on its determinization, respectively
+    struct SearchCaches {
+        SearchCaches(size_t stateValueBuckets, size_t applicableActionsBuckets)
+            : stateValueCache(stateValueBuckets),
+              applicableActionsCache(applicableActionsBuckets) {}
+
+        // Cache for state values of solved states
+        StateValueHashMap stateValueCache;
+
+        // Cache for applicable reasonable actions
+        ActionHashMap applicableActionsCache;
+
+        // Cache for applicable reasonable actions that is shared among all
+        // states with the same action-dependent state fluent hash keys
+        ActionEquivalenceHashMap actionEquivalenceCache;
+    };
+
+    /*****************************************************************
+                                Printing
+    *****************************************************************/
+
+    void print() const;
+    void printDeadEndBDD() const {
+        std::lock_guard<std::mutex> lock(bddMutex);
+        bdd_printdot(cachedDeadEnds);
+    }
+    void printGoalBDD() const {
+        std::lock_guard<std::mutex> lock(bddMutex);
+        bdd_printdot(cachedGoals);
+    }
+
+private:
+    void printEvaluatableInDetail(Evaluatable* eval) const;
+    void printDeterministicCPFInDetail(int index) const;
+    void printProbabilisticCPFInDetail(int index) const;
+    void printRewardCPFInDetail() const;
+    void printActionPreconditionInDetail(int index) const;
+
+    /*****************************************************************
+                             Member variables
+    *****************************************************************/
+
+public:
+    // The name of this task (this is equivalent to the instance name)
+    std::string taskName;
+
+    // The layouts of States and KleeneStates of this task
+    State::Layout stateLayout;
+    KleeneState::Layout kleeneStateLayout;
+
+    // Random set of reachable states (these are used for learning)
+    std::vector<State> trainingSet;
+
+    // Action fluents and action states
+    std::vector<ActionFluent*> actionFluents;
+    std::vector<ActionState> actionStates;
+
+    // State fluents
+    std::vector<StateFluent*> stateFluents;
+
+    // Transition functions of state fluents
+    std::vector<Evaluatable*> allCPFs;
+    std::vector<DeterministicCPF*> deterministicCPFs;
+    std::vector<ProbabilisticCPF*> probabilisticCPFs;
+
+    // Determinized transition functions of probabilistic state fluents
+    std::vector<DeterministicCPF*> determinizedCPFs;
+
+    // The reward formula
+    RewardFunction* rewardCPF;
+
+    // The action preconditions
+    std::vector<DeterministicEvaluatable*> actionPreconditions;
+
+    // Is true if this planning task is deterministic
+    bool taskIsDeterministic;
+
+    // The initial state (the one given in the problem description,
+    // this is not updated)
+    State initialState;
+
+    // The problem horizon
+    int horizon;
+
+    // The problem's discount factor (TODO: This is ignored at the moment)
+    double discountFactor;
+
+    // The number of actions (this is equal to actionStates.size())
+    int numberOfActions;
+
+    // Since the reward is independent from the successor state, we can
+    // calculate the final reward as the maximum of applying all actions in the
+    // current state. Since the set of actions that could maximize the final
+    // reward can be a subset of all actions, we distinguish between several
+    // different methods to speed up this calculation.
+    std::vector<int> candidatesForOptimalFinalAction;
+
+    // Is true if applicable actions should be cached
+    bool cacheApplicableActions;
+
+    // The hash indices of all action preconditions and of all CPFs that
+    // distinguish between actions. If the state fluent hash keys of these
+    // evaluatables are equal in two states, the states have the same
+    // applicable actions and the same pairs of equivalent actions.
+    std::vector<int> actionDependentHashIndices;
+
+    // Is true if the state fluent hash keys of all evaluatables in
+    // actionDependentHashIndices are computed (i.e., if none of them has
+    // caching type NONE), which is required to use them as a key.
+    bool actionEquivalenceKeysPossible;
+
+    // Is true if unreasonable actions where detected during learning in the
+    // task or its determinization
+    bool hasUnreasonableActions;
+    bool determinizationHasUnreasonableActions;
+
+    // Is true if a reward lock was detected in the training phase
+    bool rewardLockDetected;
+
+    // The index of this action is used to check if a state is a goal
+    int goalTestActionIndex;
+
+    // The BDDs where dead ends and goals are cached
+    bdd cachedDeadEnds;
+    bdd cachedGoals;
+
+    // The BDD variable with index i encodes bit bddVariables[i].second of the
+    // value of the state variable with index bddVariables[i].first (this is
+    // empty if initBDDs has not been called, and the variables of the blocks
+    // of other tasks are mapped to (-1, -1))
+    std::vector<std::pair<int, int>> bddVariables;
+
+    // The finite domain block with index firstBDDBlock + i encodes the state
+    // variable with index i
+    int firstBDDBlock;
+
+    // BuDDy's node table is shared by the BDDs of all tasks of the process, so
+    // this lock must be held by all operations on BDDs, including copying and
+    // destroying bdd objects that are not constant
+    static std::mutex bddMutex;
+
+    // The caches of the probabilistic and the deterministic search engines
+    SearchCaches probabilisticCaches;
+    SearchCaches deterministicCaches;
+
+    // Cache for the result of reward lock detection in a concrete state
+    RewardLockHashMap rewardLockCache;
+
+    // Cache for the Q-value estimates of the heuristics of initializers
+    HeuristicValueCache heuristicValueCache;
+
+    // The random number generator of the search engines that solve this task,
+    // which generates the numbers of its own stream (see
+    // MathUtils::createRNGStream) so that tasks that are solved concurrently
+    // are independent of each other
+    RandomXoshiro rnd;
+
+private:
+    static inline thread_local PlanningTask* activeTask = nullptr;
+};
+
+#endif
@@ -42,25 +42,50 @@ string DiscretePD::toString() const {
     return ss.str();
 }
 
-pair<double, double> DiscretePD::sample(vector<int> const& blacklist) const {
+pair<double, double> DiscretePD::sample(RandomXoshiro& rnd,
+                                       OutcomeMask const& blacklist) const {
     assert(isWellDefined());
+    int const numberOfOutcomes = values.size();
+    if (numberOfOutcomes == 1) {
+        assert(!blacklist.contains(0));
+        return std::make_pair(values[0], probabilities[0]);
+    }
+
+    // The probabilities are accumulated while the outcomes are traversed, so
+    // sampling does not require a cumulative array (which would have to be
+    // computed for each distribution, while most are sampled only once)
+    if (blacklist.empty()) {
+        double randNum = rnd.genDouble(0.0, 1.0);
+        double probSum = 0.0;
+        for (int i = 0; i < numberOfOutcomes - 1; ++i) {
+            probSum += probabilities[i];
+            if (MathUtils::doubleIsSmallerOrEqual(randNum, probSum)) {
+                return std::make_pair(values[i], probabilities[i]);
+            }
+        }
+        return std::make_pair(values.back(), probabilities.back());
+    }
+
     double remainingProbSum = 1.0;
-    for (int i : blacklist) {
-        remainingProbSum -= probabilities[i];
+    int lastOutcome = -1;
+    for (int i = 0; i < numberOfOutcomes; ++i) {
+        if (blacklist.contains(i)) {
+            remainingProbSum -= probabilities[i];
+        } else {
+            lastOutcome = i;
+        }
     }
     assert(MathUtils::doubleIsGreater(remainingProbSum, 0.0));
 
-    double randNum = MathUtils::rnd->genDouble(0.0, remainingProbSum);
+    double randNum = rnd.genDouble(0.0, remainingProbSum);
     double probSum = 0.0;
-
-    for (int i = 0; i < values.size(); ++i) {
-        if (find(blacklist.begin(), blacklist.end(), i) == blacklist.end()) {
+    for (int i = 0; i < lastOutcome; ++i) {
+        if (!blacklist.contains(i)) {
             probSum += probabilities[i];
             if (MathUtils::doubleIsSmallerOrEqual(randNum, probSum)) {
                 return std::make_pair(values[i], probabilities[i]);
             }
         }
     }
-    assert(false);
-    return std::make_pair(0, 0);
+    return std::make_pair(values[lastOutcome], probabilities[lastOutcome]);
 }
@@ -5,13 +5,50 @@
 // used for the RDDL KronDelta, Bernoulli and Discrete statements (TODO: maybe
 // it is more efficient to distinguish these by using different classes.)
 
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <vector>
 
 #include <random>
 
 #include "utils/math_utils.h"
 
+// A set of indices of the outcomes of a DiscretePD that is stored as a bitmask.
+// Clearing the set keeps the memory, so a set that is reused does not
+// allocate memory unless it grows.
+class OutcomeMask {
+public:
+    void insert(int index) {
+        size_t word = index >> 6;
+        if (word >= bits.size()) {
+            bits.resize(word + 1, 0);
+        }
+        bits[word] |= uint64_t(1) << (index & 63);
+    }
+
+    bool contains(int index) const {
+        size_t word = index >> 6;
+        return (word < bits.size()) && ((bits[word] >> (index & 63)) & 1);
+    }
+
+    bool empty() const {
+        for (uint64_t word : bits) {
+            if (word) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void clear() {
+        std::fill(bits.begin(), bits.end(), 0);
+    }
+
+private:
+    std::vector<uint64_t> bits;
+};
+
 class DiscretePD {
 public:
     DiscretePD() {}
@@ -142,8 +179,11 @@ public:
     std::string toString() const;
 
     // Sample a value which is not blacklisted. Probability of blackisted values
-    // is ignored
-    std::pair<double, double> sample(std::vector<int> const& blacklist = {}) const;
+    // is ignored. Returns the value and its probability. The random numbers
+    // are drawn from the given generator (usually the one of the task, see
+    // PlanningTask::rnd).
+    std::pair<double, double> sample(
+        RandomXoshiro& rnd, OutcomeMask const& blacklist = OutcomeMask()) const;
 
     std::vector<double> values;
     std::vector<double> probabilities;
@@ -2,10 +2,13 @@
 
 #include "iterative_deepening_search.h"
 #include "minimal_lookahead_search.h"
+#include "persistent_cache.h"
 #include "search_engine.h"
+#include "timeout_manager.h"
 
 #include "utils/logger.h"
 #include "utils/math_utils.h"
+#include "utils/ram_monitor.h"
 #include "utils/stopwatch.h"
 #include "utils/string_utils.h"
 #include "utils/system_utils.h"
@@ -14,18 +17,20 @@
 
 using namespace std;
 
-ProstPlanner::ProstPlanner(string& plannerDesc)
-    : searchEngine(nullptr),
-      currentState(SearchEngine::initialState),
+ProstPlanner::ProstPlanner(PlanningTask& _task, string& plannerDesc)
+    : task(_task),
+      searchEngine(nullptr),
+      currentState(task.initialState),
+      timeoutManager(new NoTimeoutManager()),
       currentRound(-1),
       currentStep(-1),
-      stepsToGo(SearchEngine::horizon),
+      stepsToGo(task.horizon),
       executedActionIndex(-1),
       numberOfRounds(-1),
       cachingEnabled(true),
+      planningTime(0.0),
       ramLimit(2097152),
-      bitSize(sizeof(long) * 8),
-      tmMethod(NONE) {
+      bitSize(sizeof(long) * 8) {
     setSeed((int)time(nullptr));
 
     StringUtils::trim(plannerDesc);
@@ -50,16 +55,11 @@ ProstPlanner::ProstPlanner(string& plannerDesc)
         } else if (param == "-bit") {
             setBitSize(atoi(value.c_str()));
         } else if (param == "-tm") {
-            if (value == "UNI") {
-                setTimeoutManagementMethod(UNIFORM);
-            } else if (value == "NONE") {
-                setTimeoutManagementMethod(NONE);
-            } else {
-                SystemUtils::abort("Illegal timeout management method: " +
-                                   value);
-            }
+            setTimeoutManager(TimeoutManager::fromString(value));
+        } else if (param == "-pc") {
+            setPersistentCache(new PersistentCache(value));
         } else if (param == "-se") {
-            setSearchEngine(SearchEngine::fromString(value));
+            setSearchEngine(SearchEngine::fromString(value, task));
             searchEngineDefined = true;
         } else if (param == "-log") {
             if (value == "SILENT") {
@@ -86,42 +86,55 @@ ProstPlanner::ProstPlanner(string& plannerDesc)
     }
 }
 
+// This destructor is required here to allow forward declaration of
+// RAMMonitor, TimeoutManager and PersistentCache in header because of usage
+// of unique_ptr
+ProstPlanner::~ProstPlanner() = default;
+
+void ProstPlanner::setTimeoutManager(TimeoutManager* _timeoutManager) {
+    timeoutManager = std::unique_ptr<TimeoutManager>(_timeoutManager);
+}
+
+void ProstPlanner::setPersistentCache(PersistentCache* _persistentCache) {
+    persistentCache = std::unique_ptr<PersistentCache>(_persistentCache);
+}
+
 void ProstPlanner::setSeed(int _seed) {
     seed = _seed;
-    MathUtils::rnd->seed(seed);
+    task.rnd.seed(seed);
 }
 
 void ProstPlanner::initSession(int _numberOfRounds, long /*totalTime*/) {
     Logger::logSeparator(Verbosity::VERBOSE);
     Logger::logLine("Final task: ", Verbosity::VERBOSE);
-    SearchEngine::printTask();
+    task.print();
 
     currentRound = -1;
     numberOfRounds = _numberOfRounds;
-    if (tmMethod == UNIFORM) {
-        remainingTimeFactor = numberOfRounds * SearchEngine::horizon;
-    }
+    timeoutManager->initSession(numberOfRounds, task.horizon);
 
     cout.precision(6);
 
     searchEngine->initSession();
 
+    ramMonitor = std::unique_ptr<RAMMonitor>(new RAMMonitor());
+
     if (searchEngine->usesBDDs()) {
-        // TODO: These numbers are rather random. Since I know only little on
-        //  what they actually mean, it'd be nice to re-adjust these.
-        bdd_init(5000000, 20000);
+        task.initBDDs();
+    }
 
-        int* domains = new int[KleeneState::stateSize];
-        for (size_t index = 0; index < SearchEngine::allCPFs.size(); ++index) {
-            domains[index] = SearchEngine::allCPFs[index]->getDomainSize();
-        }
-        fdd_extdomain(domains, KleeneState::stateSize);
+    if (persistentCache) {
+        persistentCache->load(task, searchEngine);
     }
 
     printConfig();
 }
 
 void ProstPlanner::finishSession(double& totalReward) {
+    if (persistentCache) {
+        persistentCache->store(task, searchEngine);
+    }
+
     Logger::logLine("", Verbosity::NORMAL);
     Logger::logSeparator(Verbosity::NORMAL);
     Logger::logLine(">>> END OF SESSION  -- TOTAL REWARD: " +
@@ -135,13 +148,16 @@ void ProstPlanner::finishSession(double& totalReward) {
 void ProstPlanner::initRound(long const& remainingTime) {
     ++currentRound;
     currentStep = -1;
-    stepsToGo = SearchEngine::horizon + 1;
+    stepsToGo = task.horizon + 1;
 
     Logger::logSeparator(Verbosity::NORMAL);
     Logger::logLine(">>> STARTING ROUND " + to_string(currentRound + 1) +
                     " -- REMAINING TIME " + to_string(remainingTime / 1000) +
                     "s", Verbosity::SILENT);
 
+    Profiler::initRound();
+    timeoutManager->initRound();
+
     // Notify search engine
     searchEngine->initRound();
 }
@@ -155,20 +171,34 @@ void ProstPlanner::finishRound(double const& roundReward) {
                     Verbosity::SILENT);
     Logger::logSmallSeparator(Verbosity::NORMAL);
     searchEngine->printRoundStatistics("");
+    Profiler::printRoundStatistics("");
+    timeoutManager->printRoundStatistics("");
     Logger::logLine("", Verbosity::NORMAL);
 
+    timeoutManager->finishRound();
+
     // Notify search engine
     searchEngine->finishRound();
 }
 
 void ProstPlanner::initStep(vector<double> const& nextStateVec,
                             long const& remainingTime) {
+    assert(nextStateVec.size() == State::numberOfDeterministicStateFluents() +
+                                  State::numberOfProbabilisticStateFluents());
+    State nextState(nextStateVec, -1);
+    State::calcStateFluentHashKeys(nextState);
+    State::calcStateHashKey(nextState);
+    initStep(nextState, remainingTime);
+}
+
+void ProstPlanner::initStep(State const& nextState,
+                            long const& remainingTime) {
     // Update current step and log it
     ++currentStep;
     --stepsToGo;
     Logger::logSeparator(Verbosity::NORMAL);
     Logger::logLine("Planning step " + to_string(currentStep + 1) + "/" +
-                    to_string(SearchEngine::horizon) + " in round " +
+                    to_string(task.horizon) + " in round " +
                     to_string(currentRound + 1) + "/" +
                     to_string(numberOfRounds), Verbosity::NORMAL);
     Logger::logLine("", Verbosity::VERBOSE);
@@ -176,12 +206,9 @@ void ProstPlanner::initStep(vector<double> const& nextStateVec,
     // Determine if too much RAM is used and stop caching if this is the case
     monitorRAMUsage();
 
-    // Create current state
-    assert(nextStateVec.size() == State::numberOfDeterministicStateFluents +
-                                  State::numberOfProbabilisticStateFluents);
-    currentState = State(nextStateVec, stepsToGo);
-    State::calcStateFluentHashKeys(currentState);
-    State::calcStateHashKey(currentState);
+    // Set current state (the hash keys do not depend on the remaining steps)
+    currentState = nextState;
+    currentState.stepsToGo() = stepsToGo;
 
     // Log current state
     Logger::logLine("Current state:", Verbosity::VERBOSE);
@@ -191,24 +218,32 @@ void ProstPlanner::initStep(vector<double> const& nextStateVec,
 
     manageTimeouts(remainingTime);
 
+    Profiler::initStep();
+
     // Notify search engine
     searchEngine->initStep(currentState);
 }
 
-void ProstPlanner::finishStep(double const& immediateReward) {
-    int usedRAM = SystemUtils::getRAMUsedByThis();
-    Logger::logLine("Used RAM: " + to_string(usedRAM), Verbosity::NORMAL);
+void ProstPlanner::printStepStatistics() const {
+    Logger::logLine("Used RAM: " + to_string(ramMonitor->getRAMUsed()),
+                    Verbosity::NORMAL);
 
     Logger::logLine("", Verbosity::NORMAL);
     searchEngine->printStepStatistics("");
+    Profiler::printStepStatistics("");
 
     Logger::logLine(
         "Submitted action: " +
-        SearchEngine::actionStates[executedActionIndex].toCompactString(),
+        task.actionStates[executedActionIndex].toCompactString(),
         Verbosity::SILENT);
+}
+
+void ProstPlanner::finishStep(double const& immediateReward) {
     Logger::logLine("Immediate reward: " + to_string(immediateReward),
                     Verbosity::NORMAL);
 
+    timeoutManager->finishStep(planningTime);
+
     // Notify search engine
     searchEngine->finishStep();
 }
@@ -216,36 +251,44 @@ void ProstPlanner::finishStep(double const& immediateReward) {
 vector<string> ProstPlanner::plan() {
     // Call the search engine
     vector<int> bestActions;
+    Stopwatch stopwatch;
     searchEngine->estimateBestActions(currentState, bestActions);
+    planningTime = stopwatch();
 
     // Pick one of the recommended actions uniformly at random
-    executedActionIndex = MathUtils::rnd->randomElement(bestActions);
+    executedActionIndex = task.rnd.randomElement(bestActions);
     ActionState const& executedAction =
-            SearchEngine::actionStates[executedActionIndex];
+            task.actionStates[executedActionIndex];
 
     // PROST's communication with the environment works with strings, so we
     // collect the names of all true action fluents of the chosen action
     return executedAction.getScheduledActionFluentNames();
 }
 
+void ProstPlanner::searchSpeculatively(std::function<bool()> const& stop) {
+    searchEngine->searchSpeculatively(executedActionIndex, stop);
+}
+
 void ProstPlanner::monitorRAMUsage() {
-    if (cachingEnabled && (SystemUtils::getRAMUsedByThis() > ramLimit)) {
+    if (cachingEnabled && (ramMonitor->getRAMUsed() > ramLimit)) {
         cachingEnabled = false;
 
-        SearchEngine::cacheApplicableActions = false;
-        for (size_t i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
-            SearchEngine::deterministicCPFs[i]->disableCaching();
+        task.cacheApplicableActions = false;
+        int numDetFluents = State::numberOfDeterministicStateFluents();
+        for (size_t i = 0; i < numDetFluents; ++i) {
+            task.deterministicCPFs[i]->disableCaching();
         }
 
-        for (size_t i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
-            SearchEngine::probabilisticCPFs[i]->disableCaching();
-            SearchEngine::determinizedCPFs[i]->disableCaching();
+        int numProbFluents = State::numberOfProbabilisticStateFluents();
+        for (size_t i = 0; i < numProbFluents; ++i) {
+            task.probabilisticCPFs[i]->disableCaching();
+            task.determinizedCPFs[i]->disableCaching();
         }
 
-        SearchEngine::rewardCPF->disableCaching();
+        task.rewardCPF->disableCaching();
 
-        for (size_t i = 0; i < SearchEngine::actionPreconditions.size(); ++i) {
-            SearchEngine::actionPreconditions[i]->disableCaching();
+        for (size_t i = 0; i < task.actionPreconditions.size(); ++i) {
+            task.actionPreconditions[i]->disableCaching();
         }
 
         searchEngine->disableCaching();
@@ -261,21 +304,8 @@ void ProstPlanner::manageTimeouts(long const& remainingTime) {
         // We use a buffer of 3 seconds
         remainingTimeInSeconds -= 3.0;
     }
-    double timeForThisStep = 0.0;
-
-    switch (tmMethod) {
-    case NONE:
-        return;
-        break;
-    case UNIFORM:
-        timeForThisStep = remainingTimeInSeconds / remainingTimeFactor;
-        --remainingTimeFactor;
-        break;
-    }
-    Logger::logLine("Setting time for this decision to " +
-                    to_string(timeForThisStep) + "s.", Verbosity::NORMAL);
-
-    searchEngine->setTimeout(timeForThisStep);
+    timeoutManager->initStep(searchEngine, currentStep,
+                             remainingTimeInSeconds);
 }
 
 void ProstPlanner::printConfig() const {
@@ -288,14 +318,7 @@ void ProstPlanner::printConfig() const {
     Logger::logLine(
         "  Bit size: " + std::to_string(bitSize), Verbosity::VERBOSE);
 
-    switch(tmMethod) {
-        case UNIFORM:
-            Logger::logLine("  Timeout method: UNIFORM", Verbosity::VERBOSE);
-            break;
-        case NONE:
-            Logger::logLine("  Timeout method: NONE", Verbosity::VERBOSE);
-            break;
-    }
+    timeoutManager->printConfig("  ");
     switch (Logger::runVerbosity) {
         case Verbosity::SUPPRESS:
             SystemUtils::abort("ERROR: Log level must not be SUPPRESS!");
@@ -317,23 +340,3 @@ void ProstPlanner::printConfig() const {
     Logger::logLine("", Verbosity::VERBOSE);
     searchEngine->printConfig("  ");
 }
-
-void ProstPlanner::resetStaticMembers() {
-    SearchEngine::actionFluents.clear();
-    SearchEngine::stateFluents.clear();
-    SearchEngine::probabilisticCPFs.clear();
-    SearchEngine::allCPFs.clear();
-    SearchEngine::determinizedCPFs.clear();
-    SearchEngine::deterministicCPFs.clear();
-    SearchEngine::actionPreconditions.clear();
-    SearchEngine::actionStates.clear();
-    SearchEngine::trainingSet.clear();
-    SearchEngine::actionPreconditions.clear();
-    State::stateFluentHashKeysOfDeterministicStateFluents.clear();
-    State::stateFluentHashKeysOfProbabilisticStateFluents.clear();
-    State::stateHashKeysOfDeterministicStateFluents.clear();
-    State::stateHashKeysOfProbabilisticStateFluents.clear();
-    KleeneState::hashKeyBases.clear();
-    KleeneState::indexToStateFluentHashKeyMap.clear();
-    MathUtils::resetRNG();
-}
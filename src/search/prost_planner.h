@@ -5,14 +5,18 @@
 #include "states.h"
 
 #include <cassert>
+#include <functional>
+#include <memory>
 
+class PersistentCache;
 class PlanningTask;
+class RAMMonitor;
+class TimeoutManager;
 
 class ProstPlanner {
 public:
-    enum TimeoutManagementMethod { NONE, UNIFORM };
-
-    ProstPlanner(std::string& plannerDesc);
+    ProstPlanner(PlanningTask& _task, std::string& plannerDesc);
+    ~ProstPlanner();
 
     // Start or end the session
     void initSession(int _numberOfRounds, long totalTime);
@@ -22,15 +26,29 @@ public:
     void initRound(long const& remainingTime);
     void finishRound(double const& roundReward);
 
-    // These are called at the beginning and end of a step
+    // These are called at the beginning and end of a step. The state that is
+    // passed to initStep can be created and hashed by the caller in advance
+    // (its number of remaining steps is set by the planner).
     void initStep(std::vector<double> const& nextStateVec,
                   long const& remainingTime);
+    void initStep(State const& nextState, long const& remainingTime);
     void finishStep(double const& immediateReward);
 
+    // Prints the statistics of the step (and the submitted action). This does
+    // not depend on the outcome of the step, so it can be called before the
+    // response of the environment is available, and must be called before
+    // finishStep.
+    void printStepStatistics() const;
+
     // This is the main function of the PROST planner that starts the search
     // engine and return the next decision
     std::vector<std::string> plan();
 
+    // Lets the search engine continue the search after the decision has been
+    // submitted until stop returns true (e.g., until the environment has
+    // computed the outcome of the decision)
+    void searchSpeculatively(std::function<bool()> const& stop);
+
     // Parameter setters
     void setSearchEngine(SearchEngine* _searchEngine) {
         searchEngine = _searchEngine;
@@ -50,13 +68,18 @@ public:
         bitSize = _bitSize;
     }
 
-    void setTimeoutManagementMethod(TimeoutManagementMethod _tmMethod) {
-        tmMethod = _tmMethod;
+    void setTimeoutManager(TimeoutManager* _timeoutManager);
+
+    void setPersistentCache(PersistentCache* _persistentCache);
+
+    SearchEngine const* getSearchEngine() const {
+        return searchEngine;
+    }
+
+    // The index of the action that was returned by the last call to plan()
+    int getExecutedActionIndex() const {
+        return executedActionIndex;
     }
-    
-    // Resets the static objects used within all components. Has to be called if
-    // the planner is used multiple times within one run, or for unit tests
-    static void resetStaticMembers();
 
 private:
     // Checks how much memory is used and aborts caching if necessary
@@ -67,10 +90,23 @@ private:
 
     void printConfig() const;
 
+    // The task that is solved by this planner
+    PlanningTask& task;
+
     SearchEngine* searchEngine;
 
     State currentState;
 
+    // Measures the used RAM in the background
+    std::unique_ptr<RAMMonitor> ramMonitor;
+
+    // Assigns the time of the decisions
+    std::unique_ptr<TimeoutManager> timeoutManager;
+
+    // If given, the caches are restored from this at the start of the session
+    // and written to it at the end of the session
+    std::unique_ptr<PersistentCache> persistentCache;
+
     int currentRound;
     int currentStep;
     int stepsToGo;
@@ -79,13 +115,13 @@ private:
 
     bool cachingEnabled;
 
-    int remainingTimeFactor;
+    // The time in seconds that was used for the decision in the current step
+    double planningTime;
 
     // Parameter
     int ramLimit;
     int bitSize;
     int seed;
-    TimeoutManagementMethod tmMethod;
 };
 
 #endif
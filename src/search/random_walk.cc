@@ -2,8 +2,11 @@
 
 #include "utils/logger.h"
 
-RandomWalk::RandomWalk() :
-    ProbabilisticSearchEngine("RandomWalk"),
+#include <algorithm>
+#include <numeric>
+
+RandomWalk::RandomWalk(PlanningTask& _task) :
+    ProbabilisticSearchEngine("RandomWalk", _task),
     numberOfIterations(1) {}
 
 bool RandomWalk::setValueFromString(std::string& param,
@@ -20,56 +23,118 @@ bool RandomWalk::setValueFromString(std::string& param,
 void RandomWalk::estimateQValue(State const& state, int actionIndex,
                                 double& qValue) {
     assert(state.stepsToGo() > 0);
-    PDState current(state);
-    performRandomWalks(current, actionIndex, qValue);
+    std::vector<double> results(1);
+    performRandomWalks(state, {actionIndex}, results);
+    qValue = results[0];
 }
 
 void RandomWalk::estimateQValues(State const& state,
                                  std::vector<int> const& actionsToExpand,
                                  std::vector<double>& qValues) {
     assert(state.stepsToGo() > 0);
-    PDState current(state);
+    std::vector<int> firstActionIndices;
     for (size_t index = 0; index < qValues.size(); ++index) {
         if (actionsToExpand[index] == index) {
-            performRandomWalks(current, index, qValues[index]);
+            firstActionIndices.push_back(index);
         }
     }
+    std::vector<double> results(firstActionIndices.size());
+    performRandomWalks(state, firstActionIndices, results);
+    for (size_t i = 0; i < firstActionIndices.size(); ++i) {
+        qValues[firstActionIndices[i]] = results[i];
+    }
 }
 
-void RandomWalk::performRandomWalks(PDState const& root, int firstActionIndex,
-                                    double& result) const {
-    result = 0.0;
-    double reward = 0.0;
-    PDState next;
-
-    for (unsigned int i = 0; i < numberOfIterations; ++i) {
-        PDState current(root.stepsToGo() - 1);
-        sampleSuccessorState(root, firstActionIndex, current, reward);
-        result += reward;
-
-        while (current.stepsToGo() > 0) {
-            int rndActionIndex = MathUtils::rnd->randomElement(
-                getIndicesOfApplicableActions(current));
-            next.reset(current.stepsToGo() - 1);
-            sampleSuccessorState(current, rndActionIndex, next, reward);
-            result += reward;
-            current = next;
+void RandomWalk::performRandomWalks(State const& root,
+                                    std::vector<int> const& firstActionIndices,
+                                    std::vector<double>& results) const {
+    // Walk w starts with firstActionIndices[w / numberOfIterations]
+    int numberOfWalks = firstActionIndices.size() * numberOfIterations;
+    std::vector<State> states(numberOfWalks, root);
+    std::vector<State> nextStates(numberOfWalks, root);
+    std::vector<int> actions(numberOfWalks);
+    std::vector<double> rewards(numberOfWalks, 0.0);
+    for (int walk = 0; walk < numberOfWalks; ++walk) {
+        actions[walk] = firstActionIndices[walk / numberOfIterations];
+    }
+
+    // The walks are sorted by their current state in each step, so walks in
+    // the same state form a consecutive group
+    std::vector<int> walks(numberOfWalks);
+    std::iota(walks.begin(), walks.end(), 0);
+    State::CompareIgnoringStepsToGo stateIsSmaller;
+    auto walkIsSmaller = [&](int lhs, int rhs) {
+        return stateIsSmaller(states[lhs], states[rhs]);
+    };
+    auto actionIsSmaller = [&](int lhs, int rhs) {
+        return actions[lhs] < actions[rhs];
+    };
+
+    PDState successor(root.stepsToGo() - 1);
+    bool isFirstStep = true;
+    while ((numberOfWalks > 0) && (states[0].stepsToGo() > 0)) {
+        std::sort(walks.begin(), walks.end(), walkIsSmaller);
+        auto groupBegin = walks.begin();
+        while (groupBegin != walks.end()) {
+            State const& current = states[*groupBegin];
+            auto groupEnd =
+                std::find_if(groupBegin + 1, walks.end(), [&](int walk) {
+                    return stateIsSmaller(current, states[walk]);
+                });
+
+            // The actions of the first step are given
+            if (!isFirstStep) {
+                std::vector<int> applicableActions =
+                    getIndicesOfApplicableActions(current);
+                for (auto it = groupBegin; it != groupEnd; ++it) {
+                    actions[*it] =
+                        task.rnd.randomElement(applicableActions);
+                }
+            }
+            std::sort(groupBegin, groupEnd, actionIsSmaller);
+
+            auto actionBegin = groupBegin;
+            while (actionBegin != groupEnd) {
+                int actionIndex = actions[*actionBegin];
+                auto actionEnd = std::find_if(
+                    actionBegin + 1, groupEnd,
+                    [&](int walk) { return actions[walk] != actionIndex; });
+
+                double reward = 0.0;
+                calcReward(current, actionIndex, reward);
+                successor.reset(current.stepsToGo() - 1);
+                calcSuccessorState(current, actionIndex, successor);
+
+                for (auto it = actionBegin; it != actionEnd; ++it) {
+                    rewards[*it] += reward;
+                    State& next = nextStates[*it];
+                    next.setTo(successor);
+                    for (unsigned int varIndex = 0;
+                         varIndex < State::numberOfProbabilisticStateFluents();
+                         ++varIndex) {
+                        next.probabilisticStateFluent(varIndex) =
+                            successor.probabilisticStateFluentAsPD(varIndex)
+                                .sample(task.rnd)
+                                .first;
+                    }
+                    State::calcStateFluentHashKeys(next);
+                    State::calcStateHashKey(next);
+                }
+                actionBegin = actionEnd;
+            }
+            groupBegin = groupEnd;
         }
+        states.swap(nextStates);
+        isFirstStep = false;
     }
-    result /= (double)numberOfIterations;
-}
 
-void RandomWalk::sampleSuccessorState(PDState const& current,
-                                      int const& actionIndex, PDState& next,
-                                      double& reward) const {
-    calcReward(current, actionIndex, reward);
-    calcSuccessorState(current, actionIndex, next);
-    for (unsigned int varIndex = 0;
-         varIndex < State::numberOfProbabilisticStateFluents; ++varIndex) {
-        next.sample(varIndex);
+    std::fill(results.begin(), results.end(), 0.0);
+    for (int walk = 0; walk < numberOfWalks; ++walk) {
+        results[walk / numberOfIterations] += rewards[walk];
+    }
+    for (double& result : results) {
+        result /= (double)numberOfIterations;
     }
-    State::calcStateFluentHashKeys(next);
-    State::calcStateHashKey(next);
 }
 
 void RandomWalk::printConfig(std::string indent) const {
@@ -4,11 +4,14 @@
 #include "search_engine.h"
 
 // Evaluates all actions by simulating a run that starts with that action
-// followed by random actions until a terminal state is reached
+// followed by random actions until a terminal state is reached. The runs of all
+// actions are performed in lockstep, and runs that are in the same state share
+// the computation of the applicable actions and (if they apply the same action)
+// of the reward and the distribution over successor states.
 
 class RandomWalk : public ProbabilisticSearchEngine {
 public:
-    RandomWalk();
+    RandomWalk(PlanningTask& _task);
 
     // Set parameters from command line
     bool setValueFromString(std::string& param, std::string& value) override;
@@ -38,10 +41,12 @@ public:
     void printStepStatistics(std::string /*indent*/) const override {}
 
 private:
-    void performRandomWalks(PDState const& root, int firstActionIndex,
-                            double& result) const;
-    void sampleSuccessorState(PDState const& current, int const& actionIndex,
-                              PDState& next, double& reward) const;
+    // Performs numberOfIterations random walks for each of the given actions
+    // and sets results[i] to the average reward of the walks that start with
+    // firstActionIndices[i]
+    void performRandomWalks(State const& root,
+                            std::vector<int> const& firstActionIndices,
+                            std::vector<double>& results) const;
 
     // Parameter
     int numberOfIterations;
@@ -10,83 +10,20 @@
 #include "uniform_evaluation_search.h"
 
 #include "utils/math_utils.h"
+#include "utils/stopwatch.h"
 #include "utils/string_utils.h"
 #include "utils/system_utils.h"
 
-using namespace std;
-
-/******************************************************************
-                    Static variable definitions
-******************************************************************/
-
-int State::numberOfDeterministicStateFluents = 0;
-int State::numberOfProbabilisticStateFluents = 0;
-
-int State::numberOfStateFluentHashKeys = 0;
-bool State::stateHashingPossible = true;
-
-vector<vector<long>> State::stateHashKeysOfDeterministicStateFluents;
-vector<vector<long>> State::stateHashKeysOfProbabilisticStateFluents;
-
-vector<vector<pair<int, long>>>
-    State::stateFluentHashKeysOfDeterministicStateFluents;
-vector<vector<pair<int, long>>>
-    State::stateFluentHashKeysOfProbabilisticStateFluents;
-
-int KleeneState::stateSize = 0;
-int KleeneState::numberOfStateFluentHashKeys = 0;
-bool KleeneState::stateHashingPossible = true;
-vector<long> KleeneState::hashKeyBases;
-vector<vector<pair<int, long>>> KleeneState::indexToStateFluentHashKeyMap;
-
-string SearchEngine::taskName;
-vector<State> SearchEngine::trainingSet;
+#include <algorithm>
+#include <mutex>
 
-vector<ActionState> SearchEngine::actionStates;
-
-vector<ActionFluent*> SearchEngine::actionFluents;
-vector<StateFluent*> SearchEngine::stateFluents;
-
-vector<Evaluatable*> SearchEngine::allCPFs;
-vector<DeterministicCPF*> SearchEngine::deterministicCPFs;
-vector<ProbabilisticCPF*> SearchEngine::probabilisticCPFs;
-
-vector<DeterministicCPF*> SearchEngine::determinizedCPFs;
-
-RewardFunction* SearchEngine::rewardCPF = nullptr;
-vector<DeterministicEvaluatable*> SearchEngine::actionPreconditions;
-
-bool SearchEngine::taskIsDeterministic = true;
-State SearchEngine::initialState;
-int SearchEngine::horizon = numeric_limits<int>::max();
-double SearchEngine::discountFactor = 1.0;
-int SearchEngine::numberOfActions = -1;
-vector<int> SearchEngine::candidatesForOptimalFinalAction;
-
-bool SearchEngine::cacheApplicableActions = true;
-bool SearchEngine::rewardLockDetected = true;
-int SearchEngine::goalTestActionIndex = -1;
-bdd SearchEngine::cachedDeadEnds = bddfalse;
-bdd SearchEngine::cachedGoals = bddfalse;
-
-bool ProbabilisticSearchEngine::hasUnreasonableActions = true;
-bool DeterministicSearchEngine::hasUnreasonableActions = true;
-
-SearchEngine::ActionHashMap ProbabilisticSearchEngine::applicableActionsCache(
-    520241);
-SearchEngine::ActionHashMap DeterministicSearchEngine::applicableActionsCache(
-    520241);
-
-SearchEngine::StateValueHashMap ProbabilisticSearchEngine::stateValueCache(
-    62233);
-SearchEngine::StateValueHashMap DeterministicSearchEngine::stateValueCache(
-    520241);
+using namespace std;
 
 /******************************************************************
                      Search Engine Creation
 ******************************************************************/
 
-SearchEngine* SearchEngine::fromString(string& desc) {
+SearchEngine* SearchEngine::fromString(string& desc, PlanningTask& task) {
     StringUtils::trim(desc);
     assert(desc[0] == '[' && desc[desc.size() - 1] == ']');
     StringUtils::removeFirstAndLastCharacter(desc);
@@ -154,22 +91,22 @@ SearchEngine* SearchEngine::fromString(string& desc) {
 
     if (isConfig("THTS")) {
         desc = desc.substr(4, desc.size());
-        result = new THTS("THTS");
+        result = new THTS("THTS", task);
     } else if (isConfig("IDS")) {
         desc = desc.substr(3, desc.size());
-        result = new IDS();
+        result = new IDS(task);
     } else if (isConfig("DFS")) {
         desc = desc.substr(3, desc.size());
-        result = new DepthFirstSearch();
+        result = new DepthFirstSearch(task);
     } else if (isConfig("MLS")) {
         desc = desc.substr(3, desc.size());
-        result = new MinimalLookaheadSearch();
+        result = new MinimalLookaheadSearch(task);
     } else if (isConfig("Uniform")) {
         desc = desc.substr(7, desc.size());
-        result = new UniformEvaluationSearch();
+        result = new UniformEvaluationSearch(task);
     } else if (isConfig("RandomWalk")) {
         desc = desc.substr(10, desc.size());
-        result = new RandomWalk();
+        result = new RandomWalk(task);
     } else {
         SystemUtils::abort("Unknown Search Engine: " + desc);
     }
@@ -238,9 +175,9 @@ void SearchEngine::printConfig(string indent) const {
 void ProbabilisticSearchEngine::printStateValueCacheUsage(
         std::string indent, Verbosity verbosity) const {
     long entriesProbStateValue =
-            ProbabilisticSearchEngine::stateValueCache.size();
+            caches.stateValueCache.size();
     long bucketsProbStateValue =
-            ProbabilisticSearchEngine::stateValueCache.bucket_count();
+            caches.stateValueCache.bucket_count();
     Logger::logLine(
             indent + "Entries in probabilistic state value cache: " +
             std::to_string(entriesProbStateValue), verbosity);
@@ -252,23 +189,57 @@ void ProbabilisticSearchEngine::printStateValueCacheUsage(
 void ProbabilisticSearchEngine::printApplicableActionCacheUsage(
         std::string indent, Verbosity verbosity) const {
     long entriesProbApplActions =
-            ProbabilisticSearchEngine::applicableActionsCache.size();
+            caches.applicableActionsCache.size();
     long bucketsProbApplActions =
-            ProbabilisticSearchEngine::applicableActionsCache.bucket_count();
+            caches.applicableActionsCache.bucket_count();
     Logger::logLine(
             indent + "Entries in probabilistic applicable actions cache: " +
             std::to_string(entriesProbApplActions), verbosity);
     Logger::logLine(
             indent + "Buckets in probabilistic applicable actions cache: " +
             std::to_string(bucketsProbApplActions), verbosity);
+    Logger::logLine(
+            indent + "Entries in probabilistic action equivalence cache: " +
+            std::to_string(caches.actionEquivalenceCache.size()), verbosity);
+}
+
+void ProbabilisticSearchEngine::printRewardLockStatistics(
+        std::string indent, Verbosity verbosity) const {
+    if (!useRewardLockDetection) {
+        return;
+    }
+    double hitRate = 0.0;
+    if (numRewardLockChecks > 0) {
+        hitRate = static_cast<double>(numRewardLockCacheHits +
+                                      numRewardLockBDDHits) /
+                  static_cast<double>(numRewardLockChecks);
+    }
+    Logger::logLine(
+            indent + "Reward lock checks: " +
+            std::to_string(numRewardLockChecks), verbosity);
+    Logger::logLine(
+            indent + "Detected reward locks: " +
+            std::to_string(numRewardLocks), verbosity);
+    Logger::logLine(
+            indent + "Reward lock hash map hits: " +
+            std::to_string(numRewardLockCacheHits), verbosity);
+    Logger::logLine(
+            indent + "Reward lock BDD hits: " +
+            std::to_string(numRewardLockBDDHits), verbosity);
+    Logger::logLine(
+            indent + "Reward lock cache hit rate: " +
+            std::to_string(hitRate), verbosity);
+    Logger::logLine(
+            indent + "Reward lock detection time: " +
+            std::to_string(rewardLockDetectionTime), verbosity);
 }
 
 void DeterministicSearchEngine::printStateValueCacheUsage(
         std::string indent, Verbosity verbosity) const {
     long entriesDetStateValue =
-            DeterministicSearchEngine::stateValueCache.size();
+            caches.stateValueCache.size();
     long bucketsDetStateValue =
-            DeterministicSearchEngine::stateValueCache.bucket_count();
+            caches.stateValueCache.bucket_count();
     Logger::logLine(
             indent + "Entries in deterministic state value cache: " +
             to_string(entriesDetStateValue), verbosity);
@@ -280,15 +251,18 @@ void DeterministicSearchEngine::printStateValueCacheUsage(
 void DeterministicSearchEngine::printApplicableActionCacheUsage(
         std::string indent, Verbosity verbosity) const {
     long entriesDetApplActions =
-            DeterministicSearchEngine::applicableActionsCache.size();
+            caches.applicableActionsCache.size();
     long bucketsDetApplActions =
-            DeterministicSearchEngine::applicableActionsCache.bucket_count();
+            caches.applicableActionsCache.bucket_count();
     Logger::logLine(
             indent + "Entries in deterministic applicable actions cache: " +
             to_string(entriesDetApplActions), verbosity);
     Logger::logLine(
             indent + "Buckets in deterministic applicable actions cache: " +
             to_string(bucketsDetApplActions), verbosity);
+    Logger::logLine(
+            indent + "Entries in deterministic action equivalence cache: " +
+            to_string(caches.actionEquivalenceCache.size()), verbosity);
 }
 
 /******************************************************************
@@ -297,7 +271,7 @@ void DeterministicSearchEngine::printApplicableActionCacheUsage(
 
 void SearchEngine::estimateBestActions(State const& _rootState,
                                        std::vector<int>& bestActions) {
-    vector<double> qValues(numberOfActions);
+    vector<double> qValues(task.numberOfActions);
     vector<int> actionsToExpand = getApplicableActions(_rootState);
 
     estimateQValues(_rootState, actionsToExpand, qValues);
@@ -317,7 +291,7 @@ void SearchEngine::estimateBestActions(State const& _rootState,
 
 void SearchEngine::estimateStateValue(State const& _rootState,
                                       double& stateValue) {
-    vector<double> qValues(numberOfActions);
+    vector<double> qValues(task.numberOfActions);
     vector<int> actionsToExpand = getApplicableActions(_rootState);
 
     estimateQValues(_rootState, actionsToExpand, qValues);
@@ -342,15 +316,50 @@ bool ProbabilisticSearchEngine::isARewardLock(State const& current) const {
         return false;
     }
 
-    assert(goalTestActionIndex >= 0);
+    assert(task.goalTestActionIndex >= 0);
+    PROFILE_PHASE(REWARD_LOCK_DETECTION);
+    Stopwatch stopwatch;
+    ++numRewardLockChecks;
+
+    // The result of a reward lock check in a concrete state does not depend
+    // on the reward locks that have been detected before, so we can store it
+    // in a hash map for exact hits
+    bool result = false;
+    PlanningTask::RewardLockHashMap::const_iterator it =
+        task.rewardLockCache.find(current);
+    if (it != task.rewardLockCache.end()) {
+        ++numRewardLockCacheHits;
+        result = it->second;
+    } else {
+        result = checkRewardLock(current);
+        if (cacheRewardLocks && cachingEnabled) {
+            task.rewardLockCache[current] = result;
+        }
+    }
+
+    if (result) {
+        ++numRewardLocks;
+    }
+    rewardLockDetectionTime += stopwatch();
+    return result;
+}
+
+bool ProbabilisticSearchEngine::checkRewardLock(State const& current) const {
+    // The BDDs of the check are created in the node table that is shared with
+    // the other tasks of the process
+    unique_lock<mutex> bddLock(PlanningTask::bddMutex, defer_lock);
+    if (cacheRewardLocks) {
+        bddLock.lock();
+    }
 
     // Calculate the reference reward
     double reward = 0.0;
-    calcReward(current, goalTestActionIndex, reward);
+    calcReward(current, task.goalTestActionIndex, reward);
 
-    if (MathUtils::doubleIsEqual(rewardCPF->getMinVal(), reward)) {
+    if (MathUtils::doubleIsEqual(task.rewardCPF->getMinVal(), reward)) {
         // Check if current is known to be a dead end
-        if (cacheRewardLocks && BDDIncludes(cachedDeadEnds, current)) {
+        if (cacheRewardLocks && BDDIncludes(task.cachedDeadEnds, current)) {
+            ++numRewardLockBDDHits;
             return true;
         }
 
@@ -359,11 +368,20 @@ bool ProbabilisticSearchEngine::isARewardLock(State const& current) const {
         KleeneState::calcStateHashKey(currentInKleene);
         KleeneState::calcStateFluentHashKeys(currentInKleene);
 
-        // Check reward lock on Kleene state
-        return checkDeadEnd(currentInKleene);
-    } else if (MathUtils::doubleIsEqual(rewardCPF->getMaxVal(), reward)) {
+        // Check reward lock on Kleene state and add all dead ends that are
+        // encountered in the check to the cached dead ends at once
+        bdd newDeadEnds = bddfalse;
+        if (checkDeadEnd(currentInKleene, newDeadEnds)) {
+            if (cacheRewardLocks) {
+                task.cachedDeadEnds |= newDeadEnds;
+            }
+            return true;
+        }
+        return false;
+    } else if (MathUtils::doubleIsEqual(task.rewardCPF->getMaxVal(), reward)) {
         // Check if current is known to be a goal
-        if (cacheRewardLocks && BDDIncludes(cachedGoals, current)) {
+        if (cacheRewardLocks && BDDIncludes(task.cachedGoals, current)) {
+            ++numRewardLockBDDHits;
             return true;
         }
 
@@ -372,15 +390,13 @@ bool ProbabilisticSearchEngine::isARewardLock(State const& current) const {
         KleeneState::calcStateHashKey(currentInKleene);
         KleeneState::calcStateFluentHashKeys(currentInKleene);
 
-        // Logger::logLine("Checking state: ", Verbosity::DEBUG);
-        // Logger::logLine(currentInKleene.toString(), Verbosity::DEBUG);
-
         return checkGoal(currentInKleene);
     }
     return false;
 }
 
-bool ProbabilisticSearchEngine::checkDeadEnd(KleeneState const& state) const {
+bool ProbabilisticSearchEngine::checkDeadEnd(KleeneState const& state,
+                                             bdd& newDeadEnds) const {
     // TODO: We do currently not care about action applicability. Nevertheless,
     // the results remain sound, as we only check too many actions (it might be
     // the case that we think some state is not a dead end even though it is.
@@ -395,11 +411,12 @@ bool ProbabilisticSearchEngine::checkDeadEnd(KleeneState const& state) const {
 
     // If reward is not minimal with certainty this is not a dead end
     if ((reward.size() != 1) ||
-        !MathUtils::doubleIsEqual(*reward.begin(), rewardCPF->getMinVal())) {
+        !MathUtils::doubleIsEqual(*reward.begin(),
+                                  task.rewardCPF->getMinVal())) {
         return false;
     }
 
-    for (size_t index = 1; index < numberOfActions; ++index) {
+    for (size_t index = 1; index < task.numberOfActions; ++index) {
         reward.clear();
         // Apply action index
         KleeneState succ;
@@ -409,7 +426,7 @@ bool ProbabilisticSearchEngine::checkDeadEnd(KleeneState const& state) const {
         // If reward is not minimal this is not a dead end
         if ((reward.size() != 1) ||
             !MathUtils::doubleIsEqual(*reward.begin(),
-                                      rewardCPF->getMinVal())) {
+                                      task.rewardCPF->getMinVal())) {
             return false;
         }
 
@@ -422,9 +439,9 @@ bool ProbabilisticSearchEngine::checkDeadEnd(KleeneState const& state) const {
     KleeneState::calcStateFluentHashKeys(mergedSuccs);
 
     // Check if nothing changed, otherwise continue dead end check
-    if ((mergedSuccs == state) || checkDeadEnd(mergedSuccs)) {
+    if ((mergedSuccs == state) || checkDeadEnd(mergedSuccs, newDeadEnds)) {
         if (cacheRewardLocks) {
-            cachedDeadEnds |= stateToBDD(state);
+            newDeadEnds |= stateToBDD(state);
         }
         return true;
     }
@@ -437,12 +454,13 @@ bool ProbabilisticSearchEngine::checkGoal(KleeneState const& state) const {
     // Apply action goalTestActionIndex
     KleeneState succ;
     set<double> reward;
-    calcKleeneSuccessor(state, goalTestActionIndex, succ);
-    calcKleeneReward(state, goalTestActionIndex, reward);
+    calcKleeneSuccessor(state, task.goalTestActionIndex, succ);
+    calcKleeneReward(state, task.goalTestActionIndex, reward);
 
     // If reward is not maximal with certainty this is not a goal
     if ((reward.size() > 1) ||
-        !MathUtils::doubleIsEqual(rewardCPF->getMaxVal(), *reward.begin())) {
+        !MathUtils::doubleIsEqual(task.rewardCPF->getMaxVal(),
+                                  *reward.begin())) {
         return false;
     }
 
@@ -453,45 +471,141 @@ bool ProbabilisticSearchEngine::checkGoal(KleeneState const& state) const {
     KleeneState::calcStateHashKey(succ);
     KleeneState::calcStateFluentHashKeys(succ);
 
-    // Check if nothing changed, otherwise continue goal check
-    if ((succ == state) || checkGoal(succ)) {
+    // Check if nothing changed, otherwise continue goal check. Since each
+    // state that is checked includes all states that have been checked before,
+    // it suffices to cache the final state.
+    if (succ == state) {
         if (cacheRewardLocks) {
-            cachedGoals |= stateToBDD(state);
+            task.cachedGoals |= stateToBDD(state);
         }
         return true;
     }
-    return false;
+    return checkGoal(succ);
 }
 
 inline bdd ProbabilisticSearchEngine::stateToBDD(
     KleeneState const& state) const {
     bdd res = bddtrue;
-    for (size_t i = 0; i < KleeneState::stateSize; ++i) {
+    for (size_t i = 0; i < KleeneState::stateSize(); ++i) {
         bdd tmp = bddfalse;
-        for (set<double>::iterator it = state[i].begin(); it != state[i].end();
-             ++it) {
-            tmp |= fdd_ithvar(i, *it);
-        }
+        state.forEachValue(
+            i, [&](double const& val) {
+                tmp |= fdd_ithvar(task.firstBDDBlock + i, val);
+            });
         res &= tmp;
     }
     return res;
 }
 
-inline bdd ProbabilisticSearchEngine::stateToBDD(State const& state) const {
-    bdd res = bddtrue;
-    for (size_t i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
-        res &= fdd_ithvar(i, state.deterministicStateFluent(i));
+// Instead of building the BDD of state and conjoining it with BDD, we follow
+// the path that corresponds to state from the root of BDD to a terminal node,
+// which does not create any BDD nodes.
+inline bool ProbabilisticSearchEngine::BDDIncludes(bdd const& BDD,
+                                                   State const& state) const {
+    bdd node = BDD;
+    while ((node != bddtrue) && (node != bddfalse)) {
+        pair<int, int> const& var = task.bddVariables[bdd_var(node)];
+        int value = 0;
+        if (var.first < State::numberOfDeterministicStateFluents()) {
+            value = static_cast<int>(state.deterministicStateFluent(var.first));
+        } else {
+            value = static_cast<int>(state.probabilisticStateFluent(
+                var.first - State::numberOfDeterministicStateFluents()));
+        }
+        if ((value >> var.second) & 1) {
+            node = bdd_high(node);
+        } else {
+            node = bdd_low(node);
+        }
+    }
+    return node == bddtrue;
+}
+
+/******************************************************************
+                 Calculation of Applicable Actions
+******************************************************************/
+
+bool ProbabilisticSearchEngine::calcReasonableActions(State const& state,
+                                                      vector<int>& res) const {
+    bool useEquivalenceCache =
+        task.cacheApplicableActions && task.actionEquivalenceKeysPossible;
+    vector<long> key;
+    if (useEquivalenceCache) {
+        calcActionEquivalenceKey(state, key);
+        PlanningTask::ActionEquivalenceHashMap::const_iterator it =
+            caches.actionEquivalenceCache.find(key);
+        if (it != caches.actionEquivalenceCache.end()) {
+            // We only cache results with at least one applicable action
+            res = it->second;
+            return true;
+        }
     }
-    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
-        res &= fdd_ithvar(State::numberOfDeterministicStateFluents + i,
-                          state.probabilisticStateFluent(i));
+
+    // Actions are equivalent if their successor distributions are equal,
+    // which is detected by hashing the successor PDStates
+    unordered_map<PDState, int, PDState::PDStateHash, PDState::PDStateEqual>
+        childStates;
+    bool applicableActionExists = false;
+    for (size_t index = 0; index < task.numberOfActions; ++index) {
+        if (actionIsApplicable(task.actionStates[index], state)) {
+            applicableActionExists = true;
+            PDState nxt(state.stepsToGo() - 1);
+            calcSuccessorState(state, index, nxt);
+
+            // If an equivalent action has been applied already, this action
+            // is not reasonable and is mapped to the equivalent action
+            res[index] = childStates.emplace(move(nxt), index).first->second;
+        } else {
+            // This action is not appicable
+            res[index] = -1;
+        }
     }
-    return res;
+
+    if (useEquivalenceCache && applicableActionExists) {
+        caches.actionEquivalenceCache[key] = res;
+    }
+    return applicableActionExists;
 }
 
-inline bool ProbabilisticSearchEngine::BDDIncludes(
-    bdd BDD, KleeneState const& state) const {
-    return (BDD & stateToBDD(state)) != bddfalse;
+bool DeterministicSearchEngine::calcReasonableActions(State const& state,
+                                                      vector<int>& res) const {
+    bool useEquivalenceCache =
+        task.cacheApplicableActions && task.actionEquivalenceKeysPossible;
+    vector<long> key;
+    if (useEquivalenceCache) {
+        calcActionEquivalenceKey(state, key);
+        PlanningTask::ActionEquivalenceHashMap::const_iterator it =
+            caches.actionEquivalenceCache.find(key);
+        if (it != caches.actionEquivalenceCache.end()) {
+            // We only cache results with at least one applicable action
+            res = it->second;
+            return true;
+        }
+    }
+
+    unordered_map<State, int, State::HashWithoutRemSteps,
+                  State::EqualWithoutRemSteps>
+        childStates;
+    bool applicableActionExists = false;
+    for (size_t index = 0; index < task.numberOfActions; ++index) {
+        if (actionIsApplicable(task.actionStates[index], state)) {
+            applicableActionExists = true;
+            State nxt;
+            calcSuccessorState(state, index, nxt);
+
+            // If an equivalent action has been applied already, this action
+            // is not reasonable and is mapped to the equivalent action
+            res[index] = childStates.emplace(move(nxt), index).first->second;
+        } else {
+            // This action is not appicable
+            res[index] = -1;
+        }
+    }
+
+    if (useEquivalenceCache && applicableActionExists) {
+        caches.actionEquivalenceCache[key] = res;
+    }
+    return applicableActionExists;
 }
 
 /******************************************************************
@@ -500,16 +614,17 @@ inline bool ProbabilisticSearchEngine::BDDIncludes(
 
 void SearchEngine::calcOptimalFinalReward(
     State const& current, double& reward) const {
-    if (candidatesForOptimalFinalAction.size() == 1) {
+    if (task.candidatesForOptimalFinalAction.size() == 1) {
         // Since there is only one candidate action, it must always be
         // applicable and optimal
-        return calcReward(current, candidatesForOptimalFinalAction[0], reward);
+        return calcReward(
+            current, task.candidatesForOptimalFinalAction[0], reward);
     }
 
     vector<int> applicableActions = getApplicableActions(current);
-    if (candidatesForOptimalFinalAction.empty()) {
+    if (task.candidatesForOptimalFinalAction.empty()) {
         // The first applicable action is guaranteed to be optimal
-        for (size_t index = 0; index < numberOfActions; ++index) {
+        for (size_t index = 0; index < task.numberOfActions; ++index) {
             if (applicableActions[index] == index) {
                 return calcReward(current, index, reward);
             }
@@ -521,7 +636,7 @@ void SearchEngine::calcOptimalFinalReward(
     // Check all applicable candidates and return the best
     reward = -numeric_limits<double>::max();
     double tmpReward = 0.0;
-    for (int index : candidatesForOptimalFinalAction) {
+    for (int index : task.candidatesForOptimalFinalAction) {
         if (applicableActions[index] == index) {
             calcReward(current, index, tmpReward);
             reward = std::max(reward, tmpReward);
@@ -530,16 +645,16 @@ void SearchEngine::calcOptimalFinalReward(
 }
 
 int SearchEngine::getOptimalFinalActionIndex(State const& current) const {
-    if (candidatesForOptimalFinalAction.size() == 1) {
+    if (task.candidatesForOptimalFinalAction.size() == 1) {
         // Since there is only one candidate action, it must always be
         // applicable and optimal
-        return candidatesForOptimalFinalAction[0];
+        return task.candidatesForOptimalFinalAction[0];
     }
 
     vector<int> applicableActions = getApplicableActions(current);
-    if (candidatesForOptimalFinalAction.empty()) {
+    if (task.candidatesForOptimalFinalAction.empty()) {
         // The first applicable action is guaranteed to be optimal
-        for (size_t index = 0; index < numberOfActions; ++index) {
+        for (size_t index = 0; index < task.numberOfActions; ++index) {
             if (applicableActions[index] == index) {
                 return index;
             }
@@ -550,7 +665,7 @@ int SearchEngine::getOptimalFinalActionIndex(State const& current) const {
     double reward = -numeric_limits<double>::max();
     double tmpReward = 0.0;
     int result = -1;
-    for (int index : candidatesForOptimalFinalAction) {
+    for (int index : task.candidatesForOptimalFinalAction) {
         if (applicableActions[index] == index) {
             calcReward(current, index, tmpReward);
             if (tmpReward > reward) {
@@ -570,7 +685,7 @@ void SearchEngine::stateWithoutApplicableActionsDetected(
            "applicable actions can be reached." << endl << "The following such "
            "state was encountered: " << endl << state.toString() << endl
         << "The following preconditions of each action are violated:" << endl;
-    for (ActionState const& action : SearchEngine::actionStates) {
+    for (ActionState const& action : task.actionStates) {
         out << action.toCompactString() << ": " << endl;
         for (DeterministicEvaluatable* precond : action.actionPreconditions) {
             double res = 0.0;
@@ -584,284 +699,3 @@ void SearchEngine::stateWithoutApplicableActionsDetected(
     }
     SystemUtils::abort(out.str());
 }
-
-/******************************************************************
-                   Statistics and Prints
-******************************************************************/
-
-void SearchEngine::printTask() {
-    std::cout.unsetf(std::ios::floatfield);
-    std::cout.precision(std::numeric_limits<double>::digits10);
-
-    Logger::logLine("----------------Actions---------------");
-    Logger::logLine();
-    Logger::logLine("Action fluents:");
-    for (ActionFluent const* af : actionFluents) {
-        Logger::logLine(af->name);
-    }
-    Logger::logSmallSeparator();
-    Logger::logLine();
-    Logger::logLine("Legal Action Combinations:");
-    for (ActionState const& state : actionStates) {
-        Logger::logLine(state.toString());
-        Logger::logSmallSeparator();
-    }
-
-    Logger::logLine();
-    Logger::logLine("-----------------CPFs-----------------");
-    Logger::logLine();
-
-    int numDetStateFluents = State::numberOfDeterministicStateFluents;
-    for (size_t index = 0; index < numDetStateFluents; ++index) {
-        printDeterministicCPFInDetail(index);
-        Logger::logSmallSeparator();
-    }
-
-    int numProbStateFluents = State::numberOfProbabilisticStateFluents;
-    for (size_t index = 0; index < numProbStateFluents; ++index) {
-        printProbabilisticCPFInDetail(index);
-        Logger::logSmallSeparator();
-    }
-    Logger::logLine();
-
-    Logger::logLine("Reward CPF:");
-    printRewardCPFInDetail();
-
-    Logger::logLine();
-    Logger::logLine("------State Fluent Hash Key Map-------");
-    Logger::logLine();
-
-    for (size_t index = 0; index < numDetStateFluents; ++index) {
-        Logger::log("a change of deterministic state fluent " +
-                    to_string(index) + " influences variables ");
-        vector<pair<int, long>> const& influencedVars =
-            State::stateFluentHashKeysOfDeterministicStateFluents[index];
-
-        for (pair<int, long> const& influencedVar : influencedVars) {
-            Logger::log(to_string(influencedVar.first) + " (" +
-                        to_string(influencedVar.second) + ") ");
-        }
-        Logger::logLine();
-    }
-    Logger::logLine();
-
-    for (size_t index = 0; index < numProbStateFluents; ++index) {
-        Logger::log("a change of probabilistic state fluent " +
-                    to_string(index) + " influences variables ");
-        vector<pair<int, long>> const& influencedVars =
-            State::stateFluentHashKeysOfProbabilisticStateFluents[index];
-
-        for (pair<int, long> const& influencedVar : influencedVars) {
-            Logger::log(to_string(influencedVar.first) + " (" +
-                        to_string(influencedVar.second) + ") ");
-        }
-        Logger::logLine();
-    }
-    Logger::logLine();
-
-    for (size_t index = 0; index < KleeneState::stateSize; ++index) {
-        Logger::log("a change of variable " + to_string(index) +
-                    " influences variables in Kleene states ");
-        vector<pair<int, long>> const& influencedVars =
-            KleeneState::indexToStateFluentHashKeyMap[index];
-
-        for (pair<int, long> const& influencedVar : influencedVars) {
-            Logger::log(to_string(influencedVar.first) + " (" +
-                        to_string(influencedVar.second) + ") ");
-        }
-        Logger::logLine();
-    }
-    Logger::logLine();
-
-    Logger::logLine();
-    Logger::logLine("---------Action Preconditions---------");
-    Logger::logLine();
-
-    for (size_t index = 0; index < actionPreconditions.size(); ++index) {
-        printActionPreconditionInDetail(index);
-        Logger::logSmallSeparator();
-    }
-
-    Logger::logLine();
-    Logger::logLine("----------Initial State---------------");
-    Logger::logLine();
-    Logger::logLine(initialState.toString());
-
-    if (State::stateHashingPossible) {
-        Logger::logLine("Hashing of States is possible.");
-    } else {
-        Logger::logLine("Hashing of States is not possible.");
-    }
-    if (KleeneState::stateHashingPossible) {
-        Logger::logLine("Hashing of KleeneStates is possible.");
-    } else {
-        Logger::logLine("Hashing of KleeneStates is not possible.");
-    }
-
-
-    if (rewardLockDetected) {
-        if (goalTestActionIndex >= 0) {
-            Logger::logLine(
-                "A goal and a dead end were found in the training phase.");
-        } else {
-            Logger::logLine(
-                "A dead end but no goal was found in the training phase.");
-        }
-    } else {
-        Logger::logLine("No reward locks detected in the training phase.");
-    }
-
-    if (ProbabilisticSearchEngine::hasUnreasonableActions &&
-        DeterministicSearchEngine::hasUnreasonableActions) {
-        Logger::logLine("This task contains unreasonable actions.");
-    } else if (ProbabilisticSearchEngine::hasUnreasonableActions) {
-        assert(false);
-    } else if (DeterministicSearchEngine::hasUnreasonableActions) {
-        Logger::logLine(
-            "Only the determinization contains unreasonable actions.");
-    } else {
-        Logger::logLine("This task does not contain unreasonable actions.");
-    }
-    Logger::logLine();
-}
-
-void SearchEngine::printDeterministicCPFInDetail(int index) {
-    printEvaluatableInDetail(deterministicCPFs[index]);
-    Logger::logLine();
-
-    Logger::log("  Domain: ");
-    for (std::string const& val : deterministicCPFs[index]->head->values) {
-        Logger::log(val + " ");
-    }
-    Logger::logLine();
-
-    if (State::stateHashingPossible) {
-        Logger::log("  HashKeyBase: ");
-        std::vector<long> const& stateHashKeys =
-            State::stateHashKeysOfDeterministicStateFluents[index];
-        for (size_t i = 0; i < stateHashKeys.size(); ++i) {
-            Logger::log(to_string(i) + ": " + to_string(stateHashKeys[i]));
-            if (i != stateHashKeys.size() - 1) {
-                Logger::log(", ");
-            } else {
-                Logger::logLine();
-            }
-        }
-    }
-
-    if (KleeneState::stateHashingPossible) {
-        Logger::logLine("  KleeneHashKeyBase: " +
-                    to_string(KleeneState::hashKeyBases[index]));
-    }
-}
-
-void SearchEngine::printProbabilisticCPFInDetail(int index) {
-    printEvaluatableInDetail(probabilisticCPFs[index]);
-    Logger::logLine();
-
-    Logger::logLine("  Determinized formula: ");
-
-    // TODO: Replace print() method with toString()
-    stringstream ss;
-    determinizedCPFs[index]->formula->print(ss);
-    ss << endl;
-    Logger::logLine(ss.str());
-
-    Logger::log("  Domain: ");
-    for (std::string const& val : probabilisticCPFs[index]->head->values) {
-        Logger::log(val + " ");
-    }
-    Logger::logLine();
-
-    if (State::stateHashingPossible) {
-        Logger::log("  HashKeyBase: ");
-        std::vector<long> const& stateHashKeys =
-            State::stateHashKeysOfProbabilisticStateFluents[index];
-        for (size_t i = 0; i < stateHashKeys.size(); ++i) {
-            Logger::log(to_string(i) + ": " + to_string(stateHashKeys[i]));
-            if (i != stateHashKeys.size() - 1) {
-                Logger::log(", ");
-            } else {
-                Logger::logLine();
-            }
-        }
-    }
-
-    if (KleeneState::stateHashingPossible) {
-        index += State::numberOfDeterministicStateFluents;
-        Logger::logLine("  KleeneHashKeyBase: " +
-                    to_string(KleeneState::hashKeyBases[index]));
-    }
-}
-
-void SearchEngine::printRewardCPFInDetail() {
-    printEvaluatableInDetail(rewardCPF);
-
-    Logger::logLine("Minimal reward: " + to_string(rewardCPF->getMinVal()));
-    Logger::logLine("Maximal reward: " + to_string(rewardCPF->getMaxVal()));
-    Logger::logLine("Is action independent: " + to_string(rewardCPF->isActionIndependent()));
-    Logger::logLine();
-}
-
-void SearchEngine::printActionPreconditionInDetail(int index) {
-    printEvaluatableInDetail(actionPreconditions[index]);
-    Logger::logLine();
-}
-
-void SearchEngine::printEvaluatableInDetail(Evaluatable* eval) {
-    Logger::logLine(eval->name);
-    Logger::log("  HashIndex: " + to_string(eval->hashIndex) + ",");
-
-    if (!eval->isProbabilistic()) {
-        Logger::log(" deterministic,");
-    } else {
-        Logger::log(" probabilistic,");
-    }
-
-    switch (eval->cachingType) {
-    case Evaluatable::NONE:
-        Logger::log(" no caching,");
-        break;
-    case Evaluatable::MAP:
-    case Evaluatable::DISABLED_MAP:
-        Logger::log(" caching in maps,");
-        break;
-    case Evaluatable::VECTOR:
-        Logger::log(" caching in vectors,");
-        break;
-    }
-
-    switch (eval->kleeneCachingType) {
-    case Evaluatable::NONE:
-        Logger::log(" no Kleene caching.");
-        break;
-    case Evaluatable::MAP:
-    case Evaluatable::DISABLED_MAP:
-        Logger::log(" Kleene caching in maps.");
-        break;
-    case Evaluatable::VECTOR:
-        Logger::log(" Kleene caching in vectors of size " +
-                    to_string(eval->kleeneEvaluationCacheVector.size()) + ".");
-        break;
-    }
-    Logger::logLine();
-    Logger::logLine();
-
-    if (!eval->actionHashKeyMap.empty()) {
-        Logger::logLine("  Action Hash Key Map:");
-        for (size_t i = 0; i < eval->actionHashKeyMap.size(); ++i) {
-            if (eval->actionHashKeyMap[i] != 0) {
-                Logger::logLine("    " + actionStates[i].toCompactString() +
-                                " : " + to_string(eval->actionHashKeyMap[i]));
-            }
-        }
-    } else {
-        Logger::logLine("  Has no positive dependencies on actions.");
-    }
-
-    // TODO: Replace print() method with toString()
-    stringstream ss;
-    ss << "  Formula: " << endl;
-    eval->formula->print(ss);
-    Logger::logLine(ss.str());
-}
@@ -11,18 +11,24 @@
 // DeterministicSearchEngine. These implement the state transition functions
 // correspondingly.
 
-#include "evaluatables.h"
+#include "planning_task.h"
 
 #include "utils/logger.h"
+#include "utils/profiler.h"
 
 #include <fdd.h>
 
+#include <functional>
+#include <string>
+
+class PersistentCache;
+
 class SearchEngine {
 public:
     virtual ~SearchEngine() {}
 
-    // Create a SearchEngine
-    static SearchEngine* fromString(std::string& desc);
+    // Create a SearchEngine that solves task
+    static SearchEngine* fromString(std::string& desc, PlanningTask& task);
 
     // Set parameters from command line
     virtual bool setValueFromString(std::string& param, std::string& value);
@@ -34,6 +40,20 @@ public:
         cachingEnabled = false;
     }
 
+    // Restores the entries of caches of this search engine from a persistent
+    // cache or adds them to it. Overwrite this if your search engine (or a
+    // component) uses a cache that is worth keeping across sessions.
+    virtual void loadCaches(PersistentCache const& /*cache*/) {}
+    virtual void storeCaches(PersistentCache& /*cache*/) const {}
+
+    // Returns a description of the configuration that the cached values of
+    // this search engine depend on (a persistent cache is only used by search
+    // engines with the same configuration). Overwrite this if your search
+    // engine has a component whose configuration matters.
+    virtual std::string getCacheConfig() const {
+        return name + " -sd " + std::to_string(maxSearchDepth);
+    }
+
     // TODO: For now, this is only here to set the timeout from ProstPlanner
     // (necessary for IPC 2014). Generally, I'd like a TerminationManager class
     // that administrates termination criteria for each kind of search engine.
@@ -41,12 +61,24 @@ public:
         timeout = _timeout;
     }
 
+    // If the decision in the current state is close when the timeout is
+    // reached, i.e., if the estimated values of the two best actions differ
+    // by at most closeDecisionGap times the absolute value of the best one,
+    // the search may be continued until maxTimeout seconds have passed. This
+    // is only supported by THTS, and it is disabled if maxTimeout is not
+    // larger than timeout.
+    virtual void setTimeoutExtension(double _maxTimeout,
+                                     double _closeDecisionGap) {
+        maxTimeout = _maxTimeout;
+        closeDecisionGap = _closeDecisionGap;
+    }
+
     virtual void setUseRewardLockDetection(bool _useRewardLockDetection) {
         useRewardLockDetection = _useRewardLockDetection;
         if (useRewardLockDetection) {
-            goalTestActionIndex = 0;
+            task.goalTestActionIndex = 0;
         } else {
-            goalTestActionIndex = -1;
+            task.goalTestActionIndex = -1;
         }
     }
 
@@ -63,13 +95,16 @@ public:
     }
 
 protected:
-    SearchEngine(std::string _name)
-        : name(_name),
+    SearchEngine(std::string _name, PlanningTask& _task)
+        : task(_task),
+          name(_name),
           cachingEnabled(true),
-          useRewardLockDetection(SearchEngine::rewardLockDetected),
+          useRewardLockDetection(task.rewardLockDetected),
           cacheRewardLocks(true),
-          maxSearchDepth(horizon),
-          timeout(1.0) {}
+          maxSearchDepth(task.horizon),
+          timeout(1.0),
+          maxTimeout(0.0),
+          closeDecisionGap(0.0) {}
 
     /*****************************************************************
                          Main search functions
@@ -104,6 +139,13 @@ public:
                                  std::vector<int> const& actionsToExpand,
                                  std::vector<double>& qValues) = 0;
 
+    // Continue the search after the action with index submittedActionIndex
+    // has been submitted (i.e., while the environment computes its outcome)
+    // until stop returns true. Search engines that don't search speculatively
+    // return immediately.
+    virtual void searchSpeculatively(int /*submittedActionIndex*/,
+                                     std::function<bool()> const& /*stop*/) {}
+
     // Methods for action applicability and pruning
     virtual std::vector<int> getApplicableActions(State const& state) const = 0;
 
@@ -131,7 +173,8 @@ protected:
     // identical for probabilistic and deterministic search engines)
     void calcReward(State const& current, int const& actionIndex,
                     double& reward) const {
-        rewardCPF->evaluate(reward, current, actionStates[actionIndex]);
+        task.rewardCPF->evaluate(reward, current,
+                                 task.actionStates[actionIndex]);
     }
 
     // As we are currently assuming that the reward is independent of the
@@ -159,6 +202,18 @@ protected:
         return true;
     }
 
+    // Writes the state fluent hash keys of all evaluatables in
+    // actionDependentHashIndices to key
+    void calcActionEquivalenceKey(State const& state,
+                                  std::vector<long>& key) const {
+        assert(task.actionEquivalenceKeysPossible);
+        std::vector<int> const& hashIndices = task.actionDependentHashIndices;
+        key.resize(hashIndices.size());
+        for (size_t i = 0; i < hashIndices.size(); ++i) {
+            key[i] = state.stateFluentHashKey(hashIndices[i]);
+        }
+    }
+
     /*****************************************************************
                                  Parameter
     *****************************************************************/
@@ -183,83 +238,24 @@ public:
         return maxSearchDepth;
     }
 
+    // Returns the number of trials that have been performed in the current
+    // step (this is only meaningful for trial-based search engines)
+    virtual int getNumberOfTrials() const {
+        return 0;
+    }
+
+    PlanningTask& getTask() const {
+        return task;
+    }
+
     /*****************************************************************
                              Member variables
     *****************************************************************/
 
-public:
-    // The name of this task (this is equivalent to the instance name)
-    static std::string taskName;
-
-    // Random set of reachable states (these are used for learning)
-    static std::vector<State> trainingSet;
-
-    // Action fluents and action states
-    static std::vector<ActionFluent*> actionFluents;
-    static std::vector<ActionState> actionStates;
-
-    // State fluents
-    static std::vector<StateFluent*> stateFluents;
-
-    // Transition functions of state fluents
-    static std::vector<Evaluatable*> allCPFs;
-    static std::vector<DeterministicCPF*> deterministicCPFs;
-    static std::vector<ProbabilisticCPF*> probabilisticCPFs;
-
-    // Determinized transition functions of probabilistic state fluents
-    static std::vector<DeterministicCPF*> determinizedCPFs;
-
-    // The reward formula
-    static RewardFunction* rewardCPF;
-
-    // The action preconditions
-    static std::vector<DeterministicEvaluatable*> actionPreconditions;
-
-    // Is true if this planning task is deterministic
-    static bool taskIsDeterministic;
-
-    // The initial state (the one given in the problem description,
-    // this is not updated)
-    static State initialState;
-
-    // The problem horizon
-    static int horizon;
-
-    // The problem's discount factor (TODO: This is ignored at the moment)
-    static double discountFactor;
-
-    // The number of actions (this is equal to actionStates.size())
-    static int numberOfActions;
-
-    // Since the reward is independent from the successor state, we can
-    // calculate the final reward as the maximum of applying all actions in the
-    // current state. Since the set of actions that could maximize the final
-    // reward can be a subset of all actions, we distinguish between several
-    // different methods to speed up this calculation.
-    static std::vector<int> candidatesForOptimalFinalAction;
-
-    // Is true if applicable actions should be cached
-    static bool cacheApplicableActions;
-
-    // Is true if a reward lock was detected in the training phase
-    static bool rewardLockDetected;
-
-    // The index of this action is used to check if a state is a goal
-    static int goalTestActionIndex;
-
-    // The BDDs where dead ends and goals are cached
-    static bdd cachedDeadEnds;
-    static bdd cachedGoals;
-
-    typedef std::unordered_map<State, double, State::HashWithRemSteps,
-                               State::EqualWithRemSteps>
-        StateValueHashMap;
-    typedef std::unordered_map<State, std::vector<int>,
-                               State::HashWithoutRemSteps,
-                               State::EqualWithoutRemSteps>
-        ActionHashMap;
-
 protected:
+    // The task this search engine works on
+    PlanningTask& task;
+
     // Name, used for output only
     std::string name;
 
@@ -269,6 +265,8 @@ protected:
     bool cacheRewardLocks;
     int maxSearchDepth;
     double timeout;
+    double maxTimeout;
+    double closeDecisionGap;
 
     /*****************************************************************
                            Printing and statistics
@@ -279,22 +277,6 @@ public:
     virtual void printConfig(std::string indent) const;
     virtual void printRoundStatistics(std::string indent) const = 0;
     virtual void printStepStatistics(std::string indent) const = 0;
-
-    static void printDeadEndBDD() {
-        bdd_printdot(cachedDeadEnds);
-    }
-
-    static void printGoalBDD() {
-        bdd_printdot(cachedGoals);
-    }
-
-    // Print task
-    static void printTask();
-    static void printEvaluatableInDetail(Evaluatable* eval);
-    static void printDeterministicCPFInDetail(int index);
-    static void printProbabilisticCPFInDetail(int index);
-    static void printRewardCPFInDetail();
-    static void printActionPreconditionInDetail(int index);
 };
 
 /*****************************************************************
@@ -303,16 +285,14 @@ public:
 
 class ProbabilisticSearchEngine : public SearchEngine {
 public:
-    ProbabilisticSearchEngine(std::string _name) : SearchEngine(_name) {}
-
-    // Is true if unreasonable actions where detected during learning
-    static bool hasUnreasonableActions;
-
-    // Cache for state values of solved states
-    static StateValueHashMap stateValueCache;
-
-    // Cache for applicable reasonable actions
-    static ActionHashMap applicableActionsCache;
+    ProbabilisticSearchEngine(std::string _name, PlanningTask& _task)
+        : SearchEngine(_name, _task),
+          numRewardLockChecks(0),
+          numRewardLockCacheHits(0),
+          numRewardLockBDDHits(0),
+          numRewardLocks(0),
+          rewardLockDetectionTime(0.0),
+          caches(task.probabilisticCaches) {}
 
     /*****************************************************************
                  Calculation of applicable actions
@@ -324,42 +304,22 @@ public:
     // action with index res[i] leads to the same distribution over successor
     // states (this is only checked if pruneUnreasonableActions is true).
     std::vector<int> getApplicableActions(State const& state) const override {
-        std::vector<int> res(numberOfActions, 0);
+        std::vector<int> res(task.numberOfActions, 0);
 
-        ActionHashMap::iterator it = applicableActionsCache.find(state);
-        if (it != applicableActionsCache.end()) {
+        PlanningTask::ActionHashMap::iterator it =
+            caches.applicableActionsCache.find(state);
+        if (it != caches.applicableActionsCache.end()) {
             assert(it->second.size() == res.size());
             for (size_t i = 0; i < res.size(); ++i) {
                 res[i] = it->second[i];
             }
         } else {
             bool applicableActionExists = false;
-            if (hasUnreasonableActions) {
-                std::map<PDState, int, PDState::PDStateCompare> childStates;
-
-                for (size_t index = 0; index < numberOfActions; ++index) {
-                    if (actionIsApplicable(actionStates[index], state)) {
-                        applicableActionExists = true;
-                        // This action is applicable
-                        PDState nxt(state.stepsToGo() - 1);
-                        calcSuccessorState(state, index, nxt);
-
-                        if (childStates.find(nxt) == childStates.end()) {
-                            // This action is reasonable
-                            childStates[nxt] = index;
-                            res[index] = index;
-                        } else {
-                            // This action is not reasonable
-                            res[index] = childStates[nxt];
-                        }
-                    } else {
-                        // This action is not appicable
-                        res[index] = -1;
-                    }
-                }
+            if (task.hasUnreasonableActions) {
+                applicableActionExists = calcReasonableActions(state, res);
             } else {
-                for (size_t index = 0; index < numberOfActions; ++index) {
-                    if (actionIsApplicable(actionStates[index], state)) {
+                for (size_t index = 0; index < task.numberOfActions; ++index) {
+                    if (actionIsApplicable(task.actionStates[index], state)) {
                         applicableActionExists = true;
                         res[index] = index;
                     } else {
@@ -372,14 +332,19 @@ public:
                 stateWithoutApplicableActionsDetected(state);
             }
 
-            if (cacheApplicableActions) {
-                applicableActionsCache[state] = res;
+            if (task.cacheApplicableActions) {
+                caches.applicableActionsCache[state] = res;
             }
         }
 
         return res;
     }
 
+private:
+    // Writes applicable and reasonable actions to res as described above and
+    // returns true if there is at least one applicable action
+    bool calcReasonableActions(State const& state, std::vector<int>& res) const;
+
 protected:
     /*****************************************************************
                     Calculation of state transition
@@ -388,18 +353,19 @@ protected:
     // Apply action 'actionIndex' to 'current', resulting in 'next'
     void calcSuccessorState(State const& current, int const& actionIndex,
                             PDState& next) const {
-        for (int index = 0; index < State::numberOfDeterministicStateFluents;
+        PROFILE_PHASE(SUCCESSOR_STATE);
+        for (int index = 0; index < State::numberOfDeterministicStateFluents();
              ++index) {
-            deterministicCPFs[index]->evaluate(
+            task.deterministicCPFs[index]->evaluate(
                 next.deterministicStateFluent(index), current,
-                actionStates[actionIndex]);
+                task.actionStates[actionIndex]);
         }
 
-        for (int index = 0; index < State::numberOfProbabilisticStateFluents;
+        for (int index = 0; index < State::numberOfProbabilisticStateFluents();
              ++index) {
-            probabilisticCPFs[index]->evaluate(
+            task.probabilisticCPFs[index]->evaluate(
                 next.probabilisticStateFluentAsPD(index), current,
-                actionStates[actionIndex]);
+                task.actionStates[actionIndex]);
         }
     }
 
@@ -410,16 +376,22 @@ protected:
     // Calculate successor in Kleene logic
     void calcKleeneSuccessor(KleeneState const& current, int const& actionIndex,
                              KleeneState& next) const {
-        for (size_t i = 0; i < KleeneState::stateSize; ++i) {
-            allCPFs[i]->evaluateToKleene(next[i], current,
-                                         actionStates[actionIndex]);
+        for (size_t i = 0; i < KleeneState::stateSize(); ++i) {
+            if (KleeneState::usesBitset(i)) {
+                task.allCPFs[i]->evaluateToKleene(
+                    next.bits(i), current, task.actionStates[actionIndex]);
+            } else {
+                task.allCPFs[i]->evaluateToKleene(
+                    next.values(i), current, task.actionStates[actionIndex]);
+            }
         }
     }
 
     // Calulate the reward in Kleene logic
     void calcKleeneReward(KleeneState const& current, int const& actionIndex,
                           std::set<double>& reward) const {
-        rewardCPF->evaluateToKleene(reward, current, actionStates[actionIndex]);
+        task.rewardCPF->evaluateToKleene(reward, current,
+                                         task.actionStates[actionIndex]);
     }
 
     /*****************************************************************
@@ -431,20 +403,40 @@ protected:
     // maximal reward).
     bool isARewardLock(State const& current) const;
 
+    void resetRewardLockStatistics() {
+        numRewardLockChecks = 0;
+        numRewardLockCacheHits = 0;
+        numRewardLockBDDHits = 0;
+        numRewardLocks = 0;
+        rewardLockDetectionTime = 0.0;
+    }
+
     void printStateValueCacheUsage(
         std::string indent, Verbosity verbosity = Verbosity::VERBOSE) const;
     void printApplicableActionCacheUsage(
         std::string indent, Verbosity verbosity = Verbosity::VERBOSE) const;
+    void printRewardLockStatistics(
+        std::string indent, Verbosity verbosity = Verbosity::VERBOSE) const;
+
+    // Per step statistics of reward lock detection
+    mutable int numRewardLockChecks;
+    mutable int numRewardLockCacheHits;
+    mutable int numRewardLockBDDHits;
+    mutable int numRewardLocks;
+    mutable double rewardLockDetectionTime;
+
+    // The caches that are shared with the other probabilistic search engines
+    PlanningTask::SearchCaches& caches;
 
 private:
     // Methods for reward lock detection
-    bool checkDeadEnd(KleeneState const& state) const;
+    bool checkRewardLock(State const& current) const;
+    bool checkDeadEnd(KleeneState const& state, bdd& newDeadEnds) const;
     bool checkGoal(KleeneState const& state) const;
 
     // BDD related methods
     bdd stateToBDD(KleeneState const& state) const;
-    bdd stateToBDD(State const& state) const;
-    bool BDDIncludes(bdd BDD, KleeneState const& state) const;
+    bool BDDIncludes(bdd const& BDD, State const& state) const;
 };
 
 /*****************************************************************
@@ -453,16 +445,8 @@ private:
 
 class DeterministicSearchEngine : public SearchEngine {
 public:
-    DeterministicSearchEngine(std::string _name) : SearchEngine(_name) {}
-
-    // Is true if unreasonable actions where detected during learning
-    static bool hasUnreasonableActions;
-
-    // Cache for state values of solved states
-    static StateValueHashMap stateValueCache;
-
-    // Cache for applicable reasonable actions
-    static ActionHashMap applicableActionsCache;
+    DeterministicSearchEngine(std::string _name, PlanningTask& _task)
+        : SearchEngine(_name, _task), caches(task.deterministicCaches) {}
 
 protected:
     /*****************************************************************
@@ -481,18 +465,19 @@ protected:
     // in 'next'.
     void calcSuccessorState(State const& current, int const& actionIndex,
                             State& next) const {
-        for (size_t index = 0; index < State::numberOfDeterministicStateFluents;
-             ++index) {
-            deterministicCPFs[index]->evaluate(
+        PROFILE_PHASE(SUCCESSOR_STATE);
+        for (size_t index = 0;
+             index < State::numberOfDeterministicStateFluents(); ++index) {
+            task.deterministicCPFs[index]->evaluate(
                 next.deterministicStateFluent(index), current,
-                actionStates[actionIndex]);
+                task.actionStates[actionIndex]);
         }
 
-        for (size_t index = 0; index < State::numberOfProbabilisticStateFluents;
-             ++index) {
-            determinizedCPFs[index]->evaluate(
+        for (size_t index = 0;
+             index < State::numberOfProbabilisticStateFluents(); ++index) {
+            task.determinizedCPFs[index]->evaluate(
                 next.probabilisticStateFluent(index), current,
-                actionStates[actionIndex]);
+                task.actionStates[actionIndex]);
         }
 
         State::calcStateFluentHashKeys(next);
@@ -509,44 +494,22 @@ protected:
     // action with index res[i] leads to the same distribution over successor
     // states (this is only checked if pruneUnreasonableActions is true).
     std::vector<int> getApplicableActions(State const& state) const override {
-        std::vector<int> res(numberOfActions, 0);
+        std::vector<int> res(task.numberOfActions, 0);
 
-        ActionHashMap::iterator it = applicableActionsCache.find(state);
-        if (it != applicableActionsCache.end()) {
+        PlanningTask::ActionHashMap::iterator it =
+            caches.applicableActionsCache.find(state);
+        if (it != caches.applicableActionsCache.end()) {
             assert(it->second.size() == res.size());
             for (size_t i = 0; i < res.size(); ++i) {
                 res[i] = it->second[i];
             }
         } else {
             bool applicableActionExists = false;
-            if (hasUnreasonableActions) {
-                std::map<State, int, State::CompareIgnoringStepsToGo>
-                    childStates;
-
-                for (size_t index = 0; index < numberOfActions; ++index) {
-                    if (actionIsApplicable(actionStates[index], state)) {
-                        applicableActionExists = true;
-                        // This action is applicable
-                        State nxt;
-                        calcSuccessorState(state, index, nxt);
-                        State::calcStateHashKey(nxt);
-
-                        if (childStates.find(nxt) == childStates.end()) {
-                            // This action is reasonable
-                            childStates[nxt] = index;
-                            res[index] = index;
-                        } else {
-                            // This action is not reasonable
-                            res[index] = childStates[nxt];
-                        }
-                    } else {
-                        // This action is not appicable
-                        res[index] = -1;
-                    }
-                }
+            if (task.determinizationHasUnreasonableActions) {
+                applicableActionExists = calcReasonableActions(state, res);
             } else {
-                for (size_t index = 0; index < numberOfActions; ++index) {
-                    if (actionIsApplicable(actionStates[index], state)) {
+                for (size_t index = 0; index < task.numberOfActions; ++index) {
+                    if (actionIsApplicable(task.actionStates[index], state)) {
                         applicableActionExists = true;
                         res[index] = index;
                     } else {
@@ -559,8 +522,8 @@ protected:
                 stateWithoutApplicableActionsDetected(state);
             }
 
-            if (cacheApplicableActions) {
-                applicableActionsCache[state] = res;
+            if (task.cacheApplicableActions) {
+                caches.applicableActionsCache[state] = res;
             }
         }
         return res;
@@ -570,6 +533,14 @@ protected:
         std::string indent, Verbosity verbosity = Verbosity::VERBOSE) const;
     void printApplicableActionCacheUsage(
         std::string indent, Verbosity verbosity = Verbosity::VERBOSE) const;
+
+    // The caches that are shared with the other deterministic search engines
+    PlanningTask::SearchCaches& caches;
+
+private:
+    // Writes applicable and reasonable actions to res as described above and
+    // returns true if there is at least one applicable action
+    bool calcReasonableActions(State const& state, std::vector<int>& res) const;
 };
 
 #endif
@@ -0,0 +1,99 @@
+#include "simulator.h"
+
+#include "planning_task.h"
+
+#include "utils/math_utils.h"
+#include "utils/system_utils.h"
+
+using namespace std;
+
+Simulator::Simulator(PlanningTask const& _task, int seed)
+    : task(_task),
+      currentState(State::numberOfDeterministicStateFluents() +
+                   State::numberOfProbabilisticStateFluents()) {
+    rnd.seed(seed);
+}
+
+void Simulator::initRound() {
+    for (size_t i = 0; i < State::numberOfDeterministicStateFluents(); ++i) {
+        currentState[i] =
+            task.initialState.deterministicStateFluent(i);
+    }
+    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents(); ++i) {
+        currentState[State::numberOfDeterministicStateFluents() + i] =
+            task.initialState.probabilisticStateFluent(i);
+    }
+}
+
+double Simulator::applyAction(int actionIndex) {
+    State current(currentState, -1);
+    State::calcStateFluentHashKeys(current);
+    State::calcStateHashKey(current);
+    ActionState const& action = task.actionStates[actionIndex];
+
+    double reward = 0.0;
+    task.rewardCPF->evaluate(reward, current, action);
+
+    for (size_t i = 0; i < State::numberOfDeterministicStateFluents(); ++i) {
+        task.deterministicCPFs[i]->evaluate(currentState[i], current,
+                                                     action);
+    }
+
+    // The outcomes of probabilistic state fluents are sampled with the random
+    // number generator of the simulator and not with the one of the planner
+    DiscretePD pd;
+    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents(); ++i) {
+        pd.reset();
+        task.probabilisticCPFs[i]->evaluate(pd, current, action);
+        assert(pd.isWellDefined());
+        double randNum = rnd.genDouble(0.0, 1.0);
+        double probSum = 0.0;
+        size_t outcome = 0;
+        for (; outcome < pd.size() - 1; ++outcome) {
+            probSum += pd.probabilities[outcome];
+            if (MathUtils::doubleIsSmallerOrEqual(randNum, probSum)) {
+                break;
+            }
+        }
+        currentState[State::numberOfDeterministicStateFluents() + i] =
+            pd.values[outcome];
+    }
+    return reward;
+}
+
+bool Simulator::actionIsApplicable(int actionIndex) const {
+    State current(currentState, -1);
+    State::calcStateFluentHashKeys(current);
+    State::calcStateHashKey(current);
+    ActionState const& action = task.actionStates[actionIndex];
+
+    double res = 0.0;
+    for (DeterministicEvaluatable* precond : action.actionPreconditions) {
+        precond->evaluate(res, current, action);
+        if (MathUtils::doubleIsEqual(res, 0.0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int Simulator::getNoopIndex() const {
+    for (ActionState const& action : task.actionStates) {
+        if (action.isNoop) {
+            return action.index;
+        }
+    }
+    return -1;
+}
+
+string Simulator::readRDDLFiles(vector<string> const& files) {
+    string res;
+    for (string file : files) {
+        string content;
+        if (!SystemUtils::readFile(file, content)) {
+            SystemUtils::abort("Error: Unable to read RDDL file: " + file);
+        }
+        res += content;
+    }
+    return res;
+}
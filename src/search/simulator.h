@@ -0,0 +1,54 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+/*
+  The simulator simulates the environment of the parsed task with the CPFs and
+  the reward function of the task. It is used by the local simulation and by
+  the simulator server. Since the simulator uses its own random number
+  generator, the sequence of states is reproducible for a fixed seed if the
+  same actions are applied.
+*/
+
+#include "utils/random.h"
+
+#include <string>
+#include <vector>
+
+class PlanningTask;
+
+class Simulator {
+public:
+    Simulator(PlanningTask const& _task, int seed);
+
+    // Reset the current state to the initial state
+    void initRound();
+
+    // Apply the action with index actionIndex to the current state, sample the
+    // successor state and return the immediate reward
+    double applyAction(int actionIndex);
+
+    // Returns true if all preconditions of the action with index actionIndex
+    // are satisfied in the current state
+    bool actionIsApplicable(int actionIndex) const;
+
+    // Returns the index of the action without scheduled action fluents or -1
+    // if there is no such action
+    int getNoopIndex() const;
+
+    // Reads the given RDDL files and concatenates their content
+    static std::string readRDDLFiles(std::vector<std::string> const& files);
+
+    // The values of all state fluents in the current state, where the
+    // deterministic state fluents come before the probabilistic ones (this is
+    // the representation that is expected by ProstPlanner::initStep)
+    std::vector<double> const& getCurrentState() const {
+        return currentState;
+    }
+
+private:
+    PlanningTask const& task;
+    std::vector<double> currentState;
+    RandomMT rnd;
+};
+
+#endif // SIMULATOR_H
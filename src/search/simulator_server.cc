@@ -0,0 +1,406 @@
+#include "simulator_server.h"
+
+#include "parser.h"
+#include "planning_task.h"
+#include "simulator.h"
+
+#include "utils/base64.h"
+#include "utils/logger.h"
+#include "utils/stopwatch.h"
+#include "utils/string_utils.h"
+#include "utils/strxml.h"
+#include "utils/system_utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <dirent.h>
+#include <limits>
+#include <regex>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+// Removes all whitespace and the null character that is appended by
+// XMLNode::getText from the given string
+string normalize(string s) {
+    s.erase(remove_if(s.begin(), s.end(),
+                      [](char c) { return isspace(c) || (c == '\0'); }),
+            s.end());
+    return s;
+}
+
+void addElement(stringstream& os, string const& element, string const& text) {
+    os << "<" << element << ">" << text << "</" << element << ">";
+}
+} // namespace
+
+SimulatorServer::SimulatorServer(string _benchmarkDir, unsigned short _port,
+                                 int _numberOfRounds, int _seed,
+                                 long _totalTime, int _numberOfSessions,
+                                 string _parserOptions)
+    : benchmarkDir(_benchmarkDir),
+      port(_port),
+      numberOfRounds(_numberOfRounds),
+      seed(_seed),
+      totalTime(_totalTime),
+      numberOfSessions(_numberOfSessions),
+      parserOptions(_parserOptions),
+      socket(-1),
+      usedTime(0),
+      totalReward(0.0) {}
+
+// This destructor is required here to allow forward declaration of
+// PlanningTask and Simulator in header because of usage of unique_ptr
+SimulatorServer::~SimulatorServer() = default;
+
+void SimulatorServer::run() {
+    int serverSocket = SystemUtils::listenOnPort(port);
+    Logger::logLine("Simulator server is listening on port " + to_string(port),
+                    Verbosity::SILENT);
+
+    int session = 0;
+    while ((numberOfSessions == 0) || (session < numberOfSessions)) {
+        int clientSocket = ::accept(serverSocket, nullptr, nullptr);
+        if (clientSocket == -1) {
+            continue;
+        }
+        ++session;
+
+        // Each session is handled by a child process, such that the static
+        // members that describe the task are not shared between sessions
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(serverSocket);
+            socket = clientSocket;
+            runSession();
+            close(socket);
+            _exit(0);
+        } else if (pid == -1) {
+            SystemUtils::abort("Error: creating session process failed.");
+        }
+        close(clientSocket);
+
+        // Clean up finished sessions
+        while (waitpid(-1, nullptr, WNOHANG) > 0) {
+        }
+    }
+
+    // Wait until all sessions are finished
+    while (wait(nullptr) > 0) {
+    }
+    close(serverSocket);
+}
+
+/******************************************************************************
+                     Session and rounds management
+******************************************************************************/
+
+void SimulatorServer::runSession() {
+    initSession();
+
+    for (int currentRound = 0; currentRound < numberOfRounds; ++currentRound) {
+        initRound(currentRound);
+        double roundReward = 0.0;
+
+        for (int turn = 1; turn <= task->horizon; ++turn) {
+            int actionIndex = receiveAction();
+            double immediateReward = simulator->applyAction(actionIndex);
+            roundReward += immediateReward;
+
+            if (turn == task->horizon) {
+                finishRound(currentRound, immediateReward, roundReward);
+            } else {
+                sendTurn(turn + 1, immediateReward);
+            }
+        }
+        totalReward += roundReward;
+    }
+
+    finishSession();
+}
+
+void SimulatorServer::initSession() {
+    XMLNode const* request = receiveMessage();
+    if (!request || request->getName() != "session-request" ||
+        !request->dissect("problem-name", instanceName)) {
+        SystemUtils::abort("Error: session request insufficient.");
+    }
+    instanceName = normalize(instanceName);
+    if (request->dissect("client-name", clientName)) {
+        clientName = normalize(clientName);
+    }
+    delete request;
+
+    Logger::logLine("Starting session with " + clientName + " on " +
+                    instanceName, Verbosity::SILENT);
+
+    string taskDesc = Simulator::readRDDLFiles(findRDDLFiles(instanceName));
+    map<string, int> stateVariableIndices;
+    vector<vector<string>> stateVariableValues;
+    task = std::unique_ptr<PlanningTask>(new PlanningTask());
+    Parser::parseRDDLTask(*task, taskDesc, parserOptions, stateVariableIndices,
+                          stateVariableValues);
+    simulator = std::unique_ptr<Simulator>(new Simulator(*task, seed));
+
+    for (ActionState const& action : task->actionStates) {
+        vector<string> names = action.getScheduledActionFluentNames();
+        transform(names.begin(), names.end(), names.begin(),
+                  normalize);
+        sort(names.begin(), names.end());
+        actionIndices[names] = action.index;
+    }
+
+    stringstream os;
+    os << "<session-init>"
+       << "<task>" << encodeBase64(taskDesc) << "</task>"
+       << "<session-id>" << getpid() << "</session-id>"
+       << "<num-rounds>" << numberOfRounds << "</num-rounds>"
+       << "<time-allowed>" << getRemainingTime() << "</time-allowed>"
+       << "</session-init>";
+    sendMessage(os.str());
+}
+
+void SimulatorServer::finishSession() {
+    stringstream os;
+    os << "<session-end>"
+       << "<instance-name>" << instanceName << "</instance-name>"
+       << "<total-reward>" << totalReward << "</total-reward>"
+       << "<rounds-used>" << numberOfRounds << "</rounds-used>"
+       << "<time-used>" << usedTime << "</time-used>"
+       << "<client-name>" << clientName << "</client-name>"
+       << "<session-id>" << getpid() << "</session-id>"
+       << "<time-left>" << getRemainingTime() << "</time-left>"
+       << "</session-end>";
+    sendMessage(os.str());
+
+    Logger::logLine("Finished session with " + clientName + " on " +
+                    instanceName + " -- total reward: " +
+                    to_string(totalReward), Verbosity::SILENT);
+}
+
+void SimulatorServer::initRound(int currentRound) {
+    XMLNode const* request = receiveMessage();
+    if (!request || request->getName() != "round-request") {
+        SystemUtils::abort("Error: round request insufficient.");
+    }
+    delete request;
+
+    simulator->initRound();
+
+    stringstream os;
+    os << "<round-init>"
+       << "<round-num>" << (currentRound + 1) << "</round-num>"
+       << "<time-left>" << getRemainingTime() << "</time-left>"
+       << "<rounds-left>" << (numberOfRounds - currentRound) << "</rounds-left>"
+       << "<sessionID>" << getpid() << "</sessionID>"
+       << "</round-init>";
+    sendMessage(os.str());
+    sendTurn(1, 0.0);
+}
+
+void SimulatorServer::finishRound(int currentRound, double immediateReward,
+                                  double roundReward) {
+    stringstream os;
+    os << "<round-end>"
+       << "<instance-name>" << instanceName << "</instance-name>"
+       << "<client-name>" << clientName << "</client-name>"
+       << "<round-num>" << (currentRound + 1) << "</round-num>"
+       << "<round-reward>" << roundReward << "</round-reward>"
+       << "<turns-used>" << task->horizon << "</turns-used>"
+       << "<time-left>" << getRemainingTime() << "</time-left>"
+       << "<immediate-reward>" << immediateReward << "</immediate-reward>"
+       << "</round-end>";
+    sendMessage(os.str());
+}
+
+/******************************************************************************
+                         Turns and actions
+******************************************************************************/
+
+void SimulatorServer::sendTurn(int turn, double immediateReward) {
+    vector<double> const& state = simulator->getCurrentState();
+
+    stringstream os;
+    os << "<turn>"
+       << "<turn-num>" << turn << "</turn-num>"
+       << "<time-left>" << getRemainingTime() << "</time-left>"
+       << "<immediate-reward>" << immediateReward << "</immediate-reward>";
+    for (size_t i = 0; i < state.size(); ++i) {
+        StateFluent const* fluent = nullptr;
+        if (i < State::numberOfDeterministicStateFluents()) {
+            fluent = task->deterministicCPFs[i]->head;
+        } else {
+            fluent = task->probabilisticCPFs
+                         [i - State::numberOfDeterministicStateFluents()]->head;
+        }
+        os << "<observed-fluent>";
+        string const& name = fluent->name;
+        size_t cutPos = name.find("(");
+        addElement(os, "fluent-name", name.substr(0, cutPos));
+        if (cutPos != string::npos) {
+            vector<string> params;
+            StringUtils::split(
+                name.substr(cutPos + 1, name.length() - cutPos - 2), params,
+                ",");
+            for (string& param : params) {
+                StringUtils::trim(param);
+                addElement(os, "fluent-arg", param);
+            }
+        }
+        if (fluent->values.empty()) {
+            addElement(os, "fluent-value", to_string(state[i]));
+        } else {
+            addElement(os, "fluent-value",
+                       fluent->values[static_cast<int>(state[i])]);
+        }
+        os << "</observed-fluent>";
+    }
+    os << "</turn>";
+    sendMessage(os.str());
+}
+
+int SimulatorServer::receiveAction() {
+    Stopwatch stopwatch;
+    XMLNode const* actions = receiveMessage();
+    usedTime += static_cast<long>(stopwatch() * 1000.0);
+    if (!actions || actions->getName() != "actions") {
+        SystemUtils::abort("Error: action message insufficient.");
+    }
+
+    vector<string> names;
+    for (int i = 0; i < actions->size(); ++i) {
+        XMLNode const* action = actions->getChild(i);
+        if (action->getName() != "action") {
+            continue;
+        }
+        string value;
+        if (action->dissect("action-value", value) &&
+            normalize(value) == "false") {
+            continue;
+        }
+        string name;
+        vector<string> params;
+        for (int j = 0; j < action->size(); ++j) {
+            XMLNode const* child = action->getChild(j);
+            if (child->getName() == "action-name") {
+                name = child->getText();
+            } else if (child->getName() == "action-arg") {
+                params.push_back(normalize(child->getText()));
+            }
+        }
+        name = normalize(name);
+        if (!params.empty()) {
+            name += "(";
+            for (size_t j = 0; j < params.size(); ++j) {
+                name += (j == 0 ? "" : ",") + params[j];
+            }
+            name += ")";
+        }
+        names.push_back(name);
+    }
+    delete actions;
+    sort(names.begin(), names.end());
+
+    // Like rddlsim, we apply the noop action if the submitted action is
+    // unknown or inapplicable
+    auto it = actionIndices.find(names);
+    if ((it != actionIndices.end()) &&
+        simulator->actionIsApplicable(it->second)) {
+        return it->second;
+    }
+    int noopIndex = simulator->getNoopIndex();
+    if (noopIndex == -1) {
+        SystemUtils::abort("Error: submitted action is not applicable.");
+    }
+    Logger::logLine("Submitted action is not applicable, applying noop",
+                    Verbosity::NORMAL);
+    return noopIndex;
+}
+
+vector<string> SimulatorServer::findRDDLFiles(
+    string const& instanceName) const {
+    string instanceFile = benchmarkDir + "/" + instanceName + ".rddl";
+    string instanceDesc;
+    if (!SystemUtils::readFile(instanceFile, instanceDesc)) {
+        SystemUtils::abort("Error: Unable to read instance file: " +
+                           instanceFile);
+    }
+
+    // Find the file that contains the domain of the instance (which is the
+    // instance file itself if the domain is not described in another file)
+    smatch match;
+    if (!regex_search(instanceDesc, match,
+                      regex("domain\\s*=\\s*([\\w-]+)\\s*;"))) {
+        SystemUtils::abort("Error: no domain given in " + instanceFile);
+    }
+    regex domainRegex("domain\\s+" + match.str(1) + "\\s*\\{");
+    if (regex_search(instanceDesc, domainRegex)) {
+        return {instanceFile};
+    }
+
+    DIR* dir = opendir(benchmarkDir.c_str());
+    if (!dir) {
+        SystemUtils::abort("Error: Unable to open directory: " + benchmarkDir);
+    }
+    vector<string> files;
+    while (dirent* entry = readdir(dir)) {
+        files.push_back(entry->d_name);
+    }
+    closedir(dir);
+    sort(files.begin(), files.end());
+
+    for (string const& file : files) {
+        if ((file.length() < 5) ||
+            (file.substr(file.length() - 5) != ".rddl")) {
+            continue;
+        }
+        string domainFile = benchmarkDir + "/" + file;
+        string domainDesc;
+        if (SystemUtils::readFile(domainFile, domainDesc) &&
+            regex_search(domainDesc, domainRegex)) {
+            return {domainFile, instanceFile};
+        }
+    }
+    SystemUtils::abort("Error: no domain file found for " + instanceFile);
+    return {};
+}
+
+/******************************************************************************
+                               Communication
+******************************************************************************/
+
+void SimulatorServer::sendMessage(string const& message) const {
+    string terminatedMessage = message + '\0';
+    if (write(socket, terminatedMessage.c_str(), terminatedMessage.length()) ==
+        -1) {
+        SystemUtils::abort("Error: writing to socket failed.");
+    }
+}
+
+XMLNode const* SimulatorServer::receiveMessage() const {
+    // Messages of the client are terminated by a null character
+    string message;
+    char c;
+    while ((read(socket, &c, 1) == 1) && (c != '\0')) {
+        message += c;
+    }
+
+    // Remove the XML declaration
+    size_t declarationEnd = message.find("?>");
+    if (StringUtils::startsWith(message, "<?xml") &&
+        (declarationEnd != string::npos)) {
+        message = message.substr(declarationEnd + 2);
+    }
+    return XMLNode::readNode(message);
+}
+
+long SimulatorServer::getRemainingTime() const {
+    if (totalTime == 0) {
+        return numeric_limits<int>::max();
+    }
+    return max(totalTime - usedTime, 0L);
+}
@@ -0,0 +1,88 @@
+#ifndef SIMULATOR_SERVER_H
+#define SIMULATOR_SERVER_H
+
+/*
+  The simulator server is a lightweight replacement of the rddlsim server that
+  speaks the same XML protocol (session-request, round-request, turn, ...) on
+  a TCP port. Like rddlsim, it serves the instances of a benchmark directory,
+  and the instance of a session is determined by the problem name in the
+  session request.
+
+  The task of a session is parsed with the external parser, and the
+  environment is simulated with the parsed task (see simulator.h). Therefore,
+  the observed fluents that are sent to the client are the state fluents of the
+  parsed task (which is what the IPC client of PROST expects) and not
+  necessarily the fluents of the RDDL description.
+
+  Each session is handled in a separate process, so many clients can be run in
+  parallel. Every session uses the same seed, so sessions where the same
+  actions are applied lead to the same sequence of states.
+*/
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class PlanningTask;
+class Simulator;
+class XMLNode;
+
+class SimulatorServer {
+public:
+    SimulatorServer(std::string _benchmarkDir, unsigned short _port,
+                    int _numberOfRounds, int _seed, long _totalTime,
+                    int _numberOfSessions, std::string _parserOptions);
+    ~SimulatorServer();
+
+    void run();
+
+private:
+    // Handles the session with the client that is connected via socket
+    void runSession();
+
+    void initSession();
+    void finishSession();
+
+    void initRound(int currentRound);
+    void finishRound(int currentRound, double immediateReward,
+                     double roundReward);
+
+    void sendTurn(int turn, double immediateReward);
+    int receiveAction();
+
+    // Determine the RDDL files of the instance with the given name
+    std::vector<std::string> findRDDLFiles(
+        std::string const& instanceName) const;
+
+    void sendMessage(std::string const& message) const;
+    XMLNode const* receiveMessage() const;
+
+    long getRemainingTime() const;
+
+    std::string benchmarkDir;
+    unsigned short port;
+    int numberOfRounds;
+    int seed;
+    // The total time in ms for all rounds (no time limit if this is 0)
+    long totalTime;
+    // The server terminates after this many sessions (no limit if this is 0)
+    int numberOfSessions;
+    std::string parserOptions;
+
+    int socket;
+    std::unique_ptr<PlanningTask> task;
+    std::unique_ptr<Simulator> simulator;
+    std::string instanceName;
+    std::string clientName;
+
+    // Maps the (whitespace-free) names of the scheduled action fluents to the
+    // index of the corresponding action
+    std::map<std::vector<std::string>, int> actionIndices;
+
+    // The time the client has used so far (in ms)
+    long usedTime;
+    double totalReward;
+};
+
+#endif // SIMULATOR_SERVER_H
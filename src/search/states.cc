@@ -1,14 +1,17 @@
 #include "states.h"
 
-#include "evaluatables.h"
-#include "search_engine.h"
+#include "planning_task.h"
 
 #include "utils/string_utils.h"
 
+#include <cmath>
 #include <sstream>
 
 using namespace std;
 
+State::Layout const State::emptyLayout;
+KleeneState::Layout const KleeneState::emptyLayout;
+
 string State::toCompactString() const {
     stringstream ss;
     for (double val : deterministicStateFluents) {
@@ -22,14 +25,15 @@ string State::toCompactString() const {
 }
 
 string State::toString() const {
+    PlanningTask const& task = PlanningTask::active();
     stringstream ss;
-    for (size_t i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
-        ss << SearchEngine::deterministicCPFs[i]->name << ": "
+    for (size_t i = 0; i < numberOfDeterministicStateFluents(); ++i) {
+        ss << task.deterministicCPFs[i]->name << ": "
            << deterministicStateFluents[i] << endl;
     }
     ss << endl;
-    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
-        ss << SearchEngine::probabilisticCPFs[i]->name << ": "
+    for (size_t i = 0; i < numberOfProbabilisticStateFluents(); ++i) {
+        ss << task.probabilisticCPFs[i]->name << ": "
            << probabilisticStateFluents[i] << endl;
     }
     ss << "Remaining Steps: " << remSteps << endl
@@ -48,31 +52,52 @@ string PDState::toCompactString() const {
     return ss.str();
 }
 
+unsigned int PDState::PDStateHash::operator()(PDState const& s) const {
+    // The underlying logic is the same as in utils::hash
+    unsigned int hashValue = 0x345678;
+    unsigned int mult = 1000003;
+    auto combine = [&](unsigned int val) {
+        hashValue = (hashValue ^ val) * mult;
+        mult += 82520;
+    };
+
+    for (double val : s.deterministicStateFluents) {
+        combine(static_cast<unsigned int>(val));
+    }
+    for (DiscretePD const& pd : s.probabilisticStateFluentsAsPD) {
+        combine(pd.values.size());
+        for (size_t i = 0; i < pd.values.size(); ++i) {
+            combine(static_cast<unsigned int>(pd.values[i]));
+            combine(static_cast<unsigned int>(
+                std::lround(pd.probabilities[i] * 1000000.0)));
+        }
+    }
+    return hashValue + 97531;
+}
 
 string KleeneState::toString() const {
+    PlanningTask const& task = PlanningTask::active();
     stringstream ss;
-    for (unsigned int index = 0; index < KleeneState::stateSize; ++index) {
-        ss << SearchEngine::allCPFs[index]->name << ": { ";
-        for (double val : state[index]) {
-            ss << val << " ";
-        }
+    for (unsigned int index = 0; index < stateSize(); ++index) {
+        ss << task.allCPFs[index]->name << ": { ";
+        forEachValue(index, [&](double const& val) { ss << val << " "; });
         ss << "}" << endl;
     }
     return ss.str();
 }
 
 vector<string> ActionState::getScheduledActionFluentNames() const {
+    vector<ActionFluent*> const& actionFluents =
+        PlanningTask::active().actionFluents;
     vector<string> varNames;
     for (size_t i = 0; i < state.size(); ++i) {
         int valueIndex = state[i];
-        if (!SearchEngine::actionFluents[i]->isFDR) {
+        if (!actionFluents[i]->isFDR) {
             if (valueIndex) {
-                varNames.push_back(SearchEngine::actionFluents[i]->name);
+                varNames.push_back(actionFluents[i]->name);
             }
-        } else if (SearchEngine::actionFluents[i]->values[valueIndex] !=
-                   "none-of-those") {
-            varNames.push_back(
-                SearchEngine::actionFluents[i]->values[valueIndex]);
+        } else if (actionFluents[i]->values[valueIndex] != "none-of-those") {
+            varNames.push_back(actionFluents[i]->values[valueIndex]);
         }
     }
     return varNames;
@@ -2,6 +2,7 @@
 #define STATES_H
 
 #include <cassert>
+#include <cstdint>
 #include <set>
 #include <vector>
 
@@ -23,72 +24,77 @@ public:
     friend class PDState;
 
     State(int const& _remSteps = -1)
-        : deterministicStateFluents(numberOfDeterministicStateFluents, 0.0),
-          probabilisticStateFluents(numberOfProbabilisticStateFluents, 0.0),
+        : deterministicStateFluents(numberOfDeterministicStateFluents(), 0.0),
+          probabilisticStateFluents(numberOfProbabilisticStateFluents(), 0.0),
           remSteps(_remSteps),
-          stateFluentHashKeys(numberOfStateFluentHashKeys, 0),
-          hashKey(-1) {}
+          stateFluentHashKeys(numberOfStateFluentHashKeys(), 0),
+          hashKey(-1),
+          zobristKey(0) {}
 
     State(std::vector<double> _deterministicStateFluents,
           std::vector<double> _probabilisticStateFluents, int const& _remSteps)
         : deterministicStateFluents(_deterministicStateFluents),
           probabilisticStateFluents(_probabilisticStateFluents),
           remSteps(_remSteps),
-          stateFluentHashKeys(numberOfStateFluentHashKeys, 0),
-          hashKey(-1) {
+          stateFluentHashKeys(numberOfStateFluentHashKeys(), 0),
+          hashKey(-1),
+          zobristKey(0) {
         assert(deterministicStateFluents.size() ==
-               numberOfDeterministicStateFluents);
+               numberOfDeterministicStateFluents());
         assert(probabilisticStateFluents.size() ==
-               numberOfProbabilisticStateFluents);
+               numberOfProbabilisticStateFluents());
     }
 
     State(std::vector<double> _stateVector, int const& _remSteps)
         : remSteps(_remSteps),
-          stateFluentHashKeys(numberOfStateFluentHashKeys, 0),
-          hashKey(-1) {
-        for (unsigned int i = 0; i < numberOfDeterministicStateFluents; ++i) {
+          stateFluentHashKeys(numberOfStateFluentHashKeys(), 0),
+          hashKey(-1),
+          zobristKey(0) {
+        for (unsigned int i = 0; i < numberOfDeterministicStateFluents(); ++i) {
             deterministicStateFluents.push_back(_stateVector[i]);
         }
-        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents; ++i) {
+        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents(); ++i) {
             probabilisticStateFluents.push_back(
-                _stateVector[i + numberOfDeterministicStateFluents]);
+                _stateVector[i + numberOfDeterministicStateFluents()]);
         }
     }
 
     State(State const& other) = default;
 
     virtual void setTo(State const& other) {
-        for (unsigned int i = 0; i < numberOfDeterministicStateFluents; ++i) {
+        for (unsigned int i = 0; i < numberOfDeterministicStateFluents(); ++i) {
             deterministicStateFluents[i] = other.deterministicStateFluents[i];
         }
-        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents; ++i) {
+        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents(); ++i) {
             probabilisticStateFluents[i] = other.probabilisticStateFluents[i];
         }
 
         remSteps = other.remSteps;
 
-        for (unsigned int i = 0; i < numberOfStateFluentHashKeys; ++i) {
+        for (unsigned int i = 0; i < numberOfStateFluentHashKeys(); ++i) {
             stateFluentHashKeys[i] = other.stateFluentHashKeys[i];
         }
 
         hashKey = other.hashKey;
+        zobristKey = other.zobristKey;
     }
 
     virtual void reset(int _remSteps) {
-        for (unsigned int i = 0; i < numberOfDeterministicStateFluents; ++i) {
+        for (unsigned int i = 0; i < numberOfDeterministicStateFluents(); ++i) {
             deterministicStateFluents[i] = 0.0;
         }
-        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents; ++i) {
+        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents(); ++i) {
             probabilisticStateFluents[i] = 0.0;
         }
 
         remSteps = _remSteps;
 
-        for (unsigned int i = 0; i < numberOfStateFluentHashKeys; ++i) {
+        for (unsigned int i = 0; i < numberOfStateFluentHashKeys(); ++i) {
             stateFluentHashKeys[i] = 0;
         }
 
         hashKey = -1;
+        zobristKey = 0;
     }
 
     void swap(State& other) {
@@ -97,66 +103,76 @@ public:
 
         std::swap(remSteps, other.remSteps);
         std::swap(hashKey, other.hashKey);
+        std::swap(zobristKey, other.zobristKey);
         stateFluentHashKeys.swap(other.stateFluentHashKeys);
     }
 
     // Calculate the hash key of a State
     static void calcStateHashKey(State& state) {
-        if (stateHashingPossible) {
+        if (stateHashingPossible()) {
             state.hashKey = 0;
+            std::vector<std::vector<long>> const& detKeys =
+                layout->stateHashKeysOfDeterministicStateFluents;
             for (unsigned int index = 0;
-                 index < numberOfDeterministicStateFluents; ++index) {
-                state.hashKey += stateHashKeysOfDeterministicStateFluents
-                    [index][(int)state.deterministicStateFluents[index]];
+                 index < numberOfDeterministicStateFluents(); ++index) {
+                int val = (int)state.deterministicStateFluents[index];
+                state.hashKey += detKeys[index][val];
             }
+            std::vector<std::vector<long>> const& probKeys =
+                layout->stateHashKeysOfProbabilisticStateFluents;
             for (unsigned int index = 0;
-                 index < numberOfProbabilisticStateFluents; ++index) {
-                state.hashKey += stateHashKeysOfProbabilisticStateFluents
-                    [index][(int)state.probabilisticStateFluents[index]];
+                 index < numberOfProbabilisticStateFluents(); ++index) {
+                int val = (int)state.probabilisticStateFluents[index];
+                state.hashKey += probKeys[index][val];
             }
         } else {
             assert(state.hashKey == -1);
+            state.zobristKey = 0;
+            std::vector<std::vector<uint64_t>> const& detKeys =
+                layout->zobristKeysOfDeterministicStateFluents;
+            for (unsigned int index = 0;
+                 index < numberOfDeterministicStateFluents(); ++index) {
+                int val = (int)state.deterministicStateFluents[index];
+                state.zobristKey ^= detKeys[index][val];
+            }
+            std::vector<std::vector<uint64_t>> const& probKeys =
+                layout->zobristKeysOfProbabilisticStateFluents;
+            for (unsigned int index = 0;
+                 index < numberOfProbabilisticStateFluents(); ++index) {
+                int val = (int)state.probabilisticStateFluents[index];
+                state.zobristKey ^= probKeys[index][val];
+            }
         }
     }
 
     // Calculate the hash key for each state fluent in a State
     static void calcStateFluentHashKeys(State& state) {
-        for (unsigned int i = 0; i < numberOfDeterministicStateFluents; ++i) {
+        std::vector<std::vector<std::pair<int, long>>> const& detKeys =
+            layout->stateFluentHashKeysOfDeterministicStateFluents;
+        for (unsigned int i = 0; i < numberOfDeterministicStateFluents(); ++i) {
             if (MathUtils::doubleIsGreater(state.deterministicStateFluents[i],
                                            0.0)) {
-                for (unsigned int j = 0;
-                     j <
-                     stateFluentHashKeysOfDeterministicStateFluents[i].size();
-                     ++j) {
+                for (unsigned int j = 0; j < detKeys[i].size(); ++j) {
                     assert(state.stateFluentHashKeys.size() >
-                           stateFluentHashKeysOfDeterministicStateFluents[i][j]
-                               .first);
-                    state.stateFluentHashKeys
-                        [stateFluentHashKeysOfDeterministicStateFluents[i][j]
-                             .first] +=
+                           detKeys[i][j].first);
+                    state.stateFluentHashKeys[detKeys[i][j].first] +=
                         ((int)state.deterministicStateFluents[i]) *
-                        stateFluentHashKeysOfDeterministicStateFluents[i][j]
-                            .second;
+                        detKeys[i][j].second;
                 }
             }
         }
 
-        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents; ++i) {
+        std::vector<std::vector<std::pair<int, long>>> const& probKeys =
+            layout->stateFluentHashKeysOfProbabilisticStateFluents;
+        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents(); ++i) {
             if (MathUtils::doubleIsGreater(state.probabilisticStateFluents[i],
                                            0.0)) {
-                for (unsigned int j = 0;
-                     j <
-                     stateFluentHashKeysOfProbabilisticStateFluents[i].size();
-                     ++j) {
+                for (unsigned int j = 0; j < probKeys[i].size(); ++j) {
                     assert(state.stateFluentHashKeys.size() >
-                           stateFluentHashKeysOfProbabilisticStateFluents[i][j]
-                               .first);
-                    state.stateFluentHashKeys
-                        [stateFluentHashKeysOfProbabilisticStateFluents[i][j]
-                             .first] +=
+                           probKeys[i][j].first);
+                    state.stateFluentHashKeys[probKeys[i][j].first] +=
                         ((int)state.probabilisticStateFluents[i]) *
-                        stateFluentHashKeysOfProbabilisticStateFluents[i][j]
-                            .second;
+                        probKeys[i][j].second;
                 }
             }
         }
@@ -206,7 +222,7 @@ public:
                 return lhs.hashKey < rhs.hashKey;
             }
 
-            for (unsigned int i = 0; i < numberOfDeterministicStateFluents;
+            for (unsigned int i = 0; i < numberOfDeterministicStateFluents();
                  ++i) {
                 if (MathUtils::doubleIsSmaller(
                         rhs.deterministicStateFluents[i],
@@ -219,7 +235,7 @@ public:
                 }
             }
 
-            for (unsigned int i = 0; i < numberOfProbabilisticStateFluents;
+            for (unsigned int i = 0; i < numberOfProbabilisticStateFluents();
                  ++i) {
                 if (MathUtils::doubleIsSmaller(
                         rhs.probabilisticStateFluents[i],
@@ -238,6 +254,10 @@ public:
 
     struct HashWithRemSteps {
         unsigned int operator()(State const& s) const {
+            if (!stateHashingPossible()) {
+                return hashZobristKey(s.zobristKey ^
+                                      (s.stepsToGo() * 0x9e3779b97f4a7c15ULL));
+            }
             return utils::hash(s.probabilisticStateFluents,
                                s.deterministicStateFluents, s.stepsToGo());
         }
@@ -249,11 +269,13 @@ public:
                 return false;
             }
 
-            if (stateHashingPossible) {
+            if (stateHashingPossible()) {
                 return lhs.hashKey == rhs.hashKey;
+            } else if (lhs.zobristKey != rhs.zobristKey) {
+                return false;
             }
 
-            for (unsigned int i = 0; i < numberOfDeterministicStateFluents;
+            for (unsigned int i = 0; i < numberOfDeterministicStateFluents();
                  ++i) {
                 if (!MathUtils::doubleIsEqual(
                         lhs.deterministicStateFluents[i],
@@ -262,7 +284,7 @@ public:
                 }
             }
 
-            for (unsigned int i = 0; i < numberOfProbabilisticStateFluents;
+            for (unsigned int i = 0; i < numberOfProbabilisticStateFluents();
                  ++i) {
                 if (!MathUtils::doubleIsEqual(
                         lhs.probabilisticStateFluents[i],
@@ -276,6 +298,9 @@ public:
 
     struct HashWithoutRemSteps {
         unsigned int operator()(State const& s) const {
+            if (!stateHashingPossible()) {
+                return hashZobristKey(s.zobristKey);
+            }
             return utils::hash(s.probabilisticStateFluents,
                                s.deterministicStateFluents);
         }
@@ -283,11 +308,13 @@ public:
 
     struct EqualWithoutRemSteps {
         bool operator()(State const& lhs, State const& rhs) const {
-            if (stateHashingPossible) {
+            if (stateHashingPossible()) {
                 return lhs.hashKey == rhs.hashKey;
+            } else if (lhs.zobristKey != rhs.zobristKey) {
+                return false;
             }
 
-            for (unsigned int i = 0; i < numberOfDeterministicStateFluents;
+            for (unsigned int i = 0; i < numberOfDeterministicStateFluents();
                  ++i) {
                 if (!MathUtils::doubleIsEqual(
                         lhs.deterministicStateFluents[i],
@@ -296,7 +323,7 @@ public:
                 }
             }
 
-            for (unsigned int i = 0; i < numberOfProbabilisticStateFluents;
+            for (unsigned int i = 0; i < numberOfProbabilisticStateFluents();
                  ++i) {
                 if (!MathUtils::doubleIsEqual(
                         lhs.probabilisticStateFluents[i],
@@ -311,38 +338,85 @@ public:
     virtual std::string toCompactString() const;
     virtual std::string toString() const;
 
-    // The number of deterministic and probabilistic state fluents
-    static int numberOfDeterministicStateFluents;
-    static int numberOfProbabilisticStateFluents;
+    // The properties of the States of a planning task that are needed to create
+    // and hash them. Each PlanningTask has a Layout, and States use the one of
+    // the task that is active on the calling thread (see
+    // PlanningTask::activate).
+    struct Layout {
+        // The number of deterministic and probabilistic state fluents
+        int numberOfDeterministicStateFluents = 0;
+        int numberOfProbabilisticStateFluents = 0;
+
+        // The number of variables that have a state fluent hash key
+        int numberOfStateFluentHashKeys = 0;
+
+        // Is true if hashing of states (not state fluent hashing) is possible
+        bool stateHashingPossible = true;
+
+        // These are used to calculate hash keys
+        std::vector<std::vector<long>> stateHashKeysOfDeterministicStateFluents;
+        std::vector<std::vector<long>> stateHashKeysOfProbabilisticStateFluents;
+
+        // If state hashing is not possible, these are used to calculate the
+        // Zobrist keys of states instead (see Parser::createZobristKeys)
+        std::vector<std::vector<uint64_t>>
+            zobristKeysOfDeterministicStateFluents;
+        std::vector<std::vector<uint64_t>>
+            zobristKeysOfProbabilisticStateFluents;
+
+        // The Evaluatable with index
+        // stateFluentHashKeysOfDeterministicStateFluents[i][j].first depends on
+        // the deterministic state fluent with index i, and is updated by
+        // multiplication with
+        // stateFluentHashKeysOfDeterministicStateFluents[i][j].second
+        std::vector<std::vector<std::pair<int, long>>>
+            stateFluentHashKeysOfDeterministicStateFluents;
+        std::vector<std::vector<std::pair<int, long>>>
+            stateFluentHashKeysOfProbabilisticStateFluents;
+    };
 
-    // The number of variables that have a state fluent hash key
-    static int numberOfStateFluentHashKeys;
+    // Sets the Layout that is used on the calling thread (or the empty Layout
+    // if _layout is nullptr)
+    static void setLayout(Layout const* _layout) {
+        layout = _layout ? _layout : &emptyLayout;
+    }
+
+    static int const& numberOfDeterministicStateFluents() {
+        return layout->numberOfDeterministicStateFluents;
+    }
 
-    // Is true if hashing of states (not state fluent hashing) is possible
-    static bool stateHashingPossible;
+    static int const& numberOfProbabilisticStateFluents() {
+        return layout->numberOfProbabilisticStateFluents;
+    }
 
-    // These are used to calculate hash keys
-    static std::vector<std::vector<long>>
-        stateHashKeysOfDeterministicStateFluents;
-    static std::vector<std::vector<long>>
-        stateHashKeysOfProbabilisticStateFluents;
+    static int const& numberOfStateFluentHashKeys() {
+        return layout->numberOfStateFluentHashKeys;
+    }
 
-    // The Evaluatable with index
-    // stateFluentHashKeysOfDeterministicStateFluents[i][j].first depends on the
-    // deterministic state fluent with index i, and is updated by multiplication
-    // with stateFluentHashKeysOfDeterministicStateFluents[i][j].second
-    static std::vector<std::vector<std::pair<int, long>>>
-        stateFluentHashKeysOfDeterministicStateFluents;
-    static std::vector<std::vector<std::pair<int, long>>>
-        stateFluentHashKeysOfProbabilisticStateFluents;
+    static bool const& stateHashingPossible() {
+        return layout->stateHashingPossible;
+    }
 
 private:
+    static unsigned int hashZobristKey(uint64_t key) {
+        return static_cast<unsigned int>(key ^ (key >> 32));
+    }
+
     std::vector<double> deterministicStateFluents;
     std::vector<double> probabilisticStateFluents;
 
     int remSteps;
     std::vector<long> stateFluentHashKeys;
     long hashKey;
+
+    // If state hashing is not possible, states are hashed with this key, which
+    // is the XOR of the Zobrist keys of the values of all state fluents. Unlike
+    // hashKey, it is not unique, so equal keys are checked for collisions by
+    // comparing the state fluents.
+    uint64_t zobristKey;
+
+    static Layout const emptyLayout;
+    static inline thread_local Layout const* layout = &emptyLayout;
 };
 
 /*****************************************************************
@@ -385,12 +459,12 @@ class PDState : public State {
 public:
     PDState(int const& _remSteps = -1)
         : State(_remSteps),
-          probabilisticStateFluentsAsPD(numberOfProbabilisticStateFluents,
+          probabilisticStateFluentsAsPD(numberOfProbabilisticStateFluents(),
                                         DiscretePD()) {}
 
     PDState(State const& origin)
         : State(origin),
-          probabilisticStateFluentsAsPD(numberOfProbabilisticStateFluents,
+          probabilisticStateFluentsAsPD(numberOfProbabilisticStateFluents(),
                                         DiscretePD()) {}
 
     DiscretePD& probabilisticStateFluentAsPD(int index) {
@@ -406,7 +480,7 @@ public:
     void reset(int _remSteps) override {
         State::reset(_remSteps);
 
-        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents; ++i) {
+        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents(); ++i) {
             probabilisticStateFluentsAsPD[i].reset();
         }
     }
@@ -414,47 +488,49 @@ public:
     void setTo(PDState const& other) {
         State::setTo(other);
 
-        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents; ++i) {
+        for (unsigned int i = 0; i < numberOfProbabilisticStateFluents(); ++i) {
             probabilisticStateFluentsAsPD[i] =
                 other.probabilisticStateFluentsAsPD[i];
         }
     }
 
-    std::pair<double, double> sample(int varIndex,
-                                     std::vector<int> const& blacklist = {}) {
+    std::pair<double, double> sample(
+        int varIndex, RandomXoshiro& rnd,
+        OutcomeMask const& blacklist = OutcomeMask()) {
         DiscretePD& pd = probabilisticStateFluentsAsPD[varIndex];
-        std::pair<double, double> outcome = pd.sample(blacklist);
+        std::pair<double, double> outcome = pd.sample(rnd, blacklist);
         probabilisticStateFluent(varIndex) = outcome.first;
         return outcome;
     }
 
+    // Remaining steps are not considered here! Probabilities are rounded
+    // before they are hashed, so two PDStates that are equal according to
+    // PDStateEqual can (in rare cases) have different hash values. This only
+    // means that an equivalence of two PDStates might be missed.
+    struct PDStateHash {
+        unsigned int operator()(PDState const& s) const;
+    };
+
     // Remaining steps are not considered here!
-    struct PDStateCompare {
+    struct PDStateEqual {
         bool operator()(PDState const& lhs, PDState const& rhs) const {
-            for (unsigned int i = 0; i < numberOfDeterministicStateFluents;
+            for (unsigned int i = 0; i < numberOfDeterministicStateFluents();
                  ++i) {
-                if (MathUtils::doubleIsSmaller(
-                        rhs.deterministicStateFluents[i],
-                        lhs.deterministicStateFluents[i])) {
+                if (!MathUtils::doubleIsEqual(
+                        lhs.deterministicStateFluents[i],
+                        rhs.deterministicStateFluents[i])) {
                     return false;
-                } else if (MathUtils::doubleIsSmaller(
-                               lhs.deterministicStateFluents[i],
-                               rhs.deterministicStateFluents[i])) {
-                    return true;
                 }
             }
 
-            for (unsigned int i = 0; i < numberOfProbabilisticStateFluents;
+            for (unsigned int i = 0; i < numberOfProbabilisticStateFluents();
                  ++i) {
-                if (rhs.probabilisticStateFluentsAsPD[i] <
-                    lhs.probabilisticStateFluentsAsPD[i]) {
+                if (!(lhs.probabilisticStateFluentsAsPD[i] ==
+                      rhs.probabilisticStateFluentsAsPD[i])) {
                     return false;
-                } else if (lhs.probabilisticStateFluentsAsPD[i] <
-                           rhs.probabilisticStateFluentsAsPD[i]) {
-                    return true;
                 }
             }
-            return false;
+            return true;
         }
     };
 
@@ -471,39 +547,35 @@ protected:
 class KleeneState {
 public:
     KleeneState()
-        : state(stateSize),
-          stateFluentHashKeys(numberOfStateFluentHashKeys, 0),
+        : valueBits(stateSize(), 0),
+          largeDomainValues(layout->hasLargeDomains ? stateSize() : 0),
+          stateFluentHashKeys(layout->numberOfStateFluentHashKeys, 0),
           hashKey(-1) {}
 
     KleeneState(State const& origin)
-        : state(stateSize),
-          stateFluentHashKeys(numberOfStateFluentHashKeys, 0),
+        : valueBits(stateSize(), 0),
+          largeDomainValues(layout->hasLargeDomains ? stateSize() : 0),
+          stateFluentHashKeys(layout->numberOfStateFluentHashKeys, 0),
           hashKey(-1) {
         for (unsigned int index = 0;
-             index < State::numberOfDeterministicStateFluents; ++index) {
-            state[index].insert(origin.deterministicStateFluents[index]);
+             index < State::numberOfDeterministicStateFluents(); ++index) {
+            insert(index, origin.deterministicStateFluents[index]);
         }
 
         for (unsigned int index = 0;
-             index < State::numberOfProbabilisticStateFluents; ++index) {
-            state[State::numberOfDeterministicStateFluents + index].insert(
-                origin.probabilisticStateFluents[index]);
+             index < State::numberOfProbabilisticStateFluents(); ++index) {
+            insert(State::numberOfDeterministicStateFluents() + index,
+                   origin.probabilisticStateFluents[index]);
         }
     }
 
     // Calculate the hash key of a KleeneState
     static void calcStateHashKey(KleeneState& state) {
-        if (stateHashingPossible) {
+        if (layout->stateHashingPossible) {
             state.hashKey = 0;
-            for (unsigned int index = 0; index < stateSize; ++index) {
-                int multiplier = 0;
-                for (std::set<double>::iterator it = state[index].begin();
-                     it != state[index].end(); ++it) {
-                    multiplier |= 1 << ((int)*it);
-                }
-                --multiplier;
-
-                state.hashKey += (multiplier * hashKeyBases[index]);
+            for (unsigned int index = 0; index < stateSize(); ++index) {
+                long multiplier = state.getHashKeyMultiplier(index);
+                state.hashKey += (multiplier * layout->hashKeyBases[index]);
             }
         } else {
             assert(state.hashKey == -1);
@@ -512,35 +584,104 @@ public:
 
     // Calculate the hash key for each state fluent in a KleeneState
     static void calcStateFluentHashKeys(KleeneState& state) {
-        for (unsigned int i = 0; i < stateSize; ++i) {
-            int multiplier = 0;
-            for (std::set<double>::iterator it = state[i].begin();
-                 it != state[i].end(); ++it) {
-                multiplier |= 1 << ((int)*it);
+        for (unsigned int i = 0; i < stateSize(); ++i) {
+            // Variables with large domains usually don't contribute to state
+            // fluent hash keys, so their values are only collected if they do
+            std::vector<std::pair<int, long>> const& keys =
+                layout->indexToStateFluentHashKeyMap[i];
+            if (keys.empty()) {
+                continue;
             }
-            --multiplier;
+            long multiplier = state.getHashKeyMultiplier(i);
             if (multiplier > 0) {
-                for (unsigned int j = 0;
-                     j < indexToStateFluentHashKeyMap[i].size(); ++j) {
-                    assert(state.stateFluentHashKeys.size() >
-                           indexToStateFluentHashKeyMap[i][j].first);
-                    state.stateFluentHashKeys[indexToStateFluentHashKeyMap[i][j]
-                                                  .first] +=
-                        (multiplier *
-                         indexToStateFluentHashKeyMap[i][j].second);
+                for (unsigned int j = 0; j < keys.size(); ++j) {
+                    assert(state.stateFluentHashKeys.size() > keys[j].first);
+                    state.stateFluentHashKeys[keys[j].first] +=
+                        (multiplier * keys[j].second);
                 }
             }
         }
     }
 
-    std::set<double>& operator[](int const& index) {
-        assert(index < state.size());
-        return state[index];
+    // Returns true if the values of the state fluent with the given index are
+    // stored as bitset
+    static bool usesBitset(int const& index) {
+        assert(index < layout->domainSizes.size());
+        return layout->domainSizes[index] <= maxBitsetDomainSize;
     }
 
-    std::set<double> const& operator[](int const& index) const {
-        assert(index < state.size());
-        return state[index];
+    // Returns the multiplier of the hash key bases of the state fluent with
+    // the given index, which encodes its set of values as bitset minus one
+    long getHashKeyMultiplier(int const& index) const {
+        if (usesBitset(index)) {
+            return valueBits[index] - 1;
+        }
+        long multiplier = 0;
+        for (double val : largeDomainValues[index]) {
+            multiplier |= (long(1) << static_cast<int>(val));
+        }
+        return multiplier - 1;
+    }
+
+    // Adds val to the values of the state fluent with the given index
+    void insert(int const& index, double const& val) {
+        if (usesBitset(index)) {
+            assert((val >= 0.0) && (val < maxBitsetDomainSize));
+            valueBits[index] |= (uint64_t(1) << static_cast<int>(val));
+        } else {
+            largeDomainValues[index].insert(val);
+        }
+    }
+
+    // Adds all values of the state fluent with the given index to res
+    void getValues(int const& index, std::set<double>& res) const {
+        if (usesBitset(index)) {
+            for (uint64_t bits = valueBits[index]; bits; bits &= bits - 1) {
+                res.insert(__builtin_ctzll(bits));
+            }
+        } else {
+            res.insert(largeDomainValues[index].begin(),
+                       largeDomainValues[index].end());
+        }
+    }
+
+    // Calls f for each value of the state fluent with the given index (in
+    // increasing order)
+    template <typename Function>
+    void forEachValue(int const& index, Function f) const {
+        if (usesBitset(index)) {
+            for (uint64_t bits = valueBits[index]; bits; bits &= bits - 1) {
+                f(static_cast<double>(__builtin_ctzll(bits)));
+            }
+        } else {
+            for (double val : largeDomainValues[index]) {
+                f(val);
+            }
+        }
+    }
+
+    // Bitset of the values of the state fluent with the given index (bit i is
+    // set iff value i is included). Must only be used if usesBitset(index).
+    uint64_t& bits(int const& index) {
+        assert(usesBitset(index));
+        return valueBits[index];
+    }
+
+    uint64_t const& bits(int const& index) const {
+        assert(usesBitset(index));
+        return valueBits[index];
+    }
+
+    // Values of the state fluent with the given index if it is not stored as
+    // bitset
+    std::set<double>& values(int const& index) {
+        assert(!usesBitset(index));
+        return largeDomainValues[index];
+    }
+
+    std::set<double> const& values(int const& index) const {
+        assert(!usesBitset(index));
+        return largeDomainValues[index];
     }
 
     long const& stateFluentHashKey(int const& index) const {
@@ -549,26 +690,21 @@ public:
     }
 
     bool operator==(KleeneState const& other) const {
-        assert(state.size() == other.state.size());
         if ((hashKey >= 0) && other.hashKey >= 0) {
             return hashKey == other.hashKey;
         }
-
-        for (unsigned int index = 0; index < state.size(); ++index) {
-            if (!std::equal(state[index].begin(), state[index].end(),
-                            other.state[index].begin())) {
-                return false;
-            }
-        }
-        return true;
+        return (valueBits == other.valueBits) &&
+               (largeDomainValues == other.largeDomainValues);
     }
 
     // This is used to merge two KleeneStates
-    KleeneState operator|=(KleeneState const& other) {
-        assert(state.size() == other.state.size());
-
-        for (unsigned int i = 0; i < state.size(); ++i) {
-            state[i].insert(other.state[i].begin(), other.state[i].end());
+    KleeneState& operator|=(KleeneState const& other) {
+        for (unsigned int i = 0; i < stateSize(); ++i) {
+            valueBits[i] |= other.valueBits[i];
+        }
+        for (unsigned int i = 0; i < largeDomainValues.size(); ++i) {
+            largeDomainValues[i].insert(other.largeDomainValues[i].begin(),
+                                        other.largeDomainValues[i].end());
         }
 
         hashKey = -1;
@@ -576,40 +712,67 @@ public:
     }
 
     KleeneState const operator||(KleeneState const& other) {
-        assert(state.size() == other.state.size());
         return KleeneState(*this) |= other;
     }
 
     std::string toString() const;
 
-    // The number of state fluents
-    static int stateSize;
+    // The values of state fluents with at most maxBitsetDomainSize values are
+    // stored as bitset, all others in a std::set
+    static constexpr int maxBitsetDomainSize = 64;
+
+    // The properties of the KleeneStates of a planning task (see State::Layout)
+    struct Layout {
+        // The number of state fluents
+        int stateSize = 0;
+
+        // The domain sizes of all state fluents
+        std::vector<int> domainSizes;
+
+        // Is true if there is a state fluent that is not stored as bitset
+        bool hasLargeDomains = false;
+
+        // The number of variables that have a state fluent hash key
+        int numberOfStateFluentHashKeys = 0;
 
-    // The number of variables that have a state fluent hash key
-    static int numberOfStateFluentHashKeys;
+        // Is true if hashing of States (not state fluent hashing) is possible
+        bool stateHashingPossible = true;
 
-    // Is true if hashing of States (not state fluent hashing) is possible
-    static bool stateHashingPossible;
+        // These are used to calculate hash keys
+        std::vector<long> hashKeyBases;
 
-    // These are used to calculate hash keys
-    static std::vector<long> hashKeyBases;
+        // The Evaluatable with index indexToStateFluentHashKeyMap[i][j].first
+        // depends on the CPF with index i, and is updated by multiplication
+        // with indexToStateFluentHashKeyMap[i][j].second
+        std::vector<std::vector<std::pair<int, long>>>
+            indexToStateFluentHashKeyMap;
+    };
 
-    // The Evaluatable with index indexToStateFluentHashKeyMap[i][j].first
-    // depends on the CPF with index i, and is updated by multiplication with
-    // indexToStateFluentHashKeyMap[i][j].second
-    static std::vector<std::vector<std::pair<int, long>>>
-        indexToStateFluentHashKeyMap;
+    // Sets the Layout that is used on the calling thread (or the empty Layout
+    // if _layout is nullptr)
+    static void setLayout(Layout const* _layout) {
+        layout = _layout ? _layout : &emptyLayout;
+    }
+
+    static int const& stateSize() {
+        return layout->stateSize;
+    }
 
 protected:
-    std::vector<std::set<double>> state;
+    std::vector<uint64_t> valueBits;
+    std::vector<std::set<double>> largeDomainValues;
     std::vector<long> stateFluentHashKeys;
     long hashKey;
 
 private:
     KleeneState(KleeneState const& other)
-        : state(other.state),
+        : valueBits(other.valueBits),
+          largeDomainValues(other.largeDomainValues),
           stateFluentHashKeys(other.stateFluentHashKeys),
           hashKey(other.hashKey) {}
+
+    static Layout const emptyLayout;
+    static inline thread_local Layout const* layout = &emptyLayout;
 };
 
 #endif
@@ -0,0 +1,39 @@
+#include "test_utils.cc"
+
+#include "../heuristic_value_cache.h"
+
+#include <vector>
+
+TEST_CASE_FIXTURE(ProstUnitTest, "Testing the heuristic value cache") {
+    parseTaskDescription(task, fourFluentTaskDescription());
+    HeuristicValueCache& cache = task.heuristicValueCache;
+    State const& state = task.initialState;
+    std::vector<double> qValues = {1.0, 2.0};
+
+    int id = cache.registerHeuristic("[IDS]", 5, 1, task.numberOfActions);
+    REQUIRE(cache.lookup(id, state) == nullptr);
+    cache.insert(id, state, qValues);
+    REQUIRE(cache.lookup(id, state) != nullptr);
+    CHECK(*cache.lookup(id, state) == qValues);
+
+    SUBCASE("Testing that identical heuristics share their entries") {
+        int sameId =
+            cache.registerHeuristic("[IDS]", 5, 1, task.numberOfActions);
+        CHECK(sameId == id);
+        CHECK(cache.lookup(sameId, state) != nullptr);
+    }
+    SUBCASE("Testing that different search depths do not share entries") {
+        int otherId =
+            cache.registerHeuristic("[IDS]", 3, 1, task.numberOfActions);
+        CHECK(otherId != id);
+        CHECK(cache.lookup(otherId, state) == nullptr);
+        cache.insert(otherId, state, {3.0, 4.0});
+        CHECK(*cache.lookup(id, state) == qValues);
+    }
+    SUBCASE("Testing that different heuristics do not share entries") {
+        int otherId =
+            cache.registerHeuristic("[DFS]", 5, 1, task.numberOfActions);
+        CHECK(otherId != id);
+        CHECK(cache.lookup(otherId, state) == nullptr);
+    }
+}
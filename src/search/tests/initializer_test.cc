@@ -0,0 +1,68 @@
+#include "test_utils.cc"
+
+#include "../initializer.h"
+#include "../thts.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_CASE_FIXTURE(ProstUnitTest, "Testing the batched initializer") {
+    parseTaskDescription(task, fourFluentTaskDescription());
+    task.rnd.seed(0);
+
+    // The search initializes the node pool that provides the chance nodes
+    std::string desc =
+        "[THTS -act [UCB1] -out [UMC] -backup [PB] "
+        "-init [Batch -h [Uniform -val 1] -bs 1] -T TRIALS -r 10]";
+    std::unique_ptr<THTS> thts(
+        dynamic_cast<THTS*>(SearchEngine::fromString(desc, task)));
+    REQUIRE(thts);
+    thts->initSession();
+    thts->initRound();
+    thts->initStep(task.initialState);
+    std::vector<int> bestActions;
+    thts->estimateBestActions(task.initialState, bestActions);
+
+    // With a heuristic weight of 0.5, the children of a node with two
+    // remaining steps in the initial state (where no fluent is true) have the
+    // provisional values 0.5 * 2 * 0 (noop) and 0.5 * 2 * -0.5 (the action),
+    // and the heuristic estimates are 0.5 * 2 * 1 for both
+    std::string initDesc = "[Batch -h [Uniform -val 1] -bs 1]";
+    std::unique_ptr<Initializer> initializer(
+        Initializer::fromString(initDesc, thts.get()));
+    initializer->initSession();
+    initializer->initRound();
+    initializer->initStep(task.initialState);
+
+    State state(task.initialState);
+    state.stepsToGo() = 2;
+    SearchNode node(1.0, 2);
+    initializer->initialize(&node, state);
+    REQUIRE(node.initialized);
+    REQUIRE(node.children.size() == 2);
+    REQUIRE(node.children[0]);
+    REQUIRE(node.children[1]);
+    CHECK(node.children[0]->futureReward == doctest::Approx(0.0));
+    CHECK(node.children[1]->futureReward == doctest::Approx(-0.5));
+    CHECK(node.futureReward == doctest::Approx(0.0));
+
+    SUBCASE("Provisional values are replaced by the heuristic estimates") {
+        initializer->initTrial();
+        CHECK(node.children[0]->futureReward == doctest::Approx(1.0));
+        CHECK(node.children[1]->futureReward == doctest::Approx(1.0));
+        CHECK(node.futureReward == doctest::Approx(1.0));
+    }
+
+    SUBCASE("Children that have been visited keep their values") {
+        node.children[0]->futureReward = -3.0;
+        ++node.children[0]->numberOfVisits;
+        initializer->initTrial();
+        CHECK(node.children[0]->futureReward == doctest::Approx(-3.0));
+        CHECK(node.children[1]->futureReward == doctest::Approx(1.0));
+        CHECK(node.futureReward == doctest::Approx(1.0));
+    }
+
+    // The children belong to the node pool of THTS
+    node.children.clear();
+}
@@ -0,0 +1,87 @@
+#include "test_utils.cc"
+
+#include "../persistent_cache.h"
+#include "../search_engine.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+TEST_CASE_FIXTURE(ProstUnitTest, "Testing the persistent cache") {
+    parseTaskDescription(task, fourFluentTaskDescription());
+    // The BDD files are only used by the task whose finite domain blocks are
+    // the first ones of the process, so this test case must not have subcases
+    task.initBDDs();
+
+    std::string desc = "[UCT -init [Expand -h [Uniform]]]";
+    std::unique_ptr<SearchEngine> engine(SearchEngine::fromString(desc, task));
+    desc = "[UCT -init [Expand -h [Uniform]] -sd 5]";
+    std::unique_ptr<SearchEngine> otherEngine(
+        SearchEngine::fromString(desc, task));
+    REQUIRE(engine->getCacheConfig() != otherEngine->getCacheConfig());
+
+    char fileName[] = "/tmp/prost_test_cacheXXXXXX";
+    int fd = mkstemp(fileName);
+    REQUIRE(fd != -1);
+    close(fd);
+
+    State const& state = task.initialState;
+    bdd deadEnds = fdd_ithvar(0, 1);
+    bdd goals = fdd_ithvar(1, 1);
+    task.probabilisticCaches.stateValueCache[state] = 3.5;
+    task.rewardLockCache[state] = true;
+    task.cachedDeadEnds = deadEnds;
+    task.cachedGoals = goals;
+    PersistentCache(fileName).store(task, engine.get());
+
+    auto clearCaches = [&]() {
+        task.probabilisticCaches.stateValueCache.clear();
+        task.rewardLockCache.clear();
+        task.cachedDeadEnds = bddfalse;
+        task.cachedGoals = bddfalse;
+    };
+
+    // The cache is rejected by a search engine with another configuration
+    clearCaches();
+    PersistentCache(fileName).load(task, otherEngine.get());
+    CHECK(task.probabilisticCaches.stateValueCache.empty());
+    CHECK(task.rewardLockCache.empty());
+    CHECK(task.cachedDeadEnds == bddfalse);
+    CHECK(task.cachedGoals == bddfalse);
+
+    // The records and the BDDs are restored by a search engine with the same
+    // configuration
+    clearCaches();
+    PersistentCache(fileName).load(task, engine.get());
+    REQUIRE(task.probabilisticCaches.stateValueCache.count(state) == 1);
+    CHECK(task.probabilisticCaches.stateValueCache[state] ==
+          doctest::Approx(3.5));
+    REQUIRE(task.rewardLockCache.count(state) == 1);
+    CHECK(task.rewardLockCache[state]);
+    CHECK(task.cachedDeadEnds == deadEnds);
+    CHECK(task.cachedGoals == goals);
+
+    // The file is rejected if a record is corrupt. The header consists of six
+    // words and is followed by the records, where the second and the third
+    // word are the remaining steps and the number of values.
+    auto checkRejectsCorruptWord = [&](long offset, int64_t word) {
+        task.probabilisticCaches.stateValueCache[state] = 3.5;
+        PersistentCache(fileName).store(task, engine.get());
+        FILE* file = std::fopen(fileName, "r+b");
+        REQUIRE(file);
+        std::fseek(file, (6 + offset) * sizeof(int64_t), SEEK_SET);
+        std::fwrite(&word, sizeof(int64_t), 1, file);
+        std::fclose(file);
+        clearCaches();
+        PersistentCache(fileName).load(task, engine.get());
+        CHECK(task.probabilisticCaches.stateValueCache.empty());
+    };
+    checkRejectsCorruptWord(1, -1);
+    checkRejectsCorruptWord(1, task.horizon + 1);
+    checkRejectsCorruptWord(2, task.numberOfActions + 1);
+
+    std::remove(fileName);
+    std::remove((std::string(fileName) + ".deadends").c_str());
+    std::remove((std::string(fileName) + ".goals").c_str());
+}
@@ -2,71 +2,82 @@
 
 #include "../probability_distribution.h"
 
-#include <memory>
-
 using std::map;
 using std::vector;
 
-// Class to fake generation of random numbers
-class RandomFake : public Random<std::mt19937> {
-public:
-    RandomFake() : counter(0) {}
-
-    int genInt(int min, int) override {
-        return min;
-    }
-
-    // Alternate generated numbers
-    double genDouble(double, double) override {
-        ++counter;
-        if (counter % 2) {
-            return 0.2;
-        } else {
-            return 0.4;
-        }
-    }
-
-    double genReal() override {
-        return 0.0;
-    }
-
-    void seed(int){};
-
-    int counter;
-};
-
 TEST_CASE_FIXTURE(ProstUnitTest, "Testing DiracDelta distributions") {
     SUBCASE("Probability distribution only has a single value") {
         DiscretePD pd;
         pd.assignDiracDelta(5.0);
         // Sampling should always return 5.0
         for (int i = 0; i < 1000; ++i) {
-            CHECK(pd.sample().first == doctest::Approx(5.0));
+            CHECK(pd.sample(task.rnd).first == doctest::Approx(5.0));
         }
     }
 }
 
 TEST_CASE_FIXTURE(ProstUnitTest, "Testing Discrete probability distribution") {
-    MathUtils::rnd = std::unique_ptr<Random<>>(new RandomFake());
     DiscretePD pd;
     map<double, double> valueProbPairs = {{1.0, 0.2}, {2.0, 0.2}, {3.0, 0.6}};
     pd.assignDiscrete(valueProbPairs);
+    // The random numbers that are used for sampling are predicted with a copy
+    // of the random number generator (and compared with the accumulated
+    // probabilities like in DiscretePD::sample)
     SUBCASE("discrete probability distribution when all outcomes are legal") {
-        // First random number is 0.2, therefore we should return the first
-        // value
-        CHECK(pd.sample().first == doctest::Approx(1.0));
-        // Second random number is 0.4, therefore we should return 3.0
-        CHECK(pd.sample().first == doctest::Approx(2.0));
+        map<double, int> sampledValues;
+        for (int i = 0; i < 1000; ++i) {
+            RandomXoshiro rnd = task.rnd;
+            double randNum = rnd.genDouble(0.0, 1.0);
+            // Random numbers up to 0.2 return the first value, numbers up to
+            // 0.4 the second and all others the third
+            double value = 3.0;
+            if (MathUtils::doubleIsSmallerOrEqual(randNum, 0.2)) {
+                value = 1.0;
+            } else if (MathUtils::doubleIsSmallerOrEqual(randNum, 0.4)) {
+                value = 2.0;
+            }
+            double sampledValue = pd.sample(task.rnd).first;
+            CHECK(sampledValue == doctest::Approx(value));
+            ++sampledValues[sampledValue];
+        }
+        CHECK(sampledValues.size() == 3);
     }
     SUBCASE(
         "discrete probability distribution when some outcomes are illegal") {
         // We blacklist value 2.0, therefore the new distribution is
         // equal to 1.0:0.25/3.0:0.75
-        vector<int> blacklist = {1};
-        // First random number is 0.2, therefore we should return the
-        // first value
-        CHECK(pd.sample(blacklist).first == doctest::Approx(1.0));
-        // Second random number is 0.4, therefore we should return 3.0
-        CHECK(pd.sample(blacklist).first == doctest::Approx(3.0));
+        OutcomeMask blacklist;
+        blacklist.insert(1);
+        map<double, int> sampledValues;
+        for (int i = 0; i < 1000; ++i) {
+            RandomXoshiro rnd = task.rnd;
+            double randNum = rnd.genDouble(0.0, 0.8);
+            // Random numbers up to 0.2 return the first value and all others
+            // the third
+            double value =
+                MathUtils::doubleIsSmallerOrEqual(randNum, 0.2) ? 1.0 : 3.0;
+            double sampledValue = pd.sample(task.rnd, blacklist).first;
+            CHECK(sampledValue == doctest::Approx(value));
+            ++sampledValues[sampledValue];
+        }
+        CHECK(sampledValues.size() == 2);
+    }
+    SUBCASE("discrete probability distribution with another stream") {
+        // Sampling with another stream does not change the numbers of the
+        // random number generator of the task
+        RandomXoshiro stream = MathUtils::createRNGStream();
+        RandomXoshiro streamCopy = stream;
+        RandomXoshiro rnd = task.rnd;
+        for (int i = 0; i < 1000; ++i) {
+            double randNum = streamCopy.genDouble(0.0, 1.0);
+            double value = 3.0;
+            if (MathUtils::doubleIsSmallerOrEqual(randNum, 0.2)) {
+                value = 1.0;
+            } else if (MathUtils::doubleIsSmallerOrEqual(randNum, 0.4)) {
+                value = 2.0;
+            }
+            CHECK(pd.sample(stream).first == doctest::Approx(value));
+        }
+        CHECK(task.rnd.genDouble(0.0, 1.0) == rnd.genDouble(0.0, 1.0));
     }
 }
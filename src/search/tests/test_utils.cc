@@ -1,14 +1,71 @@
 #include "../../doctest/doctest.h"
 
+#include "../parser.h"
+#include "../planning_task.h"
 #include "../prost_planner.h"
 
+#include "../utils/math_utils.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
 // This is the main test fixture class for all unit tests. It automatically
-// resets all static members between each test, so that the user does not have
-// to do this manually.
+// activates a fresh planning task and gives it a randomly seeded random number
+// generator before each test, so that the user does not have to do this
+// manually.
 class ProstUnitTest {
 public:
     ProstUnitTest() {
-        ProstPlanner::resetStaticMembers();
+        task.activate();
+        MathUtils::resetRNG();
+        task.rnd = MathUtils::createRNGStream();
     }
+
+    PlanningTask task;
 };
 
+// Parses the given task description (in the format of the output of the RDDL
+// parser) into task, which is made the active task
+inline void parseTaskDescription(PlanningTask& task, std::string const& desc) {
+    char fileName[] = "/tmp/prost_test_taskXXXXXX";
+    int fd = mkstemp(fileName);
+    REQUIRE(fd != -1);
+    close(fd);
+    std::ofstream(fileName) << desc;
+    std::map<std::string, int> stateVariableIndices;
+    std::vector<std::vector<std::string>> stateVariableValues;
+    Parser(fileName, task).parseTask(stateVariableIndices,
+                                     stateVariableValues);
+    std::remove(fileName);
+}
+
+// A task with horizon 40, four independent probabilistic state fluents that
+// each yield a reward of 1 if they are true, and one action fluent that costs
+// 0.5 and makes all state fluents more likely to become true
+inline std::string const& fourFluentTaskDescription() {
+    static std::string const desc =
+        "toy4\n40\n1.0\n1\n0\n4\n0\n2\n5\n0 0 0 0\n0\n1\n0\nFIRST_APPLICABLE\n"
+        "0\n0\n0\n0 0 0 0\n0\na(c1)\n0\n2\n0 false\n1 true\n"
+        "0\nx(c0)\n2\n0 false\n1 true\n"
+        "Bernoulli(+($c(0.1) *($a(0) $c(0.6))))\n$a(0)\n0\nNONE\nNONE\n"
+        "0 0\n1 1\n"
+        "1\nx(c1)\n2\n0 false\n1 true\n"
+        "Bernoulli(+($c(0.2) *($a(0) $c(0.6))))\n$a(0)\n1\nNONE\nNONE\n"
+        "0 0\n1 1\n"
+        "2\nx(c2)\n2\n0 false\n1 true\n"
+        "Bernoulli(+($c(0.3) *($a(0) $c(0.6))))\n$a(0)\n2\nNONE\nNONE\n"
+        "0 0\n1 1\n"
+        "3\nx(c3)\n2\n0 false\n1 true\n"
+        "Bernoulli(+($c(0.4) *($a(0) $c(0.6))))\n$a(0)\n3\nNONE\nNONE\n"
+        "0 0\n1 1\n"
+        "+($s(0) $s(1) $s(2) $s(3) *($a(0) $c(-0.5)))\n-0.5\n4\n0\n4\n"
+        "NONE\nNONE\n0 0\n1 16\n"
+        "0 0 0\n1 1 0\n"
+        "0\n0 1\n1 4 1\n0\n1\n0 2\n1 4 2\n0\n2\n0 4\n1 4 4\n0\n3\n0 8\n"
+        "1 4 8\n0\n1\n0 0 0 0\n";
+    return desc;
+}
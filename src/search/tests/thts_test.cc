@@ -0,0 +1,252 @@
+#include "test_utils.cc"
+
+#include "../outcome_selection.h"
+#include "../thts.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE_FIXTURE(ProstUnitTest, "Testing the convergence check of THTS") {
+    parseTaskDescription(task, fourFluentTaskDescription());
+    REQUIRE(task.horizon == 40);
+    task.rnd.seed(0);
+
+    // Trials that expand complete paths end in the last step, but the values
+    // of the children of the root are sums of up to 40 rewards in [-0.5, 4]
+    std::string desc =
+        "[UCT -init [Expand -h [Uniform]] -ndn H -T TRIALS -r 20 -t 1000]";
+    std::unique_ptr<THTS> thts(
+        dynamic_cast<THTS*>(SearchEngine::fromString(desc, task)));
+    REQUIRE(thts);
+    thts->initSession();
+    thts->initRound();
+    thts->initStep(task.initialState);
+    std::vector<int> bestActions;
+    thts->estimateBestActions(task.initialState, bestActions);
+    REQUIRE(thts->getNumberOfTrials() == 20);
+
+    // After 20 trials, the confidence radius at depth 40 is larger than the
+    // difference of the values of the two actions, and the remaining trials
+    // can still change the recommendation
+    CHECK_FALSE(thts->rootRecommendationIsSettled());
+}
+
+namespace {
+// Solves the four fluent task with UCT on a task of its own (whose random
+// number generator generates the first stream of seed 0) and returns the
+// values of the children of the root
+std::vector<double> solveFourFluentTask() {
+    PlanningTask task;
+    parseTaskDescription(task, fourFluentTaskDescription());
+    task.rnd = RandomXoshiro(0, 0);
+
+    std::string desc =
+        "[UCT -init [Expand -h [Uniform]] -sd 4 -T TRIALS -r 500]";
+    std::unique_ptr<THTS> thts(
+        dynamic_cast<THTS*>(SearchEngine::fromString(desc, task)));
+    thts->initSession();
+    thts->initRound();
+    thts->initStep(task.initialState);
+    std::vector<int> bestActions;
+    thts->estimateBestActions(task.initialState, bestActions);
+
+    std::vector<double> values;
+    for (SearchNode const* child : thts->getCurrentRootNode()->children) {
+        values.push_back(child ? child->getExpectedRewardEstimate() : 0.0);
+    }
+    return values;
+}
+} // namespace
+
+TEST_CASE("Testing that tasks are solved independently on different threads") {
+    // Each task has its own layout, caches and random number generator, so
+    // the search on a task is not influenced by searches on other tasks that
+    // run concurrently
+    std::vector<double> expected = solveFourFluentTask();
+    REQUIRE(expected.size() == 2);
+
+    std::vector<double> results[2];
+    std::thread threads[2];
+    for (int i = 0; i < 2; ++i) {
+        threads[i] = std::thread([&results, i]() {
+            results[i] = solveFourFluentTask();
+        });
+    }
+    for (int i = 0; i < 2; ++i) {
+        threads[i].join();
+        CHECK(results[i] == expected);
+    }
+}
+
+TEST_CASE_FIXTURE(ProstUnitTest, "Testing the convergence-based termination") {
+    parseTaskDescription(task, fourFluentTaskDescription());
+    task.rnd.seed(0);
+
+    // With a search depth of 2, applying the action in the root yields 1.9
+    // more reward in expectation than not applying it (0.6 more probability
+    // for each fluent in the next step minus a cost of 0.5), while the values
+    // of the children of the root are in [-1, 8]. The confidence bounds are
+    // separated after a few thousand trials (as UCB1 rarely selects the worse
+    // action), which is long before the timeout and before the root is solved
+    // (which requires all 16 outcomes of both actions, including some with a
+    // probability below 0.01)
+    std::string desc =
+        "[UCT -init [Expand -h [Uniform]] -sd 2 -T TIME_AND_CONV -t 1000]";
+    std::unique_ptr<THTS> thts(
+        dynamic_cast<THTS*>(SearchEngine::fromString(desc, task)));
+    REQUIRE(thts);
+    thts->initSession();
+    thts->initRound();
+    thts->initStep(task.initialState);
+    std::vector<int> bestActions;
+    thts->estimateBestActions(task.initialState, bestActions);
+
+    CHECK(thts->rootRecommendationIsSettled());
+    CHECK_FALSE(thts->getCurrentRootNode()->solved);
+    CHECK(thts->getNumberOfTrials() < 10000);
+    REQUIRE(bestActions.size() == 1);
+    CHECK(task.actionStates[bestActions[0]].state[0] == 1);
+}
+
+TEST_CASE_FIXTURE(ProstUnitTest, "Testing the joint outcome selection of UMC") {
+    parseTaskDescription(task, fourFluentTaskDescription());
+    task.rnd.seed(0);
+
+    // The search initializes the node pool that provides the decision nodes
+    std::string desc =
+        "[THTS -act [UCB1] -out [UMC -joint 1] -backup [PB] "
+        "-init [Expand -h [Uniform]] -T TRIALS -r 10]";
+    std::unique_ptr<THTS> thts(
+        dynamic_cast<THTS*>(SearchEngine::fromString(desc, task)));
+    REQUIRE(thts);
+    thts->initSession();
+    thts->initRound();
+    thts->initStep(task.initialState);
+    std::vector<int> bestActions;
+    thts->estimateBestActions(task.initialState, bestActions);
+
+    std::vector<int> varIndices = {0, 1, 2, 3};
+    PDState nextState(task.horizon - 1);
+    nextState.probabilisticStateFluent(0) = 1.0;
+    nextState.probabilisticStateFluent(1) = 0.0;
+    nextState.probabilisticStateFluent(2) = 1.0;
+    nextState.probabilisticStateFluent(3) = 1.0;
+    CHECK(thts->getJointOutcomeIndex(nextState, varIndices) == 13);
+    CHECK(thts->getJointOutcomeIndex(nextState, {1, 3}) == 2);
+
+    // All joint outcomes but the one where all fluents become true are
+    // solved, and as that outcome has a probability of 1e-12, rejection
+    // sampling alone would not terminate in reasonable time
+    UnsolvedMCOutcomeSelection umc(thts.get());
+    umc.setJointOutcomes(true);
+    for (int varIndex : varIndices) {
+        nextState.probabilisticStateFluentAsPD(varIndex).assignBernoulli(0.001);
+    }
+    SearchNode node(1.0, task.horizon);
+    for (int outcomeIndex = 0; outcomeIndex < 15; ++outcomeIndex) {
+        double prob = 1.0;
+        for (int varIndex : varIndices) {
+            prob *= ((outcomeIndex >> varIndex) & 1) ? 0.001 : 0.999;
+        }
+        SearchNode* child = thts->createDecisionNode(prob);
+        child->outcomeIndex = outcomeIndex;
+        child->solved = true;
+        node.children.push_back(child);
+    }
+
+    SearchNode* child = umc.selectJointOutcome(&node, nextState, varIndices);
+    REQUIRE(child);
+    CHECK(child->outcomeIndex == 15);
+    CHECK(child->prob == doctest::Approx(1e-12).epsilon(1e-6));
+    CHECK_FALSE(child->solved);
+    CHECK(thts->getJointOutcomeIndex(nextState, varIndices) == 15);
+    REQUIRE(node.children.size() == 16);
+    CHECK(node.children.back() == child);
+
+    // The unsolved outcome is selected again instead of creating a new node
+    CHECK(umc.selectJointOutcome(&node, nextState, varIndices) == child);
+    CHECK(node.children.size() == 16);
+
+    // The children belong to the node pool of THTS
+    node.children.clear();
+}
+
+// Returns the parents of all nodes of the explicated graph of thts
+inline std::map<SearchNode const*, std::vector<SearchNode const*>>
+collectParents(THTS const& thts) {
+    std::map<SearchNode const*, std::vector<SearchNode const*>> parents;
+    std::vector<SearchNode const*> nodes(1, thts.getCurrentRootNode());
+    parents[nodes[0]];
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (SearchNode const* child : nodes[i]->children) {
+            if (!child) {
+                continue;
+            }
+            std::vector<SearchNode const*>& childParents = parents[child];
+            if (childParents.empty()) {
+                nodes.push_back(child);
+            }
+            if (std::find(childParents.begin(), childParents.end(),
+                          nodes[i]) == childParents.end()) {
+                childParents.push_back(nodes[i]);
+            }
+        }
+    }
+    return parents;
+}
+
+TEST_CASE_FIXTURE(ProstUnitTest, "Testing the transpositions of THTS") {
+    parseTaskDescription(task, fourFluentTaskDescription());
+
+    // The successor state does not depend on the current state, so the same
+    // state is reached on many paths (e.g., with both actions in the root)
+    auto search = [this](std::string const& transpositions) {
+        task.rnd.seed(0);
+        std::string desc = "[UCT -init [Expand -h [Uniform]] -tt " +
+                           transpositions + " -T TRIALS -r 200]";
+        std::unique_ptr<THTS> thts(
+            dynamic_cast<THTS*>(SearchEngine::fromString(desc, task)));
+        REQUIRE(thts);
+        thts->initSession();
+        thts->initRound();
+        thts->initStep(task.initialState);
+        std::vector<int> bestActions;
+        thts->estimateBestActions(task.initialState, bestActions);
+        REQUIRE(thts->getNumberOfTrials() == 200);
+        return thts;
+    };
+
+    SUBCASE("Without transpositions, the explicated graph is a tree") {
+        std::unique_ptr<THTS> thts = search("0");
+        for (auto const& nodeAndParents : collectParents(*thts)) {
+            CHECK(nodeAndParents.second.size() <= 1);
+        }
+    }
+
+    SUBCASE("Decision nodes of the same state share their children") {
+        std::unique_ptr<THTS> thts = search("1");
+        int sharedNodes = 0;
+        for (auto const& nodeAndParents : collectParents(*thts)) {
+            std::vector<SearchNode const*> const& parents =
+                nodeAndParents.second;
+            if (parents.size() < 2) {
+                continue;
+            }
+            ++sharedNodes;
+
+            // A decision node that is reached for a state that is already in
+            // the transposition table is not initialized again but takes the
+            // children and statistics of the other decision node
+            for (SearchNode const* parent : parents) {
+                CHECK(parent->initialized);
+                CHECK(parent->children == parents[0]->children);
+                CHECK(parent->stepsToGo == parents[0]->stepsToGo);
+            }
+        }
+        CHECK(sharedNodes > 0);
+    }
+}
@@ -0,0 +1,100 @@
+#include "test_utils.cc"
+
+#include "../ipc_client.h"
+
+#include "../utils/strxml.h"
+#include "../utils/xml_pull_parser.h"
+
+#include <string>
+#include <unistd.h>
+
+using std::string;
+using std::string_view;
+
+TEST_CASE("Testing the XML pull parser") {
+    SUBCASE("Events of a message") {
+        string msg =
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<turn><turn-num>1</turn-num><no-observed-fluents/>"
+            "<time-left> 500 </time-left></turn>";
+        msg += '\0';
+        XMLPullParser parser(msg);
+        CHECK(parser.next() == XMLPullParser::START_TAG);
+        CHECK(parser.getName() == "turn");
+        CHECK(parser.next() == XMLPullParser::START_TAG);
+        CHECK(parser.getName() == "turn-num");
+        CHECK(parser.next() == XMLPullParser::TEXT);
+        CHECK(parser.getText() == "1");
+        CHECK(parser.next() == XMLPullParser::END_TAG);
+        CHECK(parser.getName() == "turn-num");
+        CHECK(parser.next() == XMLPullParser::START_TAG);
+        CHECK(parser.getName() == "no-observed-fluents");
+        CHECK(parser.getDepth() == 2);
+        CHECK(parser.next() == XMLPullParser::END_TAG);
+        CHECK(parser.getDepth() == 1);
+        CHECK(parser.next() == XMLPullParser::START_TAG);
+        string_view text;
+        CHECK(parser.readElementText(text));
+        CHECK(text == "500");
+        CHECK(parser.next() == XMLPullParser::END_TAG);
+        CHECK(parser.getName() == "turn");
+        CHECK(parser.next() == XMLPullParser::END_OF_STREAM);
+    }
+
+    SUBCASE("Consecutive messages from a file descriptor") {
+        // A small buffer forces the parser to refill and grow it
+        string msgs = "<a><b>some text</b><c><d>x</d></c></a>";
+        msgs += '\0';
+        msgs += "<e>y</e>";
+        msgs += '\0';
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        REQUIRE(write(fds[1], msgs.c_str(), msgs.size()) == msgs.size());
+        close(fds[1]);
+
+        XMLPullParser parser(fds[0], 4);
+        XMLNode const* node = XMLNode::readNode(parser);
+        REQUIRE(node);
+        CHECK(node->getName() == "a");
+        string s;
+        CHECK(node->dissect("b", s));
+        CHECK(s.substr(0, s.size() - 1) == "some text");
+        REQUIRE(node->getChild("c"));
+        CHECK(node->getChild("c")->size() == 1);
+        delete node;
+
+        CHECK(parser.next() == XMLPullParser::START_TAG);
+        CHECK(parser.getName() == "e");
+        string_view text;
+        CHECK(parser.readElementText(text));
+        CHECK(text == "y");
+        CHECK(parser.next() == XMLPullParser::END_OF_STREAM);
+        close(fds[0]);
+    }
+
+    SUBCASE("Incomplete messages") {
+        XMLPullParser parser(string("<a><b>text</b>"));
+        CHECK(parser.next() == XMLPullParser::START_TAG);
+        CHECK(parser.skipElement() == false);
+        CHECK(parser.getEvent() == XMLPullParser::FORMAT_ERROR);
+    }
+}
+
+TEST_CASE("Testing the resolution of fluent names") {
+    std::map<string, int> stateVariableIndices = {
+        {"at(e0, f1)", 0}, {"at(e1, f1)", 1}, {"open", 2}, {"at(e0)", 3}};
+    FluentNameTrie trie;
+    trie.build(stateVariableIndices);
+
+    int node = trie.getChild(FluentNameTrie::ROOT, "at");
+    REQUIRE(node != -1);
+    CHECK(trie.getIndex(node) == -1);
+    int e0 = trie.getChild(node, "e0");
+    REQUIRE(e0 != -1);
+    CHECK(trie.getIndex(e0) == 3);
+    CHECK(trie.getIndex(trie.getChild(e0, "f1")) == 0);
+    CHECK(trie.getIndex(trie.getChild(trie.getChild(node, "e1"), "f1")) == 1);
+    CHECK(trie.getChild(e0, "f2") == -1);
+    CHECK(trie.getIndex(trie.getChild(FluentNameTrie::ROOT, "open")) == 2);
+    CHECK(trie.getChild(FluentNameTrie::ROOT, "closed") == -1);
+}
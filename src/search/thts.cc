@@ -9,7 +9,10 @@
 #include "utils/logger.h"
 #include "utils/system_utils.h"
 
+#include <cmath>
+#include <limits>
 #include <sstream>
+#include <unordered_set>
 
 std::string SearchNode::toString() const {
     std::stringstream ss;
@@ -21,8 +24,8 @@ std::string SearchNode::toString() const {
     return ss.str();
 }
 
-THTS::THTS(std::string _name)
-    : ProbabilisticSearchEngine(_name),
+THTS::THTS(std::string _name, PlanningTask& _task)
+    : ProbabilisticSearchEngine(_name, _task),
       actionSelection(nullptr),
       outcomeSelection(nullptr),
       backupFunction(nullptr),
@@ -31,9 +34,9 @@ THTS::THTS(std::string _name)
       currentRootNode(nullptr),
       chosenOutcome(nullptr),
       tipNodeOfTrial(nullptr),
-      states(SearchEngine::horizon + 1),
-      stepsToGoInCurrentState(SearchEngine::horizon),
-      stepsToGoInNextState(SearchEngine::horizon - 1),
+      states(task.horizon + 1),
+      stepsToGoInCurrentState(task.horizon),
+      stepsToGoInNextState(task.horizon - 1),
       appliedActionIndex(-1),
       trialReward(0.0),
       currentTrial(0),
@@ -41,8 +44,17 @@ THTS::THTS(std::string _name)
       lastUsedNodePoolIndex(0),
       terminationMethod(THTS::TIME),
       maxNumberOfTrials(0),
+      convergenceErrorProbability(0.05),
       numberOfNewDecisionNodesPerTrial(1),
+      speculativeSearch(false),
+      submittedActionIndex(-1),
+      transpositions(false),
       cacheHits(0),
+      speculativeTrials(0),
+      reusedSearchNodes(0),
+      sharedTranspositions(0),
+      timeoutExtended(false),
+      recommendationSettled(false),
       uniquePolicyDueToLastAction(false),
       uniquePolicyDueToRewardLock(false),
       uniquePolicyDueToPreconds(false),
@@ -90,15 +102,21 @@ bool THTS::setValueFromString(std::string& param, std::string& value) {
         } else if (value == "TIME_AND_TRIALS") {
             setTerminationMethod(THTS::TIME_AND_NUMBER_OF_TRIALS);
             return true;
+        } else if (value == "TIME_AND_CONV") {
+            setTerminationMethod(THTS::TIME_AND_CONVERGENCE);
+            return true;
         } else {
             return false;
         }
     } else if (param == "-r") {
         setMaxNumberOfTrials(atoi(value.c_str()));
         return true;
+    } else if (param == "-cerr") {
+        setConvergenceErrorProbability(atof(value.c_str()));
+        return true;
     } else if (param == "-ndn") {
         if (value == "H") {
-            setNumberOfNewDecisionNodesPerTrial(SearchEngine::horizon);
+            setNumberOfNewDecisionNodesPerTrial(task.horizon);
         } else {
             setNumberOfNewDecisionNodesPerTrial(atoi(value.c_str()));
         }
@@ -106,6 +124,12 @@ bool THTS::setValueFromString(std::string& param, std::string& value) {
     } else if (param == "-node-limit") {
         setMaxNumberOfNodes(atoi(value.c_str()));
         return true;
+    } else if (param == "-spec") {
+        setSpeculativeSearch(atoi(value.c_str()));
+        return true;
+    } else if (param == "-tt") {
+        setTranspositions(atoi(value.c_str()));
+        return true;
     }
 
     return SearchEngine::setValueFromString(param, value);
@@ -154,6 +178,23 @@ void THTS::disableCaching() {
     initializer->disableCaching();
     recommendationFunction->disableCaching();
     SearchEngine::disableCaching();
+
+    // The transposition table contains a state per decision node
+    transpositions = false;
+    transpositionTable.clear();
+}
+
+void THTS::loadCaches(PersistentCache const& cache) {
+    initializer->loadCaches(cache);
+}
+
+void THTS::storeCaches(PersistentCache& cache) const {
+    initializer->storeCaches(cache);
+}
+
+std::string THTS::getCacheConfig() const {
+    return SearchEngine::getCacheConfig() + " -init [" +
+           initializer->getCacheConfig() + "]";
 }
 
 void THTS::initSession() {
@@ -198,6 +239,10 @@ void THTS::finishRound() {
 }
 
 void THTS::initStep(State const& current) {
+    // This must be determined before the root state is replaced
+    SearchNode* speculativeRootNode = getSpeculativeRootNode(current);
+    submittedActionIndex = -1;
+
     PDState rootState(current);
     // Adjust maximal search depth and set root state
     if (rootState.stepsToGo() > maxSearchDepth) {
@@ -220,13 +265,28 @@ void THTS::initStep(State const& current) {
 
     // Reset per step statistics
     cacheHits = 0;
+    sharedTranspositions = 0;
+    resetRewardLockStatistics();
     lastSearchTime = 0.0;
+    timeoutExtended = false;
+    recommendationSettled = false;
     uniquePolicyDueToLastAction = false;
     uniquePolicyDueToRewardLock = false;
     uniquePolicyDueToPreconds = false;
 
-    // Create root node
-    currentRootNode = createRootNode();
+    // Decision nodes of the last step that are not reused are released, so
+    // the transposition table is rebuilt in each step
+    transpositionTable.clear();
+
+    // Create root node or reuse the matching subtree of the last step
+    reusedSearchNodes = 0;
+    if (speculativeRootNode) {
+        reuseSubtree(speculativeRootNode);
+        currentRootNode = speculativeRootNode;
+        reusedSearchNodes = lastUsedNodePoolIndex;
+    } else {
+        currentRootNode = createRootNode();
+    }
 
     // Notify ingredients of new step
     actionSelection->initStep(current);
@@ -235,6 +295,109 @@ void THTS::initStep(State const& current) {
     initializer->initStep(current);
 }
 
+void THTS::searchSpeculatively(int _submittedActionIndex,
+                               std::function<bool()> const& stop) {
+    speculativeTrials = 0;
+    if (!speculativeSearch || !currentRootNode) {
+        return;
+    }
+    submittedActionIndex = _submittedActionIndex;
+
+    // Trials are sampled as usual below the submitted action, so the
+    // subtrees of likely outcomes are deepened most
+    SearchNode const* chanceNode =
+        currentRootNode->children[submittedActionIndex];
+    assert(chanceNode);
+    while (!stop() && !chanceNode->solved &&
+           (lastUsedNodePoolIndex < maxNumberOfNodes)) {
+        visitDecisionNode(currentRootNode);
+        ++speculativeTrials;
+    }
+}
+
+SearchNode* THTS::getSpeculativeRootNode(State const& current) {
+    if ((submittedActionIndex == -1) || !currentRootNode) {
+        return nullptr;
+    }
+
+    // The subtree can only be reused if the search depth decreases by one
+    // (i.e., if the depth is not limited by maxSearchDepth)
+    int stepsToGo = maxSearchDepthForThisStep - 1;
+    if (std::min(current.stepsToGo(), maxSearchDepth) != stepsToGo) {
+        return nullptr;
+    }
+
+    // Follow the chance nodes of the outcomes of the probabilistic state
+    // fluents that are not deterministic in the last root state
+    PDState next(stepsToGo);
+    calcSuccessorState(states[maxSearchDepthForThisStep], submittedActionIndex,
+                       next);
+    std::vector<int> varIndices;
+    for (size_t i = 0; i < State::numberOfProbabilisticStateFluents(); ++i) {
+        if (!next.probabilisticStateFluentAsPD(i).isDeterministic()) {
+            varIndices.push_back(i);
+        }
+    }
+
+    SearchNode* node = currentRootNode->children[submittedActionIndex];
+    if (!node) {
+        return nullptr;
+    } else if (varIndices.empty()) {
+        node = node->children.empty() ? nullptr : node->children[0];
+    } else if (outcomesAreSelectedJointly(varIndices)) {
+        int outcomeIndex = getJointOutcomeIndex(current, varIndices);
+        auto it = node->findJointOutcome(outcomeIndex);
+        if ((it == node->children.end()) ||
+            ((*it)->outcomeIndex != outcomeIndex)) {
+            return nullptr;
+        }
+        node = *it;
+    } else {
+        for (size_t i = 0; node && (i < varIndices.size()); ++i) {
+            size_t childIndex = current.probabilisticStateFluent(varIndices[i]);
+            if (childIndex >= node->children.size()) {
+                return nullptr;
+            }
+            node = node->children[childIndex];
+        }
+    }
+
+    if (!node || !node->initialized || (node->stepsToGo != stepsToGo)) {
+        return nullptr;
+    }
+    return node;
+}
+
+void THTS::reuseSubtree(SearchNode* root) {
+    // Nodes are reached on several paths if transpositions are enabled
+    std::vector<SearchNode*> subtree(1, root);
+    std::unordered_set<SearchNode*> isInSubtree(subtree.begin(),
+                                                subtree.end());
+    for (size_t i = 0; i < subtree.size(); ++i) {
+        for (SearchNode* child : subtree[i]->children) {
+            if (child && isInSubtree.insert(child).second) {
+                subtree.push_back(child);
+            }
+        }
+    }
+
+    std::vector<SearchNode*> pool(subtree);
+    pool.reserve(lastUsedNodePoolIndex);
+    for (int i = 0; i < lastUsedNodePoolIndex; ++i) {
+        SearchNode* node = nodePool[i];
+        if (!isInSubtree.count(node)) {
+            std::vector<SearchNode*> tmp;
+            node->children.swap(tmp);
+            pool.push_back(node);
+        }
+    }
+    std::copy(pool.begin(), pool.end(), nodePool.begin());
+
+    root->prob = 1.0;
+    root->immediateReward = 0.0;
+    lastUsedNodePoolIndex = subtree.size();
+}
+
 void THTS::finishStep() {
     if (uniquePolicyDueToRewardLock) {
         ++numRewardLockStates;
@@ -307,7 +470,7 @@ void THTS::estimateBestActions(State const& _rootState,
 
         // for(unsigned int i = 0; i < currentRootNode->children.size(); ++i) {
         //     if (currentRootNode->children[i]) {
-        //         Logger::logLine(SearchEngine::actionStates[i].toCompactString() +
+        //         Logger::logLine(task.actionStates[i].toCompactString() +
         //                     ": " + currentRootNode->children[i]->toString(),
         //                     Verbosity::DEBUG);
         //     }
@@ -315,7 +478,10 @@ void THTS::estimateBestActions(State const& _rootState,
         // assert(currentTrial != 100);
     }
 
-    recommendationFunction->recommend(currentRootNode, bestActions);
+    {
+        PROFILE_PHASE(RECOMMENDATION);
+        recommendationFunction->recommend(currentRootNode, bestActions);
+    }
     assert(!bestActions.empty());
 
     // Update statistics
@@ -354,7 +520,7 @@ bool THTS::moreTrials() {
     // Check selected termination criterion
     switch (terminationMethod) {
     case THTS::TIME:
-        if (MathUtils::doubleIsGreater(stopwatch(), timeout)) {
+        if (timeoutReached()) {
             return false;
         }
         break;
@@ -364,8 +530,12 @@ bool THTS::moreTrials() {
         }
         break;
     case THTS::TIME_AND_NUMBER_OF_TRIALS:
-        if (MathUtils::doubleIsGreater(stopwatch(), timeout) ||
-            (currentTrial == maxNumberOfTrials)) {
+        if (timeoutReached() || (currentTrial == maxNumberOfTrials)) {
+            return false;
+        }
+        break;
+    case THTS::TIME_AND_CONVERGENCE:
+        if (timeoutReached() || rootRecommendationIsSettled()) {
             return false;
         }
         break;
@@ -374,6 +544,118 @@ bool THTS::moreTrials() {
     return true;
 }
 
+bool THTS::timeoutReached() {
+    double time = stopwatch();
+    if (MathUtils::doubleIsSmallerOrEqual(time, timeout)) {
+        return false;
+    } else if (MathUtils::doubleIsGreater(time, maxTimeout) ||
+               !rootDecisionIsClose()) {
+        return true;
+    }
+    timeoutExtended = true;
+    return false;
+}
+
+bool THTS::rootDecisionIsClose() const {
+    double bestValue = -std::numeric_limits<double>::max();
+    double secondBestValue = -std::numeric_limits<double>::max();
+    for (SearchNode const* child : currentRootNode->children) {
+        if (child && child->initialized) {
+            double value = child->getExpectedRewardEstimate();
+            if (MathUtils::doubleIsGreater(value, bestValue)) {
+                secondBestValue = bestValue;
+                bestValue = value;
+            } else if (MathUtils::doubleIsGreater(value, secondBestValue)) {
+                secondBestValue = value;
+            }
+        }
+    }
+    if (MathUtils::doubleIsMinusInfinity(secondBestValue)) {
+        return false;
+    }
+    return MathUtils::doubleIsSmallerOrEqual(
+        bestValue - secondBestValue, closeDecisionGap * std::abs(bestValue));
+}
+
+bool THTS::rootRecommendationIsSettled() {
+    // The values of the children of the root are in [minValue, maxValue]
+    double minValue = task.rewardCPF->getMinVal() * maxSearchDepthForThisStep;
+    double maxValue = task.rewardCPF->getMaxVal() * maxSearchDepthForThisStep;
+
+    SearchNode const* bestChild = nullptr;
+    double bestValue = 0.0;
+    int numberOfChildren = 0;
+    for (SearchNode const* child : currentRootNode->children) {
+        if (child) {
+            if (!child->initialized || (child->numberOfVisits == 0)) {
+                return false;
+            }
+            ++numberOfChildren;
+            double value = child->getExpectedRewardEstimate();
+            if (!bestChild || MathUtils::doubleIsGreater(value, bestValue)) {
+                bestChild = child;
+                bestValue = value;
+            }
+        }
+    }
+    if (numberOfChildren < 2) {
+        return false;
+    }
+
+    // The number of trials that can be performed in the remaining time
+    double time = stopwatch();
+    double remainingTrials = 0.0;
+    if (MathUtils::doubleIsGreater(time, 0.0)) {
+        double remainingTime = std::max(timeout, maxTimeout) - time;
+        remainingTrials = std::max(remainingTime, 0.0) * currentTrial / time;
+    }
+
+    // The confidence radius of a child (which is 0 for solved children) and
+    // the value of a child if all remaining trials yield the given value
+    double logTerm =
+        std::log(2.0 * numberOfChildren / convergenceErrorProbability);
+    auto radius = [&](SearchNode const* child) {
+        if (child->solved) {
+            return 0.0;
+        }
+        return (maxValue - minValue) *
+               std::sqrt(logTerm / (2.0 * child->numberOfVisits));
+    };
+    auto valueAfterRemainingTrials = [&](SearchNode const* child,
+                                         double trialValue) {
+        if (child->solved) {
+            return child->getExpectedRewardEstimate();
+        }
+        return (child->getExpectedRewardEstimate() * child->numberOfVisits +
+                trialValue * remainingTrials) /
+               (child->numberOfVisits + remainingTrials);
+    };
+
+    double bestLowerBound = bestValue - radius(bestChild);
+    double bestWorstValue = valueAfterRemainingTrials(bestChild, minValue);
+    bool boundsSeparated = true;
+    bool recommendationFixed = true;
+    for (SearchNode const* child : currentRootNode->children) {
+        if (child && (child != bestChild)) {
+            double value = child->getExpectedRewardEstimate();
+            if (MathUtils::doubleIsGreater(value + radius(child),
+                                           bestLowerBound)) {
+                boundsSeparated = false;
+            }
+            if (MathUtils::doubleIsGreaterOrEqual(
+                    valueAfterRemainingTrials(child, maxValue),
+                    bestWorstValue)) {
+                recommendationFixed = false;
+            }
+            if (!boundsSeparated && !recommendationFixed) {
+                return false;
+            }
+        }
+    }
+    recommendationSettled = true;
+    return true;
+}
+
 void THTS::visitDecisionNode(SearchNode* node) {
     if (node == currentRootNode) {
         initTrial();
@@ -398,7 +680,10 @@ void THTS::visitDecisionNode(SearchNode* node) {
             tipNodeOfTrial = node;
         }
 
-        initializer->initialize(node, states[stepsToGoInCurrentState]);
+        {
+            PROFILE_PHASE(INITIALIZATION);
+            initializer->initialize(node, states[stepsToGoInCurrentState]);
+        }
 
         if (node != currentRootNode) {
             ++initializedDecisionNodes;
@@ -414,7 +699,13 @@ void THTS::visitDecisionNode(SearchNode* node) {
     // Determine if we continue with this trial
     if (continueTrial(node)) {
         // Select the action that is simulated
-        appliedActionIndex = actionSelection->selectAction(node);
+        if ((node == currentRootNode) && (submittedActionIndex != -1)) {
+            // Speculative trials start with the submitted action
+            appliedActionIndex = submittedActionIndex;
+        } else {
+            PROFILE_PHASE(ACTION_SELECTION);
+            appliedActionIndex = actionSelection->selectAction(node);
+        }
         assert(node->children[appliedActionIndex]);
         assert(!node->children[appliedActionIndex]->solved);
 
@@ -431,7 +722,8 @@ void THTS::visitDecisionNode(SearchNode* node) {
         //                 Verbosity::DEBUG);
 
         lastProbabilisticVarIndex = -1;
-        for (unsigned int i = 0; i < State::numberOfProbabilisticStateFluents;
+        probabilisticVarIndices.clear();
+        for (unsigned int i = 0; i < State::numberOfProbabilisticStateFluents();
              ++i) {
             if (states[stepsToGoInNextState]
                     .probabilisticStateFluentAsPD(i)
@@ -442,6 +734,7 @@ void THTS::visitDecisionNode(SearchNode* node) {
                         .values[0];
             } else {
                 lastProbabilisticVarIndex = i;
+                probabilisticVarIndices.push_back(i);
             }
         }
 
@@ -451,12 +744,17 @@ void THTS::visitDecisionNode(SearchNode* node) {
         // Continue trial with chance nodes
         if (lastProbabilisticVarIndex < 0) {
             visitDummyChanceNode(node->children[appliedActionIndex]);
+        } else if (outcomesAreSelectedJointly(probabilisticVarIndices)) {
+            visitJointChanceNode(node->children[appliedActionIndex]);
         } else {
             visitChanceNode(node->children[appliedActionIndex]);
         }
 
         // Backup this node
-        backupFunction->backupDecisionNode(node);
+        {
+            PROFILE_PHASE(BACKUP);
+            backupFunction->backupDecisionNode(node);
+        }
         trialReward += node->immediateReward;
 
         // If the backup function labeled the node as solved, we store the
@@ -464,10 +762,10 @@ void THTS::visitDecisionNode(SearchNode* node) {
         // else in the tree in the future
         if (node->solved) {
             if (cachingEnabled &&
-                ProbabilisticSearchEngine::stateValueCache.find(
+                caches.stateValueCache.find(
                     states[node->stepsToGo]) ==
-                    ProbabilisticSearchEngine::stateValueCache.end()) {
-                ProbabilisticSearchEngine::stateValueCache
+                    caches.stateValueCache.end()) {
+                caches.stateValueCache
                     [states[node->stepsToGo]] =
                         node->getExpectedFutureRewardEstimate();
             }
@@ -488,11 +786,11 @@ bool THTS::currentStateIsSolved(SearchNode* node) {
         trialReward += node->immediateReward;
 
         return true;
-    } else if (ProbabilisticSearchEngine::stateValueCache.find(
+    } else if (caches.stateValueCache.find(
                    states[stepsToGoInCurrentState]) !=
-               ProbabilisticSearchEngine::stateValueCache.end()) {
+               caches.stateValueCache.end()) {
         // This state has already been solved before
-        trialReward = ProbabilisticSearchEngine::stateValueCache
+        trialReward = caches.stateValueCache
             [states[stepsToGoInCurrentState]];
         backupFunction->backupDecisionNodeLeaf(node, trialReward);
         trialReward += node->immediateReward;
@@ -510,10 +808,10 @@ bool THTS::currentStateIsSolved(SearchNode* node) {
         trialReward += node->immediateReward;
 
         if (cachingEnabled) {
-            assert(ProbabilisticSearchEngine::stateValueCache.find(
+            assert(caches.stateValueCache.find(
                        states[stepsToGoInCurrentState]) ==
-                   ProbabilisticSearchEngine::stateValueCache.end());
-            ProbabilisticSearchEngine::stateValueCache
+                   caches.stateValueCache.end());
+            caches.stateValueCache
                 [states[stepsToGoInCurrentState]] =
                     node->getExpectedFutureRewardEstimate();
         }
@@ -529,25 +827,37 @@ void THTS::visitChanceNode(SearchNode* node) {
         ++chanceNodeVarIndex;
     }
 
-    chosenOutcome = outcomeSelection->selectOutcome(
-        node, states[stepsToGoInNextState], chanceNodeVarIndex,
-        lastProbabilisticVarIndex);
+    {
+        PROFILE_PHASE(OUTCOME_SELECTION);
+        chosenOutcome = outcomeSelection->selectOutcome(
+            node, states[stepsToGoInNextState], chanceNodeVarIndex,
+            lastProbabilisticVarIndex);
+    }
 
     if (chanceNodeVarIndex == lastProbabilisticVarIndex) {
-        State::calcStateFluentHashKeys(states[stepsToGoInNextState]);
-        State::calcStateHashKey(states[stepsToGoInNextState]);
+        {
+            PROFILE_PHASE(HASH_KEYS);
+            State::calcStateFluentHashKeys(states[stepsToGoInNextState]);
+            State::calcStateHashKey(states[stepsToGoInNextState]);
+        }
 
+        shareTransposition(chosenOutcome);
         visitDecisionNode(chosenOutcome);
     } else {
         ++chanceNodeVarIndex;
         visitChanceNode(chosenOutcome);
     }
+
+    PROFILE_PHASE(BACKUP);
     backupFunction->backupChanceNode(node, trialReward);
 }
 
 void THTS::visitDummyChanceNode(SearchNode* node) {
-    State::calcStateFluentHashKeys(states[stepsToGoInNextState]);
-    State::calcStateHashKey(states[stepsToGoInNextState]);
+    {
+        PROFILE_PHASE(HASH_KEYS);
+        State::calcStateFluentHashKeys(states[stepsToGoInNextState]);
+        State::calcStateHashKey(states[stepsToGoInNextState]);
+    }
 
     if (node->children.empty()) {
         node->children.resize(1, nullptr);
@@ -555,10 +865,91 @@ void THTS::visitDummyChanceNode(SearchNode* node) {
     }
     assert(node->children.size() == 1);
 
+    shareTransposition(node->children[0]);
     visitDecisionNode(node->children[0]);
+
+    PROFILE_PHASE(BACKUP);
+    backupFunction->backupChanceNode(node, trialReward);
+}
+
+void THTS::visitJointChanceNode(SearchNode* node) {
+    {
+        PROFILE_PHASE(OUTCOME_SELECTION);
+        chosenOutcome = outcomeSelection->selectJointOutcome(
+            node, states[stepsToGoInNextState], probabilisticVarIndices);
+    }
+
+    {
+        PROFILE_PHASE(HASH_KEYS);
+        State::calcStateFluentHashKeys(states[stepsToGoInNextState]);
+        State::calcStateHashKey(states[stepsToGoInNextState]);
+    }
+
+    shareTransposition(chosenOutcome);
+    visitDecisionNode(chosenOutcome);
+
+    PROFILE_PHASE(BACKUP);
     backupFunction->backupChanceNode(node, trialReward);
 }
 
+void THTS::shareTransposition(SearchNode* node) {
+    if (!transpositions || node->initialized) {
+        return;
+    }
+
+    auto it = transpositionTable.find(states[stepsToGoInNextState]);
+    if (it == transpositionTable.end()) {
+        transpositionTable[states[stepsToGoInNextState]] = node;
+        return;
+    }
+    SearchNode* other = it->second;
+    if (other == node) {
+        return;
+    } else if (!other->initialized) {
+        // The node is initialized instead of the other one
+        it->second = node;
+        return;
+    }
+
+    // The statistics of the other node are copied such that the node is
+    // treated like a node that has been visited before
+    assert(node->children.empty());
+    node->children = other->children;
+    node->futureReward = other->futureReward;
+    node->numberOfVisits = other->numberOfVisits;
+    node->initialized = true;
+    node->solved = other->solved;
+    ++sharedTranspositions;
+}
+
+bool THTS::outcomesAreSelectedJointly(
+    std::vector<int> const& varIndices) const {
+    if (!outcomeSelection->selectsJointOutcomes()) {
+        return false;
+    }
+    long numberOfJointOutcomes = 1;
+    for (int varIndex : varIndices) {
+        numberOfJointOutcomes *=
+            task.probabilisticCPFs[varIndex]->getDomainSize();
+        if (numberOfJointOutcomes > std::numeric_limits<int>::max()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int THTS::getJointOutcomeIndex(State const& state,
+                               std::vector<int> const& varIndices) const {
+    int outcomeIndex = 0;
+    int multiplier = 1;
+    for (int varIndex : varIndices) {
+        int value = static_cast<int>(state.probabilisticStateFluent(varIndex));
+        outcomeIndex += multiplier * value;
+        multiplier *= task.probabilisticCPFs[varIndex]->getDomainSize();
+    }
+    return outcomeIndex;
+}
+
 int THTS::getUniquePolicy() {
     if (stepsToGoInCurrentState == 1) {
         uniquePolicyDueToLastAction = true;
@@ -678,10 +1069,26 @@ void THTS::printConfig(std::string indent) const {
                 indent + "Max num trials: " + std::to_string(maxNumberOfTrials),
                 Verbosity::VERBOSE);
             break;
+        case TerminationMethod::TIME_AND_CONVERGENCE:
+            Logger::logLine(
+                indent + "Termination method: TIME AND CONVERGENCE",
+                Verbosity::VERBOSE);
+            Logger::logLine(
+                indent + "Timeout: " + std::to_string(timeout),
+                Verbosity::VERBOSE);
+            Logger::logLine(
+                indent + "Convergence error probability: " +
+                std::to_string(convergenceErrorProbability),
+                Verbosity::VERBOSE);
+            break;
     }
     Logger::logLine(
         indent + "Max num search nodes: " + std::to_string(maxNumberOfNodes),
         Verbosity::VERBOSE);
+    Logger::logLine(
+        indent + "Transpositions: " +
+        std::string(transpositions ? "enabled" : "disabled"),
+        Verbosity::VERBOSE);
     Logger::logLine(
         indent + "Node pool size: " + std::to_string(nodePool.size()),
         Verbosity::VERBOSE);
@@ -719,6 +1126,7 @@ void THTS::printStepStatistics(std::string indent) const {
 
         printStateValueCacheUsage(indent);
         printApplicableActionCacheUsage(indent);
+        printRewardLockStatistics(indent);
 
         Logger::logLine(
             indent + "Performed trials: " + std::to_string(currentTrial),
@@ -727,9 +1135,27 @@ void THTS::printStepStatistics(std::string indent) const {
             indent + "Created search nodes: " +
             std::to_string(lastUsedNodePoolIndex),
             Verbosity::NORMAL);
-        Logger::logLine(
-            indent + "Search time: " + std::to_string(lastSearchTime),
-            Verbosity::NORMAL);
+        std::string searchTime =
+            indent + "Search time: " + std::to_string(lastSearchTime);
+        if (recommendationSettled) {
+            searchTime += " (terminated early with settled recommendation)";
+        } else if (timeoutExtended) {
+            searchTime += " (extended due to a close decision)";
+        }
+        Logger::logLine(searchTime, Verbosity::NORMAL);
+        if (speculativeSearch) {
+            Logger::logLine(
+                indent + "Reused search nodes: " +
+                std::to_string(reusedSearchNodes) + " (after " +
+                std::to_string(speculativeTrials) + " speculative trials)",
+                Verbosity::NORMAL);
+        }
+        if (transpositions) {
+            Logger::logLine(
+                indent + "Shared transpositions: " +
+                std::to_string(sharedTranspositions),
+                Verbosity::NORMAL);
+        }
         Logger::logLine(
             indent + "Cache hits: " + std::to_string(cacheHits),
             Verbosity::VERBOSE);
@@ -746,7 +1172,7 @@ void THTS::printStepStatistics(std::string indent) const {
             for (size_t i = 0; i < currentRootNode->children.size(); ++i) {
                 SearchNode const *child = currentRootNode->children[i];
                 if (child) {
-                    ActionState const &action = SearchEngine::actionStates[i];
+                    ActionState const &action = task.actionStates[i];
                     Logger::logLine(
                         indent + "    " + action.toCompactString() + ": " +
                         child->toString(), Verbosity::VERBOSE);
@@ -5,6 +5,9 @@
 
 #include "utils/stopwatch.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 class ActionSelection;
 class OutcomeSelection;
 class BackupFunction;
@@ -38,6 +41,7 @@ struct SearchNode {
           immediateReward(0.0),
           prob(_prob),
           stepsToGo(_stepsToGo),
+          outcomeIndex(-1),
           futureReward(-std::numeric_limits<double>::max()),
           numberOfVisits(0),
           initialized(false),
@@ -56,6 +60,7 @@ struct SearchNode {
         immediateReward = 0.0;
         prob = _prob;
         stepsToGo = _stepsToGo;
+        outcomeIndex = -1;
         futureReward = -std::numeric_limits<double>::max();
         numberOfVisits = 0;
         initialized = false;
@@ -70,6 +75,17 @@ struct SearchNode {
         return futureReward;
     }
 
+    // Returns the position of the child with the given outcome index among
+    // the children of a chance node with joint outcomes, or the position where
+    // such a child is inserted if there is none
+    std::vector<SearchNode*>::iterator findJointOutcome(int _outcomeIndex) {
+        return std::lower_bound(
+            children.begin(), children.end(), _outcomeIndex,
+            [](SearchNode const* child, int index) {
+                return child->outcomeIndex < index;
+            });
+    }
+
     std::string toString() const;
 
     std::vector<SearchNode*> children;
@@ -78,6 +94,12 @@ struct SearchNode {
     double prob;
     int stepsToGo;
 
+    // If the outcomes of a transition are selected jointly, the children of
+    // the chance node that represents the applied action are the decision
+    // nodes of the sampled successor states, sorted by this index of the
+    // joint outcome (see THTS::getJointOutcomeIndex). It is -1 otherwise.
+    int outcomeIndex;
+
     double futureReward;
     int numberOfVisits;
 
@@ -94,13 +116,17 @@ struct SearchNode {
 class THTS : public ProbabilisticSearchEngine {
 public:
     enum TerminationMethod {
-        TIME,                     // stop after timeout sec
-        NUMBER_OF_TRIALS,         // stop after maxNumberOfTrials trials
-        TIME_AND_NUMBER_OF_TRIALS // stop after timeout sec or maxNumberOfTrials
-                                  // trials, whichever comes first
+        TIME,                      // stop after timeout sec
+        NUMBER_OF_TRIALS,          // stop after maxNumberOfTrials trials
+        TIME_AND_NUMBER_OF_TRIALS, // stop after timeout sec or
+                                   // maxNumberOfTrials trials, whichever
+                                   // comes first
+        TIME_AND_CONVERGENCE       // stop after timeout sec or when the
+                                   // recommendation in the root is settled,
+                                   // whichever comes first
     };
 
-    THTS(std::string _name);
+    THTS(std::string _name, PlanningTask& _task);
 
     // Set parameters from command line
     bool setValueFromString(std::string& param, std::string& value) override;
@@ -108,6 +134,11 @@ public:
     //  This is called when caching is disabled because memory becomes sparse
     void disableCaching() override;
 
+    // Restores or stores the caches of the heuristic of the initializer
+    void loadCaches(PersistentCache const& cache) override;
+    void storeCaches(PersistentCache& cache) const override;
+    std::string getCacheConfig() const override;
+
     // Notify the search engine that the session starts
     void initSession() override;
 
@@ -137,6 +168,15 @@ public:
         assert(false);
     }
 
+    // Perform trials that start with the submitted action until stop returns
+    // true (if speculative search is enabled). These trials are counted in
+    // speculativeTrials and not in currentTrial, since they are not part of
+    // the search of any step: they must neither count towards the trial limit
+    // of the next step nor distort the trial rate that is estimated from
+    // currentTrial and the search time.
+    void searchSpeculatively(int _submittedActionIndex,
+                             std::function<bool()> const& stop) override;
+
     // Parameter setter
     void setActionSelection(ActionSelection* _actionSelection);
     void setOutcomeSelection(OutcomeSelection* _outcomeSelection);
@@ -154,11 +194,27 @@ public:
         maxNumberOfTrials = _maxNumberOfTrials;
     }
 
+    void setConvergenceErrorProbability(double _convergenceErrorProbability) {
+        convergenceErrorProbability = _convergenceErrorProbability;
+    }
+
     void setNumberOfNewDecisionNodesPerTrial(
         int _numberOfNewDecisionNodesPerTrial) {
         numberOfNewDecisionNodesPerTrial = _numberOfNewDecisionNodesPerTrial;
     }
 
+    void setSpeculativeSearch(bool _speculativeSearch) {
+        speculativeSearch = _speculativeSearch;
+    }
+
+    bool searchesSpeculatively() const {
+        return speculativeSearch;
+    }
+
+    void setTranspositions(bool _transpositions) {
+        transpositions = _transpositions;
+    }
+
     void setMaxNumberOfNodes(int _maxNumberOfNodes) {
         maxNumberOfNodes = _maxNumberOfNodes;
         // Resize the node pool and give it a "safety net" of 20000 nodes (this
@@ -181,6 +237,29 @@ public:
         return tipNodeOfTrial;
     }
 
+    int getNumberOfTrials() const override {
+        return currentTrial;
+    }
+
+    // Returns the index of the joint outcome of the probabilistic state
+    // fluents with the given indices in state, which is a mixed radix number
+    // over the values of these state fluents
+    int getJointOutcomeIndex(State const& state,
+                             std::vector<int> const& varIndices) const;
+
+    // Determines if the recommendation in the root is settled, which is the
+    // case if the confidence bounds on the value of the best child of the root
+    // are separated from those of all other children, or if the remaining
+    // trials (estimated from the remaining time) cannot change the
+    // recommendation even if they all yield the worst possible reward under
+    // the best child and the best possible reward under another child. The
+    // bounds are Hoeffding bounds that hold with probability
+    // 1 - convergenceErrorProbability for values that are averages of trial
+    // rewards, so they are an approximation for other backup functions. The
+    // values of the children are bounded by the rewards of the search depth of
+    // the current step.
+    bool rootRecommendationIsSettled();
+
     // Print
     void printConfig(std::string indent) const override;
     void printRoundStatistics(std::string indent) const override;
@@ -191,6 +270,7 @@ private:
     void visitDecisionNode(SearchNode* node);
     void visitChanceNode(SearchNode* node);
     void visitDummyChanceNode(SearchNode* node);
+    void visitJointChanceNode(SearchNode* node);
 
     void initTrial();
     void initTrialStep();
@@ -200,6 +280,16 @@ private:
         return initializedDecisionNodes < numberOfNewDecisionNodesPerTrial;
     }
 
+    // Returns true if the outcomes of the probabilistic state fluents with the
+    // given indices are selected jointly, which is the case if the outcome
+    // selection supports it and if the joint outcomes can be indexed by an int
+    bool outcomesAreSelectedJointly(std::vector<int> const& varIndices) const;
+
+    // If transpositions are enabled, a decision node that is reached for the
+    // first time shares the children of an initialized decision node of the
+    // same state (if there is one in the transposition table)
+    void shareTransposition(SearchNode* node);
+
     // Determines if the current state has been solved before
     bool currentStateIsSolved(SearchNode* node);
 
@@ -210,6 +300,21 @@ private:
     // Determine if another trial is performed
     bool moreTrials();
 
+    // Determines if the timeout is reached, which is the case if more than
+    // timeout seconds have passed and the timeout is not extended because the
+    // decision in the root is close (see SearchEngine::setTimeoutExtension)
+    bool timeoutReached();
+    bool rootDecisionIsClose() const;
+
+    // Returns the decision node in the subtree of the submitted action that
+    // represents the given state, or nullptr if the tree of the last step
+    // cannot be reused
+    SearchNode* getSpeculativeRootNode(State const& current);
+
+    // Moves the nodes of the subtree with the given root to the front of the
+    // node pool and releases all other nodes
+    void reuseSubtree(SearchNode* root);
+
     // Ingredients that are implemented externally
     ActionSelection* actionSelection;
     OutcomeSelection* outcomeSelection;
@@ -239,7 +344,8 @@ private:
     // that it reflects the future reward in each node when it is backed up)
     double trialReward;
 
-    // Counter for the number of trials
+    // Counter for the number of trials of the current step (without the
+    // speculative trials that have been performed before the step)
     int currentTrial;
 
     // Max search depth for the current step
@@ -252,6 +358,10 @@ private:
     // transition
     int lastProbabilisticVarIndex;
 
+    // Indices of the variables with non-deterministic outcome in the current
+    // transition
+    std::vector<int> probabilisticVarIndices;
+
     // Counter for the number of decision nodes that have been initialized in
     // the current trial
     int initializedDecisionNodes;
@@ -260,18 +370,44 @@ private:
     int lastUsedNodePoolIndex;
     std::vector<SearchNode*> nodePool;
 
+    // If transpositions are enabled, this maps states (including the steps-to-
+    // go) to the decision node whose children are shared by all other decision
+    // nodes of the state. The table is cleared in each step.
+    std::unordered_map<State, SearchNode*, State::HashWithRemSteps,
+                       State::EqualWithRemSteps>
+        transpositionTable;
+
     // The stopwatch used for timeout check
     Stopwatch stopwatch;
 
     // Parameter
     THTS::TerminationMethod terminationMethod;
     int maxNumberOfTrials;
+    double convergenceErrorProbability;
     int numberOfNewDecisionNodesPerTrial;
     int maxNumberOfNodes;
 
+    // If speculative search is enabled, trials are performed under the
+    // submitted action while the environment computes its outcome, and the
+    // subtree that matches the next state becomes the root of the next step
+    bool speculativeSearch;
+    int submittedActionIndex;
+
+    // If transpositions are enabled, decision nodes of the same state share
+    // their children, so the search tree becomes a DAG where chance nodes that
+    // represent actions can have several parents. The edge-specific data
+    // (probability, immediate reward and outcome index) remains in the
+    // decision nodes of each path.
+    bool transpositions;
+
     // Per step statistics
     int cacheHits;
+    int speculativeTrials;
+    int reusedSearchNodes;
+    int sharedTranspositions;
     double lastSearchTime;
+    bool timeoutExtended;
+    bool recommendationSettled;
     bool uniquePolicyDueToLastAction;
     bool uniquePolicyDueToRewardLock;
     bool uniquePolicyDueToPreconds;
@@ -0,0 +1,205 @@
+#include "timeout_manager.h"
+
+#include "search_engine.h"
+
+#include "utils/logger.h"
+#include "utils/math_utils.h"
+#include "utils/string_utils.h"
+#include "utils/system_utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+using namespace std;
+
+/******************************************************************
+                     Timeout Manager Creation
+******************************************************************/
+
+TimeoutManager* TimeoutManager::fromString(string& desc) {
+    // Timeout managers without parameters may be given without brackets
+    StringUtils::trim(desc);
+    if (!desc.empty() && desc[0] == '[') {
+        assert(desc[desc.size() - 1] == ']');
+        StringUtils::removeFirstAndLastCharacter(desc);
+        StringUtils::trim(desc);
+    }
+
+    TimeoutManager* result = nullptr;
+
+    if (desc.find("NONE") == 0) {
+        desc = desc.substr(4, desc.size());
+
+        result = new NoTimeoutManager();
+    } else if (desc.find("UNI") == 0) {
+        desc = desc.substr(3, desc.size());
+
+        result = new UniformTimeoutManager();
+    } else if (desc.find("ADA") == 0) {
+        desc = desc.substr(3, desc.size());
+
+        result = new AdaptiveTimeoutManager();
+    } else {
+        SystemUtils::abort("Illegal timeout management method: " + desc);
+    }
+
+    assert(result);
+    StringUtils::trim(desc);
+
+    while (!desc.empty()) {
+        string param;
+        string value;
+        StringUtils::nextParamValuePair(desc, param, value);
+
+        if (!result->setValueFromString(param, value)) {
+            SystemUtils::abort(
+                "Unused parameter value pair: " + param + " / " + value);
+        }
+    }
+
+    return result;
+}
+
+void TimeoutManager::printConfig(string indent) const {
+    Logger::logLine(indent + "Timeout method: " + name, Verbosity::VERBOSE);
+}
+
+/******************************************************************
+                      Uniform Timeout Management
+******************************************************************/
+
+void UniformTimeoutManager::initStep(SearchEngine* searchEngine,
+                                     int currentStep, double remainingTime) {
+    int remainingSteps =
+        (numberOfRounds - currentRound - 1) * horizon + horizon - currentStep;
+    assert(remainingSteps > 0);
+    double timeForThisStep = remainingTime / remainingSteps;
+
+    Logger::logLine("Setting time for this decision to " +
+                    to_string(timeForThisStep) + "s.", Verbosity::NORMAL);
+    searchEngine->setTimeout(timeForThisStep);
+}
+
+/******************************************************************
+                     Adaptive Timeout Management
+******************************************************************/
+
+AdaptiveTimeoutManager::AdaptiveTimeoutManager()
+    : TimeoutManager("ADAPTIVE"),
+      maxExtensionFactor(2.0),
+      closeDecisionGap(0.05),
+      minStepWeight(0.1),
+      averageUsedTimeInPreviousRound(0.0),
+      currentStep(-1),
+      timeForCurrentStep(0.0),
+      bankedTime(0.0) {}
+
+bool AdaptiveTimeoutManager::setValueFromString(string& param,
+                                                string& value) {
+    if (param == "-ext") {
+        setMaxExtensionFactor(atof(value.c_str()));
+        return true;
+    } else if (param == "-gap") {
+        setCloseDecisionGap(atof(value.c_str()));
+        return true;
+    } else if (param == "-minw") {
+        setMinStepWeight(atof(value.c_str()));
+        return true;
+    }
+
+    return false;
+}
+
+void AdaptiveTimeoutManager::initSession(int _numberOfRounds, int _horizon) {
+    TimeoutManager::initSession(_numberOfRounds, _horizon);
+    usedTimesInPreviousRound.clear();
+    averageUsedTimeInPreviousRound = 0.0;
+    bankedTime = 0.0;
+}
+
+void AdaptiveTimeoutManager::initRound() {
+    TimeoutManager::initRound();
+    usedTimes.assign(horizon, 0.0);
+}
+
+void AdaptiveTimeoutManager::finishRound() {
+    usedTimesInPreviousRound = usedTimes;
+    averageUsedTimeInPreviousRound =
+        accumulate(usedTimes.begin(), usedTimes.end(), 0.0) / horizon;
+}
+
+double AdaptiveTimeoutManager::getStepWeight(int step) const {
+    // Without (meaningful) statistics, all steps are weighted equally
+    if (usedTimesInPreviousRound.empty() ||
+        MathUtils::doubleIsEqual(averageUsedTimeInPreviousRound, 0.0)) {
+        return 1.0;
+    }
+    return max(usedTimesInPreviousRound[step],
+               minStepWeight * averageUsedTimeInPreviousRound);
+}
+
+void AdaptiveTimeoutManager::initStep(SearchEngine* searchEngine,
+                                      int _currentStep, double remainingTime) {
+    currentStep = _currentStep;
+
+    // Each remaining step of this and the remaining rounds gets a share of the
+    // remaining time that is proportional to its weight
+    double weightOfRound = 0.0;
+    double weightOfRestOfRound = 0.0;
+    for (int step = 0; step < horizon; ++step) {
+        double weight = getStepWeight(step);
+        weightOfRound += weight;
+        if (step >= currentStep) {
+            weightOfRestOfRound += weight;
+        }
+    }
+    int remainingRounds = numberOfRounds - currentRound - 1;
+    double remainingWeight =
+        weightOfRestOfRound + remainingRounds * weightOfRound;
+    assert(MathUtils::doubleIsGreater(remainingWeight, 0.0));
+    timeForCurrentStep =
+        remainingTime * getStepWeight(currentStep) / remainingWeight;
+
+    // Close decisions may use the time that was saved in earlier steps
+    bankedTime = min(bankedTime, remainingTime - timeForCurrentStep);
+    double extension =
+        min(bankedTime, (maxExtensionFactor - 1.0) * timeForCurrentStep);
+
+    Logger::logLine("Setting time for this decision to " +
+                    to_string(timeForCurrentStep) + "s (up to " +
+                    to_string(timeForCurrentStep + extension) +
+                    "s if the decision is close).", Verbosity::NORMAL);
+    searchEngine->setTimeout(timeForCurrentStep);
+    searchEngine->setTimeoutExtension(timeForCurrentStep + extension,
+                                      closeDecisionGap);
+}
+
+void AdaptiveTimeoutManager::finishStep(double usedTime) {
+    assert(currentStep >= 0 && currentStep < horizon);
+    usedTimes[currentStep] = usedTime;
+    bankedTime = max(bankedTime + timeForCurrentStep - usedTime, 0.0);
+}
+
+void AdaptiveTimeoutManager::printConfig(string indent) const {
+    TimeoutManager::printConfig(indent);
+    indent += "  ";
+    Logger::logLine(indent + "Max extension factor: " +
+                    to_string(maxExtensionFactor), Verbosity::VERBOSE);
+    Logger::logLine(indent + "Close decision gap: " +
+                    to_string(closeDecisionGap), Verbosity::VERBOSE);
+    Logger::logLine(indent + "Min step weight: " + to_string(minStepWeight),
+                    Verbosity::VERBOSE);
+}
+
+void AdaptiveTimeoutManager::printRoundStatistics(string indent) const {
+    Logger::logLine(indent + "Adaptive timeout management round statistics:",
+                    Verbosity::NORMAL);
+    indent += "  ";
+    Logger::logLine(indent + "Used time: " +
+                    to_string(accumulate(usedTimes.begin(),
+                                         usedTimes.end(), 0.0)) + "s",
+                    Verbosity::NORMAL);
+    Logger::logLine(indent + "Banked time: " + to_string(bankedTime) + "s",
+                    Verbosity::NORMAL);
+}
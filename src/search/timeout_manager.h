@@ -0,0 +1,158 @@
+#ifndef TIMEOUT_MANAGER_H
+#define TIMEOUT_MANAGER_H
+
+// A timeout manager decides how much of the remaining time of the session is
+// used for each decision of the planner. It is selected with the -tm option
+// of the planner, where NONE never changes the timeout of the search engine,
+// UNI splits the remaining time evenly among the remaining steps and
+// [ADA <options>] creates an AdaptiveTimeoutManager.
+
+#include <string>
+#include <vector>
+
+class SearchEngine;
+
+class TimeoutManager {
+public:
+    virtual ~TimeoutManager() {}
+
+    // Create a timeout manager
+    static TimeoutManager* fromString(std::string& desc);
+
+    // Set parameters from command line
+    virtual bool setValueFromString(std::string& /*param*/,
+                                    std::string& /*value*/) {
+        return false;
+    }
+
+    virtual void initSession(int _numberOfRounds, int _horizon) {
+        numberOfRounds = _numberOfRounds;
+        horizon = _horizon;
+        currentRound = -1;
+    }
+
+    virtual void initRound() {
+        ++currentRound;
+    }
+    virtual void finishRound() {}
+
+    // Assigns a timeout to the search engine for the decision in the step
+    // with index currentStep of the current round, where remainingTime is the
+    // time in seconds that is left for the rest of the session
+    virtual void initStep(SearchEngine* searchEngine, int currentStep,
+                          double remainingTime) = 0;
+
+    // Is called with the time in seconds that was used for the decision
+    virtual void finishStep(double /*usedTime*/) {}
+
+    // Prints statistics
+    virtual void printConfig(std::string indent) const;
+    virtual void printRoundStatistics(std::string /*indent*/) const {}
+
+protected:
+    TimeoutManager(std::string _name)
+        : name(_name), numberOfRounds(0), horizon(0), currentRound(-1) {}
+
+    // Name, used for output only
+    std::string name;
+
+    int numberOfRounds;
+    int horizon;
+    int currentRound;
+};
+
+/******************************************************************
+                       No Timeout Management
+******************************************************************/
+
+class NoTimeoutManager : public TimeoutManager {
+public:
+    NoTimeoutManager() : TimeoutManager("NONE") {}
+
+    void initStep(SearchEngine* /*searchEngine*/, int /*currentStep*/,
+                  double /*remainingTime*/) override {}
+};
+
+/******************************************************************
+                      Uniform Timeout Management
+******************************************************************/
+
+class UniformTimeoutManager : public TimeoutManager {
+public:
+    UniformTimeoutManager() : TimeoutManager("UNIFORM") {}
+
+    void initStep(SearchEngine* searchEngine, int currentStep,
+                  double remainingTime) override;
+};
+
+/******************************************************************
+                     Adaptive Timeout Management
+******************************************************************/
+
+// The adaptive timeout manager distributes the remaining time among the
+// remaining steps proportionally to the time that was used in the same step
+// of the previous round (uniformly in the first round), where each step gets
+// at least the share minStepWeight of the average. Since many steps are
+// trivial (e.g., if the policy is unique or the root is solved early), time
+// that is assigned to a step but not used is put into a bank. The bank pays
+// for extensions of the search in steps where the decision is close, i.e.,
+// where the estimated values of the two best actions differ by at most
+// closeDecisionGap times the absolute value of the best one, by up to
+// (maxExtensionFactor - 1) times the time of the step. (Banked time is also
+// distributed among the remaining steps, so the bank only ensures that
+// extensions are covered by earlier savings.)
+class AdaptiveTimeoutManager : public TimeoutManager {
+public:
+    AdaptiveTimeoutManager();
+
+    // Set parameters from command line
+    bool setValueFromString(std::string& param, std::string& value) override;
+
+    // Parameter setters
+    void setMaxExtensionFactor(double _maxExtensionFactor) {
+        maxExtensionFactor = _maxExtensionFactor;
+    }
+
+    void setCloseDecisionGap(double _closeDecisionGap) {
+        closeDecisionGap = _closeDecisionGap;
+    }
+
+    void setMinStepWeight(double _minStepWeight) {
+        minStepWeight = _minStepWeight;
+    }
+
+    void initSession(int _numberOfRounds, int _horizon) override;
+    void initRound() override;
+    void finishRound() override;
+    void initStep(SearchEngine* searchEngine, int currentStep,
+                  double remainingTime) override;
+    void finishStep(double usedTime) override;
+
+    // Prints statistics
+    void printConfig(std::string indent) const override;
+    void printRoundStatistics(std::string indent) const override;
+
+private:
+    // Returns the weight of the step with the given index
+    double getStepWeight(int step) const;
+
+    // Parameter
+    double maxExtensionFactor;
+    double closeDecisionGap;
+    double minStepWeight;
+
+    // The time that was used in each step of the current and the previous
+    // round (the latter is empty in the first round)
+    std::vector<double> usedTimes;
+    std::vector<double> usedTimesInPreviousRound;
+    double averageUsedTimeInPreviousRound;
+
+    // The index of the current step and the time that was assigned to it
+    int currentStep;
+    double timeForCurrentStep;
+
+    // The time that was assigned to steps but not used
+    double bankedTime;
+};
+
+#endif
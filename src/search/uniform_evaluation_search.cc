@@ -6,13 +6,14 @@
 
 using namespace std;
 
-UniformEvaluationSearch::UniformEvaluationSearch()
-    : DeterministicSearchEngine("UniformEvaluation"), initialValue(0.0) {}
+UniformEvaluationSearch::UniformEvaluationSearch(PlanningTask& _task)
+    : DeterministicSearchEngine("UniformEvaluation", _task),
+      initialValue(0.0) {}
 
 bool UniformEvaluationSearch::setValueFromString(string& param, string& value) {
     if (param == "-val") {
         if (value == "MAX") {
-            setInitialValue(SearchEngine::rewardCPF->getMaxVal());
+            setInitialValue(task.rewardCPF->getMaxVal());
         } else {
             setInitialValue(atof(value.c_str()));
         }
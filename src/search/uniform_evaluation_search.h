@@ -9,7 +9,7 @@
 
 class UniformEvaluationSearch : public DeterministicSearchEngine {
 public:
-    UniformEvaluationSearch();
+    UniformEvaluationSearch(PlanningTask& _task);
 
     // Set parameters from command line
     bool setValueFromString(std::string& param, std::string& value) override;
@@ -6,6 +6,7 @@
 
 typedef unsigned char BYTE;
 
+std::string encodeBase64(std::string const&);
 std::string decodeBase64(std::string const&);
 
 #endif /* BASE64_H */
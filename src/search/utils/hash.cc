@@ -30,4 +30,16 @@ unsigned int hash(vector<double> const& v1, vector<double> const& v2, int n) {
     hashValue = (hashValue ^ n) * mult;
     return hashValue + 97531;
 }
+
+unsigned int hash(vector<long> const& v) {
+    unsigned int mult = 1000003;
+    unsigned int hashValue = 0x345678;
+    for (int i = static_cast<int>(v.size()) - 1; i >= 0; --i) {
+        hashValue =
+            (hashValue ^ (static_cast<unsigned int>(v[i] ^ (v[i] >> 32)))) *
+            mult;
+        mult += 82520 + i + i;
+    }
+    return hashValue + 97531;
+}
 } // namespace utils
\ No newline at end of file
@@ -14,5 +14,6 @@ extern unsigned int hash(std::vector<double> const& v1,
                          std::vector<double> const& v2);
 extern unsigned int hash(std::vector<double> const& v1,
                          std::vector<double> const& v2, int n);
+extern unsigned int hash(std::vector<long> const& v);
 }
 #endif // UTILS_HASH_H
@@ -3,14 +3,24 @@
 #include <iostream>
 
 #ifdef NDEBUG
-Verbosity Logger::runVerbosity = Verbosity::NORMAL;
+std::atomic<Verbosity> Logger::runVerbosity{Verbosity::NORMAL};
 #else
-Verbosity Logger::runVerbosity = Verbosity::DEBUG;
+std::atomic<Verbosity> Logger::runVerbosity{Verbosity::DEBUG};
 #endif
 
+thread_local std::ostream *Logger::threadOutput = nullptr;
+
+std::ostream &Logger::out() {
+    return threadOutput ? *threadOutput : std::cout;
+}
+
+std::ostream &Logger::err() {
+    return threadOutput ? *threadOutput : std::cerr;
+}
+
 void Logger::logLine(std::string const &message, Verbosity verbosity) {
     if (runVerbosity >= verbosity) {
-        std::cout << message << std::endl;
+        out() << message << std::endl;
     }
 }
 
@@ -26,7 +36,7 @@ void Logger::logLineIf(
 
 void Logger::log(std::string const &message, Verbosity verbosity) {
     if (runVerbosity >= verbosity) {
-        std::cout << message;
+        out() << message;
     }
 }
 
@@ -40,11 +50,11 @@ void Logger::logSmallSeparator(Verbosity verbosity) {
 
 // prints an error message to stderr
 void Logger::logError(std::string const &message) {
-    std::cerr << "ERROR: " << message << std::endl;
+    err() << "ERROR: " << message << std::endl;
 }
 
 // prints a warning to stderr
 void Logger::logWarning(std::string const &message) {
-    std::cerr << "WARNING: " << message << std::endl;
+    err() << "WARNING: " << message << std::endl;
 }
 
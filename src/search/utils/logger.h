@@ -23,6 +23,8 @@
    removed.
  */
 
+#include <atomic>
+#include <ostream>
 #include <string>
 
 enum class Verbosity {
@@ -34,7 +36,17 @@ enum class Verbosity {
 };
 
 struct Logger {
-    static Verbosity runVerbosity;
+    static std::atomic<Verbosity> runVerbosity;
+
+    // Redirects all output of the calling thread (including warnings and
+    // errors) to stream, or back to stdout and stderr if stream is nullptr.
+    // This allows threads that run different sessions to write separate logs.
+    static void setThreadOutput(std::ostream *stream) {
+        threadOutput = stream;
+    }
+    static std::ostream *getThreadOutput() {
+        return threadOutput;
+    }
 
     // prints message plus an endline to stdout if the verbosity of this
     // run is at least as high as the given verbosity
@@ -66,6 +78,12 @@ struct Logger {
 
     // prints a warning to stderr
     static void logWarning(std::string const &message);
+
+private:
+    static std::ostream &out();
+    static std::ostream &err();
+
+    static thread_local std::ostream *threadOutput;
 };
 
 
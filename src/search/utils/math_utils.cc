@@ -1,6 +1,19 @@
+#include "random.h"
 #include "math_utils.h"
-std::unique_ptr<Random<>> MathUtils::rnd{new RandomMT()};
+
+std::atomic<uint64_t> MathUtils::rngSeed{0};
+std::atomic<int> MathUtils::numberOfRNGStreams{0};
 
 void MathUtils::resetRNG() {
-    rnd.reset(new RandomMT());
+    std::random_device r;
+    seedRNG((static_cast<uint64_t>(r()) << 32) | r());
+}
+
+void MathUtils::seedRNG(uint64_t seed) {
+    rngSeed = seed;
+    numberOfRNGStreams = 0;
+}
+
+RandomXoshiro MathUtils::createRNGStream() {
+    return RandomXoshiro(rngSeed, numberOfRNGStreams++);
 }
@@ -5,6 +5,7 @@
 
 #include "random.h"
 
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
 #include <limits>
@@ -59,14 +60,24 @@ public:
         return true;
     }
 
-    // Reset the random number generator
+    // Sets a random seed for the streams that are created afterwards
     static void resetRNG();
 
-    // Random number generator
-    static std::unique_ptr<Random<>> rnd;
+    // Sets the seed of the streams that are created afterwards and restarts
+    // with the first stream
+    static void seedRNG(uint64_t seed);
+
+    // Returns a random number generator that generates the numbers of the next
+    // stream of the current seed (see RandomXoshiro). It allows tasks and
+    // threads to generate random numbers that are reproducible and independent
+    // from the numbers of other tasks and threads.
+    static RandomXoshiro createRNGStream();
 
 private:
     MathUtils() {}
+
+    static std::atomic<uint64_t> rngSeed;
+    static std::atomic<int> numberOfRNGStreams;
 };
 
 #endif
@@ -0,0 +1,99 @@
+#include "profiler.h"
+
+#include "logger.h"
+
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+using namespace std;
+
+thread_local long Profiler::numberOfAllocations = 0;
+thread_local Profiler::Statistics Profiler::stepStatistics;
+thread_local Profiler::Statistics Profiler::roundStatistics;
+
+#if defined(PROST_PROFILING) || defined(PROST_COUNT_ALLOCATIONS)
+// Count heap allocations by replacing the global allocation functions (the
+// array versions and the sized deallocation functions forward to these)
+void* operator new(size_t size) {
+    ++Profiler::numberOfAllocations;
+    if (void* ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+#endif
+
+namespace {
+// Names of the phases in the order of SearchPhase
+string const phaseNames[] = {"action_selection",
+                             "successor_state",
+                             "outcome_selection",
+                             "hash_keys",
+                             "initialization",
+                             "backup",
+                             "reward_lock_detection",
+                             "recommendation"};
+static_assert(sizeof(phaseNames) / sizeof(phaseNames[0]) ==
+                  static_cast<size_t>(SearchPhase::NUMBER_OF_PHASES),
+              "A name must be given for each phase");
+
+double inSeconds(chrono::steady_clock::duration const& time) {
+    return chrono::duration<double>(time).count();
+}
+} // namespace
+
+void Profiler::initStep() {
+    stepStatistics = Statistics();
+}
+
+void Profiler::initRound() {
+    roundStatistics = Statistics();
+}
+
+void Profiler::printStepStatistics(string indent) {
+#ifdef PROST_PROFILING
+    printStatistics(indent, "step", stepStatistics);
+#else
+    (void)indent;
+#endif
+}
+
+void Profiler::printRoundStatistics(string indent) {
+#ifdef PROST_PROFILING
+    printStatistics(indent, "round", roundStatistics);
+#else
+    (void)indent;
+#endif
+}
+
+void Profiler::printStatistics(string const& indent, string const& scope,
+                               Statistics const& statistics) {
+    Logger::logLine(indent + "Profile of " + scope +
+                    " (calls / time in s / allocations):", Verbosity::NORMAL);
+    stringstream json;
+    json << "PROFILE " << scope << " {";
+    for (size_t i = 0; i < statistics.size(); ++i) {
+        PhaseStatistics const& stats = statistics[i];
+        Logger::logLine(indent + "  " + phaseNames[i] + ": " +
+                        to_string(stats.calls) + " / " +
+                        to_string(inSeconds(stats.time)) + " / " +
+                        to_string(stats.allocations), Verbosity::NORMAL);
+        if (i > 0) {
+            json << ", ";
+        }
+        json << "\"" << phaseNames[i] << "\": {\"calls\": " << stats.calls
+             << ", \"time\": " << inSeconds(stats.time)
+             << ", \"allocations\": " << stats.allocations << "}";
+    }
+    json << "}";
+    Logger::logLine(json.str(), Verbosity::SILENT);
+}
@@ -0,0 +1,122 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/*
+  Low-overhead instrumentation of the phases of the search. For each phase, the
+  number of calls, the time (measured with steady_clock) and the number of heap
+  allocations are accumulated per step and per round.
+
+  The instrumentation is only compiled in if PROST_PROFILING is defined (e.g.,
+  with the "profile" configuration of build.py or with cmake
+  -DPROST_PROFILING=ON). Otherwise, PROFILE_PHASE expands to nothing and no
+  statistics are printed.
+
+  A phase is measured from the PROFILE_PHASE statement until the end of the
+  enclosing scope. Phases can be nested (e.g., an initializer computes successor
+  states), and the values of a phase include all phases that are nested in it.
+*/
+
+#include <array>
+#include <chrono>
+#include <string>
+
+enum class SearchPhase {
+    ACTION_SELECTION,
+    SUCCESSOR_STATE,
+    OUTCOME_SELECTION,
+    HASH_KEYS,
+    INITIALIZATION,
+    BACKUP,
+    REWARD_LOCK_DETECTION,
+    RECOMMENDATION,
+    NUMBER_OF_PHASES
+};
+
+class Profiler {
+public:
+    // Reset the per step or per round statistics
+    static void initStep();
+    static void initRound();
+
+    static void addMeasurement(SearchPhase const& phase,
+                               std::chrono::steady_clock::duration const& time,
+                               long const& allocations) {
+        PhaseStatistics& stepStats = stepStatistics[static_cast<int>(phase)];
+        ++stepStats.calls;
+        stepStats.time += time;
+        stepStats.allocations += allocations;
+
+        PhaseStatistics& roundStats = roundStatistics[static_cast<int>(phase)];
+        ++roundStats.calls;
+        roundStats.time += time;
+        roundStats.allocations += allocations;
+    }
+
+    // Print the statistics of the current step or round in a human readable
+    // format and as a single line in JSON format that starts with "PROFILE"
+    static void printStepStatistics(std::string indent);
+    static void printRoundStatistics(std::string indent);
+
+    // The number of heap allocations of the calling thread since its start
+    // (this is only counted if PROST_PROFILING or PROST_COUNT_ALLOCATIONS is
+    // defined). The counter is thread local, so allocations of background
+    // threads (e.g., the network I/O of the IPC client) are not attributed to
+    // the search.
+    static thread_local long numberOfAllocations;
+
+private:
+    struct PhaseStatistics {
+        long calls = 0;
+        std::chrono::steady_clock::duration time =
+            std::chrono::steady_clock::duration::zero();
+        long allocations = 0;
+    };
+
+    typedef std::array<PhaseStatistics,
+                       static_cast<int>(SearchPhase::NUMBER_OF_PHASES)>
+        Statistics;
+
+    // The statistics are thread local, like numberOfAllocations, so the
+    // statistics of sessions that run on different threads are separate
+    static thread_local Statistics stepStatistics;
+    static thread_local Statistics roundStatistics;
+
+    static void printStatistics(std::string const& indent,
+                                std::string const& scope,
+                                Statistics const& statistics);
+};
+
+// Measures the phase from construction until destruction
+class ScopedPhaseTimer {
+public:
+    explicit ScopedPhaseTimer(SearchPhase const& _phase)
+        : phase(_phase),
+          allocationsAtStart(Profiler::numberOfAllocations),
+          startTime(std::chrono::steady_clock::now()) {}
+
+    ~ScopedPhaseTimer() {
+        Profiler::addMeasurement(
+            phase, std::chrono::steady_clock::now() - startTime,
+            Profiler::numberOfAllocations - allocationsAtStart);
+    }
+
+    ScopedPhaseTimer(ScopedPhaseTimer const&) = delete;
+    ScopedPhaseTimer& operator=(ScopedPhaseTimer const&) = delete;
+
+private:
+    SearchPhase phase;
+    long allocationsAtStart;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+#ifdef PROST_PROFILING
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_PHASE(phase)                                                  \
+    ScopedPhaseTimer PROFILE_CONCAT(scopedPhaseTimer, __LINE__)(              \
+        SearchPhase::phase)
+#else
+#define PROFILE_PHASE(phase)
+#endif
+
+#endif
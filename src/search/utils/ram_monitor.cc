@@ -0,0 +1,31 @@
+#include "ram_monitor.h"
+
+#include "system_utils.h"
+
+using namespace std;
+
+RAMMonitor::RAMMonitor(chrono::milliseconds _interval)
+    : interval(_interval),
+      usedRAM(SystemUtils::getRAMUsedByThis()),
+      stop(false) {
+    thread = std::thread(&RAMMonitor::run, this);
+}
+
+RAMMonitor::~RAMMonitor() {
+    {
+        lock_guard<std::mutex> lock(stopMutex);
+        stop = true;
+    }
+    stopCondition.notify_one();
+    thread.join();
+}
+
+void RAMMonitor::run() {
+    unique_lock<std::mutex> lock(stopMutex);
+    while (!stopCondition.wait_for(lock, interval, [this] { return stop; })) {
+        lock.unlock();
+        usedRAM.store(SystemUtils::getRAMUsedByThis(),
+                      memory_order_relaxed);
+        lock.lock();
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef RAM_MONITOR_H
+#define RAM_MONITOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Measures the RAM that is used by this process periodically in a background
+// thread, so the planner can check the RAM usage in each step without reading
+// /proc/self/status in the time that is available for the search.
+class RAMMonitor {
+public:
+    explicit RAMMonitor(std::chrono::milliseconds _interval =
+                            std::chrono::milliseconds(50));
+    ~RAMMonitor();
+
+    RAMMonitor(RAMMonitor const&) = delete;
+    RAMMonitor& operator=(RAMMonitor const&) = delete;
+
+    // Returns the RAM (in KB) that was used at the last measurement
+    int getRAMUsed() const {
+        return usedRAM.load(std::memory_order_relaxed);
+    }
+
+private:
+    void run();
+
+    std::chrono::milliseconds interval;
+    std::atomic<int> usedRAM;
+
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+    bool stop;
+    std::thread thread;
+};
+
+#endif
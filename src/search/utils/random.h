@@ -3,19 +3,133 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <random>
 
+// The xoshiro256** generator of Blackman and Vigna, which is considerably
+// faster than the mersenne twister and has a state of only 32 bytes (with a
+// period of 2^256 - 1). It satisfies the c++ concept
+// UniformRandomBitGenerator.
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t value = 0) {
+        seed(value);
+    }
+
+    // The state is initialized with the output of a splitmix64 generator that
+    // is seeded with value (as recommended by the authors)
+    void seed(uint64_t value) {
+        for (uint64_t& word : state) {
+            value += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = value;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    // Advances the generator by 2^128 steps. It can be used to generate
+    // 2^128 non-overlapping subsequences of the sequence of a seed.
+    void jump() {
+        static uint64_t const jumpPolynomial[] = {
+            0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+            0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        std::array<uint64_t, 4> jumped = {0, 0, 0, 0};
+        for (uint64_t word : jumpPolynomial) {
+            for (int bit = 0; bit < 64; ++bit) {
+                if (word & (1ULL << bit)) {
+                    for (size_t i = 0; i < state.size(); ++i) {
+                        jumped[i] ^= state[i];
+                    }
+                }
+                operator()();
+            }
+        }
+        state = jumped;
+    }
+
+    result_type operator()() {
+        uint64_t const result = rotl(state[1] * 5, 7) * 9;
+        uint64_t const t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::array<uint64_t, 4> state;
+};
+
 // Base class for common functions regarding random number generation.
-// URNG is the c++ concept UniformRandomBitGenerator.
-template <class URNG = std::mt19937>
+// URNG is the c++ concept UniformRandomBitGenerator. The methods are not
+// virtual, such that they are inlined in the hot paths of the search (e.g., in
+// outcome sampling). If URNG generates 64 random bits, numbers are derived
+// from the random bits directly instead of via the distributions of the
+// standard library, which are comparably slow.
+template <class URNG = Xoshiro256>
 class Random {
 public:
-    virtual ~Random() = default;
-    virtual int genInt(int min, int max) = 0;
-    virtual double genDouble(double min, double max) = 0;
-    virtual double genReal() = 0;
+    // Generates a random int between [min, max]. With 64 random bits, this
+    // uses Lemire's nearly divisionless method (which rejects a draw only to
+    // avoid a bias).
+    int genInt(int min, int max) {
+        if constexpr (hasRandomBits64) {
+            uint64_t range = static_cast<uint64_t>(
+                static_cast<int64_t>(max) - static_cast<int64_t>(min) + 1);
+            uint64_t product = (generator() >> 32) * range;
+            uint64_t low = product & 0xffffffffULL;
+            if (low < range) {
+                uint64_t threshold = ((1ULL << 32) - range) % range;
+                while (low < threshold) {
+                    product = (generator() >> 32) * range;
+                    low = product & 0xffffffffULL;
+                }
+            }
+            return static_cast<int>(min + static_cast<int64_t>(product >> 32));
+        } else {
+            return std::uniform_int_distribution<>{min, max}(generator);
+        }
+    }
+
+    // Generates a random double between [min, max)
+    double genDouble(double min, double max) {
+        if constexpr (hasRandomBits64) {
+            return min + (max - min) * genReal();
+        } else {
+            return std::uniform_real_distribution<>{min, max}(generator);
+        }
+    }
+
+    // Generates a random number between [0, 1). With 64 random bits, this
+    // uses the upper 53 bits.
+    double genReal() {
+        if constexpr (hasRandomBits64) {
+            return static_cast<double>(generator() >> 11) * 0x1.0p-53;
+        } else {
+            return std::generate_canonical<double, 10>(generator);
+        }
+    }
 
     // Returns an iterator to a randomly selected element
     template <typename Iter>
@@ -31,7 +145,9 @@ public:
     }
 
     // Reinitialize the engine with a new seed
-    virtual void seed(int value) = 0;
+    void seed(int value) {
+        generator.seed(value);
+    }
 
     // Some classes, like distributions, require a generator to produce random
     // numbers
@@ -40,6 +156,10 @@ public:
     }
 
 protected:
+    static constexpr bool hasRandomBits64 =
+        (URNG::min() == 0) &&
+        (URNG::max() == std::numeric_limits<uint64_t>::max());
+
     URNG generator;
 };
 
@@ -68,27 +188,39 @@ public:
         std::seed_seq seq(std::begin(seed_data), std::end(seed_data));
         generator.seed(seq);
     }
+};
 
-    // Generates a random int between [min, max]
-    int genInt(int min, int max) override {
-        return std::uniform_int_distribution<>{min, max}(generator);
+// Random number generation with a xoshiro256** generator that generates the
+// numbers of one of several streams: stream i starts 2^128 * i numbers after
+// the first number of the sequence of the seed, so the numbers of different
+// streams never overlap in practice. This allows to generate reproducible
+// numbers in several threads with a single seed.
+class RandomXoshiro : public Random<Xoshiro256> {
+public:
+    // Default constructor using a random seed
+    RandomXoshiro() : stream(0) {
+        std::random_device r;
+        seed((static_cast<uint64_t>(r()) << 32) | r());
     }
 
-    // Generates a random double between [min, max]
-    double genDouble(double min, double max) override {
-        return std::uniform_real_distribution<>{min, max}(generator);
+    RandomXoshiro(uint64_t value, int _stream) : stream(_stream) {
+        seed(value);
     }
 
-    // Generates a random number between [0, 1)
-    double genReal() override {
-        return std::generate_canonical<double, 10>(generator);
+    // Reinitialize the engine with a new seed (the stream is kept)
+    void seed(uint64_t value) {
+        generator.seed(value);
+        for (int i = 0; i < stream; ++i) {
+            generator.jump();
+        }
     }
 
-    // Reinitialize the engine with a new seed
-    void seed(int value) override {
-        generator.seed(value);
+    int getStream() const {
+        return stream;
     }
 
+private:
+    int stream;
 };
 
 #endif /* RANDOM_H */
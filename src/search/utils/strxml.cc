@@ -1,5 +1,7 @@
 #include "strxml.h"
 
+#include "xml_pull_parser.h"
+
 #include <sstream>
 #include <stack>
 #include <unistd.h>
@@ -27,7 +29,31 @@ private:
 
 static const std::string EMPTY_STRING;
 
-static std::string next_token(int fd) {
+// Reads characters either from a file descriptor or from a string
+class CharReader {
+public:
+    explicit CharReader(int _fd) : fd(_fd), str(nullptr), pos(0) {}
+    explicit CharReader(const std::string& _str)
+        : fd(-1), str(&_str), pos(0) {}
+
+    bool read(char& c) {
+        if (str) {
+            if (pos == str->size()) {
+                return false;
+            }
+            c = (*str)[pos++];
+            return true;
+        }
+        return ::read(fd, &c, 1) == 1;
+    }
+
+private:
+    int fd;
+    const std::string* str;
+    size_t pos;
+};
+
+static std::string next_token(CharReader& reader) {
     static char last_char = 0;
 
     std::string res;
@@ -47,7 +73,7 @@ static std::string next_token(int fd) {
 
     char next_char;
     while (1) {
-        if (read(fd, &next_char, 1) != 1) {
+        if (!reader.read(next_char)) {
             return EMPTY_STRING;
         }
         if (next_char == '>' || next_char == '<') {
@@ -134,19 +160,19 @@ static int do_node(const std::string& token, PSink& ps) {
     return 1;
 }
 
-static bool parse_node(int fd, PSink& ps) {
-    std::string token = next_token(fd);
+static bool parse_node(CharReader& reader, PSink& ps) {
+    std::string token = next_token(reader);
     int depth = 0;
     while (!token.empty()) {
         if (token == "<") {
-            int delta = do_node(next_token(fd), ps);
+            int delta = do_node(next_token(reader), ps);
             if (delta == -2) {
                 // cerr << "e1" << endl;
                 ps.formaterror();
                 return false;
             }
             depth += delta;
-            token = next_token(fd);
+            token = next_token(reader);
             if (token != ">") {
                 // cerr << "e2" << endl;
                 ps.formaterror();
@@ -158,7 +184,7 @@ static bool parse_node(int fd, PSink& ps) {
         } else {
             ps.pushText(token);
         }
-        token = next_token(fd);
+        token = next_token(reader);
     }
     ps.streamerror();
     return false;
@@ -226,13 +252,62 @@ std::ostream& operator<<(std::ostream& os, const XMLNode* xn) {
 /* Reads an XML node from the given file descriptor. */
 const XMLNode* XMLNode::readNode(int fd) {
     PSink ps;
-    if (parse_node(fd, ps)) {
+    CharReader reader(fd);
+    if (parse_node(reader, ps)) {
+        return ps.top;
+    } else {
+        return 0;
+    }
+}
+
+/* Reads an XML node from the given string. */
+const XMLNode* XMLNode::readNode(const std::string& str) {
+    PSink ps;
+    CharReader reader(str);
+    if (parse_node(reader, ps)) {
         return ps.top;
     } else {
         return 0;
     }
 }
 
+/* Reads the XML node of the current start tag of the given parser, or of
+   the next start tag if the current event is no start tag. */
+const XMLNode* XMLNode::readNode(XMLPullParser& parser) {
+    while (parser.getEvent() != XMLPullParser::START_TAG) {
+        XMLPullParser::Event event = parser.next();
+        if (event == XMLPullParser::END_OF_STREAM ||
+            event == XMLPullParser::FORMAT_ERROR) {
+            return 0;
+        }
+    }
+
+    PSink ps;
+    int depth = 0;
+    while (true) {
+        switch (parser.getEvent()) {
+        case XMLPullParser::START_TAG:
+            ps.pushNode(std::string(parser.getName()), str_pair_vec());
+            ++depth;
+            break;
+        case XMLPullParser::END_TAG:
+            ps.popNode(std::string(parser.getName()));
+            --depth;
+            break;
+        case XMLPullParser::TEXT:
+            ps.pushText(std::string(parser.getText()));
+            break;
+        default:
+            delete ps.top;
+            return 0;
+        }
+        if (depth == 0) {
+            return ps.top;
+        }
+        parser.next();
+    }
+}
+
 /* ====================================================================== */
 /* XMLText */
 
@@ -13,6 +13,7 @@
 #include <vector>
 
 struct XMLNode;
+class XMLPullParser;
 
 typedef std::pair<std::string, std::string> str_pair;
 typedef std::vector<str_pair> str_pair_vec;
@@ -22,6 +23,10 @@ typedef std::vector<const XMLNode*> node_vec;
 
 struct XMLNode {
     static const XMLNode* readNode(int fd);
+    static const XMLNode* readNode(const std::string& str);
+    // Reads the node of the current start tag of the parser (or of the next
+    // start tag if the current event is no start tag)
+    static const XMLNode* readNode(XMLPullParser& parser);
 
     virtual ~XMLNode() {}
 
@@ -8,7 +8,9 @@
 #include <ctime>
 #include <fstream>
 #include <iostream>
+#include <netinet/in.h>
 #include <sstream>
+#include <sys/socket.h>
 
 #include "stdio.h"
 #include "stdlib.h"
@@ -25,6 +27,9 @@ bool SystemUtils::CPUMeasurementOfProcessRunning = false;
 
 void SystemUtils::abort(std::string const& message) {
     Logger::logError(message);
+    if (abortThrows) {
+        throw AbortError(message);
+    }
     exit(0);
 }
 
@@ -134,6 +139,22 @@ int SystemUtils::getRAMUsedByThis() {
     return res;
 }
 
+// returns the peak RAM used by this process in KB
+int SystemUtils::getPeakRAMUsedByThis() {
+    FILE* file = fopen("/proc/self/status", "r");
+    int res = -1;
+    char line[128];
+
+    while (fgets(line, 128, file) != nullptr) {
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            res = parseLine(line);
+            break;
+        }
+    }
+    fclose(file);
+    return res;
+}
+
 // inits measurement of CPU usage by this process
 void SystemUtils::initCPUMeasurementOfThis() {
     FILE* file;
@@ -183,3 +204,24 @@ double SystemUtils::getCPUUsageOfThis() {
 
     return res;
 }
+
+int SystemUtils::listenOnPort(unsigned short port) {
+    int res = ::socket(PF_INET, SOCK_STREAM, 0);
+    if (res == -1) {
+        abort("Error: couldn't create server socket.");
+    }
+    int reuse = 1;
+    setsockopt(res, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    memset(&(addr.sin_zero), '\0', 8);
+
+    if ((::bind(res, (struct sockaddr*)&addr, sizeof(addr)) == -1) ||
+        (::listen(res, SOMAXCONN) == -1)) {
+        abort("Error: couldn't listen on port " + std::to_string(port) + ".");
+    }
+    return res;
+}
@@ -1,12 +1,30 @@
 #ifndef SYSTEMUTILS_H
 #define SYSTEMUTILS_H
 
+#include <stdexcept>
 #include <string>
 
+// Is thrown by SystemUtils::abort on threads where aborts throw
+class AbortError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
 class SystemUtils {
 public:
+    // Logs message as an error and terminates the process, or throws an
+    // AbortError with message if aborts throw on the calling thread (e.g., on
+    // the threads of the planner daemon, where a failing session must not
+    // terminate the other sessions)
     static void abort(std::string const& message);
 
+    static void setAbortThrows(bool _abortThrows) {
+        abortThrows = _abortThrows;
+    }
+    static bool getAbortThrows() {
+        return abortThrows;
+    }
+
     static bool readFile(std::string& file, std::string& res,
                          std::string ignoreSign = "");
 
@@ -17,10 +35,15 @@ public:
     static long getTotalRAM();
     static long getUsedRAM();
     static int getRAMUsedByThis();
+    static int getPeakRAMUsedByThis();
 
     static void initCPUMeasurementOfThis();
     static double getCPUUsageOfThis();
 
+    // Creates a socket that listens on the given port of the loopback
+    // interface
+    static int listenOnPort(unsigned short port);
+
 protected:
     static bool CPUMeasurementRunning;
     static bool CPUMeasurementOfProcessRunning;
@@ -32,6 +55,8 @@ protected:
 
     static int parseLine(char* line);
 
+    static inline thread_local bool abortThrows = false;
+
 private:
     SystemUtils() {}
 };
@@ -0,0 +1,178 @@
+#include "xml_pull_parser.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+using namespace std;
+
+XMLPullParser::XMLPullParser(int _fd, size_t initialBufferSize)
+    : fd(_fd),
+      buffer(max(initialBufferSize, size_t(1))),
+      pos(0),
+      end(0),
+      event(NONE),
+      depth(0),
+      pendingEndTag(false) {}
+
+XMLPullParser::XMLPullParser(string const& str)
+    : fd(-1),
+      buffer(str.begin(), str.end()),
+      pos(0),
+      end(str.size()),
+      event(NONE),
+      depth(0),
+      pendingEndTag(false) {}
+
+XMLPullParser::Event XMLPullParser::next() {
+    if (pendingEndTag) {
+        pendingEndTag = false;
+        --depth;
+        event = END_TAG;
+        return event;
+    }
+
+    while (true) {
+        if (!require(1)) {
+            event = (depth == 0) ? END_OF_STREAM : FORMAT_ERROR;
+            return event;
+        }
+
+        if (buffer[pos] != '<') {
+            size_t textEnd = find('<', 0);
+            if (textEnd == string::npos) {
+                event = (depth == 0) ? END_OF_STREAM : FORMAT_ERROR;
+                return event;
+            }
+            // Make sure that the tag that follows the text is in the buffer,
+            // so reading it doesn't invalidate the text
+            if (find('>', textEnd) == string::npos) {
+                event = FORMAT_ERROR;
+                return event;
+            }
+            string_view currentText(buffer.data() + pos, textEnd);
+            pos += textEnd;
+            if ((depth == 0) && trim(currentText).empty()) {
+                continue;
+            }
+            text = currentText;
+            event = TEXT;
+            return event;
+        }
+
+        size_t tagEnd = find('>', 1);
+        if (tagEnd == string::npos) {
+            event = FORMAT_ERROR;
+            return event;
+        }
+        string_view tag(buffer.data() + pos + 1, tagEnd - 1);
+        pos += tagEnd + 1;
+
+        if (!tag.empty() && ((tag[0] == '?') || (tag[0] == '!'))) {
+            // XML declaration, processing instruction or comment
+            continue;
+        } else if (!tag.empty() && (tag[0] == '/')) {
+            if (depth == 0) {
+                event = FORMAT_ERROR;
+                return event;
+            }
+            name = trim(tag.substr(1));
+            --depth;
+            event = END_TAG;
+            return event;
+        }
+
+        size_t nameEnd = 0;
+        while ((nameEnd < tag.size()) && !isspace(tag[nameEnd]) &&
+               (tag[nameEnd] != '/')) {
+            ++nameEnd;
+        }
+        if (nameEnd == 0) {
+            event = FORMAT_ERROR;
+            return event;
+        }
+        name = tag.substr(0, nameEnd);
+        pendingEndTag = (tag.back() == '/');
+        ++depth;
+        event = START_TAG;
+        return event;
+    }
+}
+
+bool XMLPullParser::readElementText(string_view& res) {
+    assert(event == START_TAG);
+    res = string_view();
+    if (next() == TEXT) {
+        res = trim(text);
+        next();
+    }
+    return event == END_TAG;
+}
+
+bool XMLPullParser::skipElement() {
+    assert(event == START_TAG);
+    int targetDepth = depth - 1;
+    while (depth > targetDepth) {
+        Event nextEvent = next();
+        if ((nextEvent == END_OF_STREAM) || (nextEvent == FORMAT_ERROR)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+string_view XMLPullParser::trim(string_view str) {
+    static string_view const whitespace(" \t\n\r\f\v\0", 7);
+    size_t first = str.find_first_not_of(whitespace);
+    if (first == string_view::npos) {
+        return string_view();
+    }
+    size_t last = str.find_last_not_of(whitespace);
+    return str.substr(first, last - first + 1);
+}
+
+bool XMLPullParser::require(size_t size) {
+    while (end - pos < size) {
+        if (fd < 0) {
+            return false;
+        }
+        // Discard the characters that have been read and grow the buffer if
+        // it is still full
+        if (pos > 0) {
+            memmove(buffer.data(), buffer.data() + pos, end - pos);
+            end -= pos;
+            pos = 0;
+        }
+        if (end == buffer.size()) {
+            buffer.resize(2 * buffer.size());
+        }
+        ssize_t bytesRead =
+            ::read(fd, buffer.data() + end, buffer.size() - end);
+        if ((bytesRead < 0) && (errno == EINTR)) {
+            continue;
+        } else if (bytesRead <= 0) {
+            return false;
+        }
+        end += bytesRead;
+    }
+    return true;
+}
+
+size_t XMLPullParser::find(char c, size_t from) {
+    while (true) {
+        if (pos + from < end) {
+            void const* res =
+                memchr(buffer.data() + pos + from, c, end - pos - from);
+            if (res) {
+                return static_cast<char const*>(res) - (buffer.data() + pos);
+            }
+            from = end - pos;
+        }
+        if (!require(from + 1)) {
+            return string::npos;
+        }
+    }
+}
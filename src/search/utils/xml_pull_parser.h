@@ -0,0 +1,91 @@
+#ifndef XML_PULL_PARSER_H
+#define XML_PULL_PARSER_H
+
+/*
+  A buffered pull parser for the XML messages of the rddlsim protocol. The
+  parser reads from a file descriptor in large chunks (or from a string) and
+  reports the content of the stream as a sequence of events (start tags, end
+  tags and texts). Tag names and texts are not copied: they are views into the
+  buffer of the parser. The name of a tag is valid until the next event is
+  read, and the text of a text event is valid until the tag that follows it
+  has been read (so the text of an element can be used after its end tag has
+  been read).
+
+  Only the subset of XML that is used in the protocol is supported: attributes
+  are skipped, entities are not decoded, and XML declarations, processing
+  instructions and comments are ignored. Texts between messages (e.g., the
+  '\0' characters that terminate messages) are ignored as well.
+*/
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+class XMLPullParser {
+public:
+    enum Event { NONE, START_TAG, END_TAG, TEXT, END_OF_STREAM, FORMAT_ERROR };
+
+    explicit XMLPullParser(int _fd, size_t initialBufferSize = 65536);
+    explicit XMLPullParser(std::string const& str);
+
+    // Reads the next event
+    Event next();
+
+    Event getEvent() const {
+        return event;
+    }
+
+    // The name of the current start or end tag
+    std::string_view getName() const {
+        return name;
+    }
+
+    // The text of the current text event
+    std::string_view getText() const {
+        return text;
+    }
+
+    // The number of elements that are open
+    int getDepth() const {
+        return depth;
+    }
+
+    // Reads the content of the current element (the current event must be a
+    // start tag) up to its end tag and writes its text without leading and
+    // trailing whitespace to res. Returns false if the element has child
+    // elements or if the stream ends before the end tag.
+    bool readElementText(std::string_view& res);
+
+    // Skips the current element (the current event must be a start tag) up to
+    // its end tag. Returns false if the stream ends before the end tag.
+    bool skipElement();
+
+    // Removes leading and trailing whitespace and '\0' characters
+    static std::string_view trim(std::string_view str);
+
+private:
+    // Makes sure that the buffer contains at least 'size' characters starting
+    // at 'pos'. The characters before pos are discarded if the buffer must be
+    // refilled. Returns false if the stream ends before.
+    bool require(size_t size);
+
+    // Returns the offset (relative to pos) of the first occurrence of c at or
+    // after offset 'from', or std::string::npos if the stream ends before
+    size_t find(char c, size_t from);
+
+    int fd;
+    std::vector<char> buffer;
+    // The unread characters are those in [pos, end)
+    size_t pos;
+    size_t end;
+
+    Event event;
+    std::string_view name;
+    std::string_view text;
+    int depth;
+    // Is true if the current start tag is self-closing, in which case the end
+    // tag is reported as the next event
+    bool pendingEndTag;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""
+Run PROST on the IPC benchmarks in a local simulation that requires no rddlsim
+server, and collect the benchmark statistics (decisions per second, trials per
+decision, average reward and peak RAM usage) of all runs in a JSON file.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+TESTBED_DIR = os.path.dirname(os.path.abspath(__file__))
+PROST_DIR = os.path.dirname(TESTBED_DIR)
+BENCHMARKS_DIR = os.path.join(TESTBED_DIR, "benchmarks")
+
+DEFAULT_CONFIG = "[PROST -s 1 -se [IPC2014]]"
+
+
+def parse_arguments():
+    formatter = lambda prog: argparse.ArgumentDefaultsHelpFormatter(
+        prog, max_help_position=38
+    )
+    parser = argparse.ArgumentParser(
+        description="Run PROST in a local simulation on the IPC benchmarks.",
+        formatter_class=formatter,
+    )
+    parser.add_argument(
+        "-b",
+        "--benchmark",
+        action="append",
+        default=None,
+        help="Name of a benchmark directory in testbed/benchmarks (can be "
+        "given several times). All benchmarks are run if none is given.",
+    )
+    parser.add_argument(
+        "-i",
+        "--instances",
+        action="store",
+        default=None,
+        type=int,
+        help="Maximal number of instances per benchmark.",
+    )
+    parser.add_argument(
+        "-r",
+        "--num-rounds",
+        action="store",
+        default="30",
+        type=str,
+        help="Number of rounds.",
+    )
+    parser.add_argument(
+        "-s", "--seed", action="store", default="0", type=str, help="Random seed."
+    )
+    parser.add_argument(
+        "-t",
+        "--timeout",
+        action="store",
+        default="0",
+        type=str,
+        help='Total timeout in seconds. No timeout is used if timeout is "0".',
+    )
+    parser.add_argument(
+        "-c",
+        "--config",
+        action="store",
+        default=DEFAULT_CONFIG,
+        help="Planner configuration.",
+    )
+    parser.add_argument(
+        "--build",
+        action="store",
+        default="release",
+        choices=["release", "debug", "profile"],
+        help="Build that is used.",
+    )
+    parser.add_argument(
+        "-o",
+        "--output",
+        action="store",
+        default="benchmark-results.json",
+        help="File where the results are written.",
+    )
+    return parser.parse_args()
+
+
+def find_domain_file(benchmark_dir, instance_file):
+    with open(instance_file) as f:
+        match = re.search(r"domain\s*=\s*([\w-]+)\s*;", f.read())
+    if not match:
+        return None
+    domain_name = match.group(1)
+    for file in sorted(os.listdir(benchmark_dir)):
+        path = os.path.join(benchmark_dir, file)
+        with open(path) as f:
+            if re.search(r"domain\s+{}\s*{{".format(re.escape(domain_name)), f.read()):
+                return path
+    return None
+
+
+def get_instances(benchmark):
+    benchmark_dir = os.path.join(BENCHMARKS_DIR, benchmark)
+    instances = [
+        os.path.join(benchmark_dir, file)
+        for file in sorted(os.listdir(benchmark_dir))
+        if "_inst_" in file
+    ]
+    return benchmark_dir, instances
+
+
+def run_instance(args, domain_file, instance_file):
+    call = [
+        sys.executable,
+        os.path.join(PROST_DIR, "prost.py"),
+        "--" + args.build,
+        instance_file,
+        "--simulate",
+        "--domain",
+        domain_file,
+        "--rounds",
+        args.num_rounds,
+        "--simulator-seed",
+        args.seed,
+        "--time",
+        args.timeout,
+        args.config,
+    ]
+    output = subprocess.run(
+        call, stdout=subprocess.PIPE, universal_newlines=True
+    ).stdout
+    for line in output.splitlines():
+        if line.startswith("BENCHMARK "):
+            return json.loads(line[len("BENCHMARK ") :])
+    return None
+
+
+def summarize(results):
+    keys = [
+        "decisions_per_second",
+        "trials_per_decision",
+        "average_reward",
+        "peak_ram",
+    ]
+    summary = {}
+    for key in keys:
+        values = [result[key] for result in results]
+        summary[key] = sum(values) / len(values) if values else None
+    if results:
+        summary["peak_ram"] = max(result["peak_ram"] for result in results)
+    return summary
+
+
+if __name__ == "__main__":
+    args = parse_arguments()
+
+    benchmarks = args.benchmark
+    if not benchmarks:
+        benchmarks = sorted(
+            d
+            for d in os.listdir(BENCHMARKS_DIR)
+            if os.path.isdir(os.path.join(BENCHMARKS_DIR, d))
+        )
+
+    results = {}
+    for benchmark in benchmarks:
+        benchmark_dir, instances = get_instances(benchmark)
+        if args.instances is not None:
+            instances = instances[: args.instances]
+
+        instance_results = {}
+        for instance_file in instances:
+            instance = os.path.basename(instance_file)[:-5]
+            domain_file = find_domain_file(benchmark_dir, instance_file)
+            if not domain_file:
+                print("Error: no domain file found for {}".format(instance))
+                continue
+            print("Running {}...".format(instance))
+            result = run_instance(args, domain_file, instance_file)
+            if not result:
+                print("Error: run on {} failed".format(instance))
+                continue
+            instance_results[instance] = result
+
+        summary = summarize(list(instance_results.values()))
+        results[benchmark] = {"summary": summary, "instances": instance_results}
+        print(
+            "{}: {:.2f} decisions/s, {:.2f} trials/decision, average reward "
+            "{:.2f}, peak RAM {} KB".format(
+                benchmark,
+                summary["decisions_per_second"] or 0.0,
+                summary["trials_per_decision"] or 0.0,
+                summary["average_reward"] or 0.0,
+                summary["peak_ram"] or 0,
+            )
+        )
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=4, sort_keys=True)
+    print("Results written to {}".format(args.output))
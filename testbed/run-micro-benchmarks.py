@@ -0,0 +1,246 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""
+Run the microbenchmarks of the search (see src/search/benchmarks) on a fixed
+set of testbed instances and compare the time and the number of heap
+allocations per operation to a baseline. The executable is taken from the
+"benchmark" build (./build.py benchmark).
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+TESTBED_DIR = os.path.dirname(os.path.abspath(__file__))
+PROST_DIR = os.path.dirname(TESTBED_DIR)
+BENCHMARKS_DIR = os.path.join(TESTBED_DIR, "benchmarks")
+BUILD_DIR = os.path.join(PROST_DIR, "builds", "benchmark")
+
+DEFAULT_BASELINE = os.path.join(TESTBED_DIR, "micro-benchmark-baseline.json")
+
+# Instances of different size and structure from the testbed
+DEFAULT_INSTANCES = [
+    "academic-advising-2014/academic_advising_inst_mdp__5",
+    "crossing-traffic-2011/crossing_traffic_inst_mdp__5",
+    "elevators-2011/elevators_inst_mdp__5",
+    "sysadmin-2011/sysadmin_inst_mdp__5",
+    "wildfire-2014/wildfire_inst_mdp__5",
+]
+
+
+def parse_arguments():
+    formatter = lambda prog: argparse.ArgumentDefaultsHelpFormatter(
+        prog, max_help_position=38
+    )
+    parser = argparse.ArgumentParser(
+        description="Run the microbenchmarks of the search and compare them "
+        "to a baseline.",
+        formatter_class=formatter,
+    )
+    parser.add_argument(
+        "-i",
+        "--instance",
+        action="append",
+        default=None,
+        help="Instance given as <benchmark>/<instance> relative to "
+        "testbed/benchmarks (can be given several times). A fixed set of "
+        "instances is used if none is given.",
+    )
+    parser.add_argument(
+        "-f",
+        "--filter",
+        action="store",
+        default="",
+        help="Only run microbenchmarks whose name contains this string.",
+    )
+    parser.add_argument(
+        "-m",
+        "--min-time",
+        action="store",
+        default="1.0",
+        type=str,
+        help="Minimal time in seconds that is spent in each microbenchmark.",
+    )
+    parser.add_argument(
+        "-s", "--seed", action="store", default="0", type=str, help="Random seed."
+    )
+    parser.add_argument(
+        "--baseline",
+        action="store",
+        default=DEFAULT_BASELINE,
+        help="File with the baseline results.",
+    )
+    parser.add_argument(
+        "--update-baseline",
+        action="store_true",
+        help="Write the results to the baseline file instead of comparing "
+        "them to it.",
+    )
+    parser.add_argument(
+        "-t",
+        "--tolerance",
+        action="store",
+        default=10.0,
+        type=float,
+        help="Increase of the time per operation (in percent) that is "
+        "reported as a regression.",
+    )
+    parser.add_argument(
+        "-a",
+        "--alloc-tolerance",
+        action="store",
+        default=10.0,
+        type=float,
+        help="Increase of the number of allocations per operation (in "
+        "percent) that is reported as a regression. The number is an average "
+        "in microbenchmarks that fill caches (e.g., thts_trial), so it "
+        "depends on the number of operations.",
+    )
+    parser.add_argument(
+        "-o",
+        "--output",
+        action="store",
+        default="micro-benchmark-results.json",
+        help="File where the results are written.",
+    )
+    return parser.parse_args()
+
+
+def find_domain_file(benchmark_dir, instance_file):
+    with open(instance_file) as f:
+        match = re.search(r"domain\s*=\s*([\w-]+)\s*;", f.read())
+    if not match:
+        return None
+    domain_name = match.group(1)
+    for file in sorted(os.listdir(benchmark_dir)):
+        path = os.path.join(benchmark_dir, file)
+        with open(path) as f:
+            if re.search(r"domain\s+{}\s*{{".format(re.escape(domain_name)), f.read()):
+                return path
+    return None
+
+
+def run_instance(args, work_dir, instance):
+    instance_file = os.path.join(BENCHMARKS_DIR, instance + ".rddl")
+    domain_file = find_domain_file(os.path.dirname(instance_file), instance_file)
+    if not domain_file:
+        print("Error: no domain file found for {}".format(instance))
+        return None
+    call = [
+        "./search-benchmarks",
+        instance_file,
+        "--domain",
+        domain_file,
+        "--seed",
+        args.seed,
+        "--min-time",
+        args.min_time,
+    ]
+    if args.filter:
+        call += ["--filter", args.filter]
+    output = subprocess.run(
+        call, stdout=subprocess.PIPE, universal_newlines=True, cwd=work_dir
+    ).stdout
+    for line in output.splitlines():
+        if line.startswith("MICROBENCHMARK "):
+            return json.loads(line[len("MICROBENCHMARK ") :])["results"]
+    return None
+
+
+def compare(results, baseline, tolerance, alloc_tolerance):
+    """
+    Print the change of each microbenchmark with respect to the baseline and
+    return the number of regressions, i.e., of microbenchmarks where the time
+    per operation increased by more than tolerance percent or where the number
+    of allocations per operation increased by more than alloc_tolerance
+    percent. The time is only compared if the baseline contains it, as it
+    depends on the machine (the baseline in the repository only contains the
+    number of allocations).
+    """
+    regressions = 0
+    for instance, instance_results in sorted(results.items()):
+        print(instance)
+        for name, result in sorted(instance_results.items()):
+            base = baseline.get(instance, {}).get(name)
+            if not base:
+                print("  {:<24} {:>10.1f} ns/op (no baseline)".format(
+                    name, result["ns_per_op"]))
+                continue
+            if "ns_per_op" in base:
+                change = 100.0 * (result["ns_per_op"] / base["ns_per_op"] - 1.0)
+                time_change = "({:+.1f}%)".format(change)
+            else:
+                change = 0.0
+                time_change = "(no baseline)"
+            more_allocations = result["allocs_per_op"] > (
+                base["allocs_per_op"] * (1.0 + alloc_tolerance / 100.0) + 1e-6
+            )
+            regression = change > tolerance or more_allocations
+            regressions += regression
+            print(
+                "  {:<24} {:>10.1f} ns/op {}, {:.2f} allocs/op "
+                "(baseline {:.2f}){}".format(
+                    name,
+                    result["ns_per_op"],
+                    time_change,
+                    result["allocs_per_op"],
+                    base["allocs_per_op"],
+                    "  <-- REGRESSION" if regression else "",
+                )
+            )
+    return regressions
+
+
+if __name__ == "__main__":
+    args = parse_arguments()
+    instances = args.instance or DEFAULT_INSTANCES
+
+    # The executable calls the parser under the name of the release parser
+    work_dir = tempfile.mkdtemp()
+    shutil.copy2(
+        os.path.join(BUILD_DIR, "search", "search-benchmarks"), work_dir
+    )
+    shutil.copy2(
+        os.path.join(BUILD_DIR, "rddl_parser", "rddl-parser"),
+        os.path.join(work_dir, "rddl-parser-release"),
+    )
+
+    results = {}
+    for instance in instances:
+        print("Running {}...".format(instance))
+        result = run_instance(args, work_dir, instance)
+        if not result:
+            print("Error: run on {} failed".format(instance))
+            continue
+        results[instance] = result
+    shutil.rmtree(work_dir)
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=4, sort_keys=True)
+    print("Results written to {}".format(args.output))
+
+    if args.update_baseline:
+        with open(args.baseline, "w") as f:
+            json.dump(results, f, indent=4, sort_keys=True)
+        print("Baseline written to {}".format(args.baseline))
+        sys.exit(0)
+
+    if not os.path.exists(args.baseline):
+        print("No baseline found at {} (create it with --update-baseline)"
+              .format(args.baseline))
+        sys.exit(0)
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    regressions = compare(
+        results, baseline, args.tolerance, args.alloc_tolerance
+    )
+    if regressions:
+        print("{} regression(s) with respect to the baseline".format(regressions))
+        sys.exit(1)
@@ -86,33 +86,64 @@ def parse_arguments():
         default="500",
         help="Maximum amount of memory in MB that may be allocated by the Java VM.",
     )
+    parser.add_argument(
+        "--native",
+        action="store_true",
+        default=False,
+        help="Run the simulator server of Prost instead of rddlsim (requires "
+        "no Java VM, but only works with the Prost client).",
+    )
     args = parser.parse_args()
     return args
 
 
+def run_native_server(args, directory):
+    sessions = "1" if args.separate_session else "0"
+    prost_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    subprocess.check_call(
+        [
+            sys.executable,
+            os.path.join(prost_dir, "prost.py"),
+            directory,
+            "--server",
+            "--port",
+            args.port,
+            "--rounds",
+            args.num_rounds,
+            "--simulator-seed",
+            args.seed,
+            "--time",
+            args.timeout,
+            "--sessions",
+            sessions,
+        ]
+    )
+
+
 if __name__ == "__main__":
     # Check if the environment variable RDDLSIM_ROOT exists
-    try:
-        rddlsim_root = os.environ["RDDLSIM_ROOT"]
-    except KeyError:
-        err_msg = (
-            "Error: an environment variable RDDLSIM_ROOT pointing to "
-            "your rddlsim installation must be setup."
-        )
-        print(err_msg)
-        sys.exit()
-
     args = parse_arguments()
 
-    lib_dir = os.path.join(rddlsim_root, "lib")
-    bin_dir = os.path.join(rddlsim_root, "bin")
-    jars = os.listdir(lib_dir)
-    full_jars = [os.path.join(lib_dir, jar) for jar in jars]
+    if not args.native:
+        try:
+            rddlsim_root = os.environ["RDDLSIM_ROOT"]
+        except KeyError:
+            err_msg = (
+                "Error: an environment variable RDDLSIM_ROOT pointing to "
+                "your rddlsim installation must be setup."
+            )
+            print(err_msg)
+            sys.exit()
+
+        lib_dir = os.path.join(rddlsim_root, "lib")
+        bin_dir = os.path.join(rddlsim_root, "bin")
+        jars = os.listdir(lib_dir)
+        full_jars = [os.path.join(lib_dir, jar) for jar in jars]
 
-    # Create log_dir folder if it doesn't exist
-    log_dir = os.path.abspath(args.log_dir)
-    if not os.path.exists(log_dir):
-        os.mkdir(log_dir)
+        # Create log_dir folder if it doesn't exist
+        log_dir = os.path.abspath(args.log_dir)
+        if not os.path.exists(log_dir):
+            os.mkdir(log_dir)
 
     # Turn bool arguments into a 0/1
     separate_session = "0"
@@ -157,24 +188,27 @@ if __name__ == "__main__":
         directory = args.benchmark
 
     try:
-        subprocess.check_call(
-            [
-                "java",
-                "-Xms{}M".format(args.init_memory),
-                "-Xmx{}M".format(args.max_memory),
-                "-classpath",
-                "{}:{}".format(bin_dir, ":".join(full_jars)),
-                "rddl.competition.Server",
-                directory,
-                args.port,
-                args.num_rounds,
-                args.seed,
-                separate_session,
-                args.timeout,
-                log_dir,
-                monitor_execution,
-            ]
-        )
+        if args.native:
+            run_native_server(args, os.path.abspath(directory))
+        else:
+            subprocess.check_call(
+                [
+                    "java",
+                    "-Xms{}M".format(args.init_memory),
+                    "-Xmx{}M".format(args.max_memory),
+                    "-classpath",
+                    "{}:{}".format(bin_dir, ":".join(full_jars)),
+                    "rddl.competition.Server",
+                    directory,
+                    args.port,
+                    args.num_rounds,
+                    args.seed,
+                    separate_session,
+                    args.timeout,
+                    log_dir,
+                    monitor_execution,
+                ]
+            )
     except KeyboardInterrupt:
         pass
     except subprocess.CalledProcessError as e: